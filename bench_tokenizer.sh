@@ -0,0 +1,11 @@
+#!/bin/bash
+
+# Compares word at a time and scalar skipping of whitespace and comments,
+# by tokenizing the headers in /usr/include concatenated into one file.
+
+HEADERS=$(mktemp --suffix=.h)
+trap 'rm -f $HEADERS' EXIT
+
+find ${1:-/usr/include} -maxdepth 2 -name '*.h' -type f | sort | xargs cat > $HEADERS
+
+./cc -dbench-tokenizer $HEADERS /dev/null
@@ -63,6 +63,28 @@ run_tests ./cc
 echo -en "\r\033[KNo errors"
 echo
 
+echo "TESTING SOURCES IN tests/ WITH -O2"
+TEST_DIR=test_asm_O2
+mkdir -p $TEST_DIR
+run_tests "./cc -O2"
+echo -en "\r\033[KNo errors"
+echo
+TEST_DIR=test_asm
+
+echo "TESTING PRECOMPILED HEADER"
+TEST_DIR=test_asm_pch
+mkdir -p $TEST_DIR
+if [ "$MUSL" == "true" ]; then
+	./cc --emit-pch tests/precompiled.h $TEST_DIR/precompiled.pch -Imusl -DAAA
+else
+	./cc --emit-pch tests/precompiled.h $TEST_DIR/precompiled.pch -I/usr/include -Iinclude/linux -DAAA
+fi
+test_source tests/precompiled.c $MUSL AAA true "./cc -include-pch $TEST_DIR/precompiled.pch"
+# The flags must be the same as when the header was precompiled.
+test_source tests/precompiled.c $MUSL BBB false "./cc -include-pch $TEST_DIR/precompiled.pch"
+echo "No errors"
+TEST_DIR=test_asm
+
 echo "TESTING SELF COMPILATION"
 ./self_compile.sh 2
 diff asm/ asm2/
@@ -166,33 +166,33 @@ static void ms_emit_function_preamble(struct function *func) {
 	if (!abi_data->is_variadic)
 		return;
 
-	asm_ins2("movq", R8(REG_RCX), MEM(16, REG_RBP));
-	asm_ins2("movq", R8(REG_RDX), MEM(24, REG_RBP));
-	asm_ins2("movq", R8(REG_R8), MEM(32, REG_RBP));
-	asm_ins2("movq", R8(REG_R9), MEM(40, REG_RBP));
+	asm_ins2(MN_MOVQ, R8(REG_RCX), MEM(16, REG_RBP));
+	asm_ins2(MN_MOVQ, R8(REG_RDX), MEM(24, REG_RBP));
+	asm_ins2(MN_MOVQ, R8(REG_R8), MEM(32, REG_RBP));
+	asm_ins2(MN_MOVQ, R8(REG_R9), MEM(40, REG_RBP));
 }
 
 static void ms_emit_va_start(var_id result, struct function *func) {
 	struct ms_data *abi_data = func->abi_data;
 
-	asm_ins2("leaq", MEM(abi_data->n_args * 8 + 16, REG_RBP), R8(REG_RAX));
+	asm_ins2(MN_LEAQ, MEM(abi_data->n_args * 8 + 16, REG_RBP), R8(REG_RAX));
 	scalar_to_reg(result, REG_RDX);
-	asm_ins2("movq", R8(REG_RAX), MEM(0, REG_RDX));
+	asm_ins2(MN_MOVQ, R8(REG_RAX), MEM(0, REG_RDX));
 }
 
 static void ms_emit_va_arg(var_id result, var_id va_list, struct type *type) {
 	(void)result, (void)va_list, (void)type;
 
 	scalar_to_reg(va_list, REG_RBX); // va_list is a pointer to the actual va_list.
-	asm_ins2("movq", MEM(0, REG_RBX), R8(REG_RAX));
-	asm_ins2("leaq", MEM(8, REG_RAX), R8(REG_RDX));
-	asm_ins2("movq", R8(REG_RDX), MEM(0, REG_RBX));
-	asm_ins2("movq", MEM(0, REG_RAX), R8(REG_RAX));
+	asm_ins2(MN_MOVQ, MEM(0, REG_RBX), R8(REG_RAX));
+	asm_ins2(MN_LEAQ, MEM(8, REG_RAX), R8(REG_RDX));
+	asm_ins2(MN_MOVQ, R8(REG_RDX), MEM(0, REG_RBX));
+	asm_ins2(MN_MOVQ, MEM(0, REG_RAX), R8(REG_RAX));
 	if (fits_into_reg(type)) {
 		reg_to_scalar(REG_RAX, result);
 	} else {
-		asm_ins2("movq", R8(REG_RAX), R8(REG_RDI));
-		asm_ins2("leaq", MEM(-variable_info[result].stack_location, REG_RBP), R8(REG_RSI));
+		asm_ins2(MN_MOVQ, R8(REG_RAX), R8(REG_RDI));
+		asm_ins2(MN_LEAQ, MEM(-variable_info[result].stack_location, REG_RBP), R8(REG_RSI));
 		codegen_memcpy(get_variable_size(result));
 	}
 }
@@ -231,7 +231,7 @@ void abi_init_microsoft(void) {
 
 	// Initialize the __builtin_va_list typedef.
 	struct symbol_typedef *sym =
-		symbols_add_typedef(sv_from_str("__builtin_va_list"));
+		symbols_add_typedef(sv_intern_str("__builtin_va_list"));
 
 	sym->data_type = type_pointer(type_simple(ST_VOID));
 
@@ -245,7 +245,7 @@ void abi_init_mingw_workarounds(void) {
 	// compilation with the mingw libc headers.
 	// It is very annoying that they require va_list to be typedeffed.
 	define_string("_VA_LIST_DEFINED", "1");
-	symbols_add_typedef(sv_from_str("va_list"))->data_type = type_pointer(type_simple(ST_VOID));
+	symbols_add_typedef(sv_intern_str("va_list"))->data_type = type_pointer(type_simple(ST_VOID));
 	define_string("_crt_va_start", "__builtin_va_start");
 	define_string("_crt_va_end", "__builtin_va_end");
 	define_string("_crt_va_arg", "__builtin_va_arg");
@@ -370,12 +370,12 @@ static void sysv_emit_function_preamble(struct function *func) {
 		return;
 
 	int position = variable_info[abi_data->reg_save_area].stack_location;
-	asm_ins2("movq", R8(REG_RDI), MEM(0 - position, REG_RBP));
-	asm_ins2("movq", R8(REG_RSI), MEM(8 - position, REG_RBP));
-	asm_ins2("movq", R8(REG_RDX), MEM(16 - position, REG_RBP));
-	asm_ins2("movq", R8(REG_RCX), MEM(24 - position, REG_RBP));
-	asm_ins2("movq", R8(REG_R8), MEM(32 - position, REG_RBP));
-	asm_ins2("movq", R8(REG_R9), MEM(40 - position, REG_RBP));
+	asm_ins2(MN_MOVQ, R8(REG_RDI), MEM(0 - position, REG_RBP));
+	asm_ins2(MN_MOVQ, R8(REG_RSI), MEM(8 - position, REG_RBP));
+	asm_ins2(MN_MOVQ, R8(REG_RDX), MEM(16 - position, REG_RBP));
+	asm_ins2(MN_MOVQ, R8(REG_RCX), MEM(24 - position, REG_RBP));
+	asm_ins2(MN_MOVQ, R8(REG_R8), MEM(32 - position, REG_RBP));
+	asm_ins2(MN_MOVQ, R8(REG_R9), MEM(40 - position, REG_RBP));
 }
 
 static void sysv_emit_va_start(var_id result, struct function *func) {
@@ -385,13 +385,13 @@ static void sysv_emit_va_start(var_id result, struct function *func) {
 	int overflow_arg_area_offset = builtin_va_list->fields[2].offset;
 	int reg_save_area_offset = builtin_va_list->fields[3].offset;
 	scalar_to_reg(result, REG_RAX);
-	asm_ins2("movl", IMM(abi_data->gp_offset), MEM(gp_offset_offset, REG_RAX));
-	asm_ins2("movl", IMM(0), MEM(fp_offset_offset, REG_RAX));
-	asm_ins2("leaq", MEM(abi_data->overflow_position, REG_RBP), R8(REG_RDI));
-	asm_ins2("movq", R8(REG_RDI), MEM(overflow_arg_area_offset, REG_RAX));
+	asm_ins2(MN_MOVL, IMM(abi_data->gp_offset), MEM(gp_offset_offset, REG_RAX));
+	asm_ins2(MN_MOVL, IMM(0), MEM(fp_offset_offset, REG_RAX));
+	asm_ins2(MN_LEAQ, MEM(abi_data->overflow_position, REG_RBP), R8(REG_RDI));
+	asm_ins2(MN_MOVQ, R8(REG_RDI), MEM(overflow_arg_area_offset, REG_RAX));
 
-	asm_ins2("leaq", MEM(-variable_info[abi_data->reg_save_area].stack_location, REG_RBP), R8(REG_RDI));
-	asm_ins2("movq", R8(REG_RDI), MEM(reg_save_area_offset, REG_RAX));
+	asm_ins2(MN_LEAQ, MEM(-variable_info[abi_data->reg_save_area].stack_location, REG_RBP), R8(REG_RDI));
+	asm_ins2(MN_MOVQ, R8(REG_RDI), MEM(reg_save_area_offset, REG_RAX));
 }
 
 static void sysv_emit_va_arg(var_id result, var_id va_list, struct type *type) {
@@ -426,9 +426,9 @@ static void sysv_emit_va_arg(var_id result, var_id va_list, struct type *type) {
 		//     l->fp_offset > 304 − num_fp ∗ 16
 		// go to step 7.
 
-		asm_ins2("movl", MEM(gp_offset_offset, REG_RDI), R4(REG_RAX));
-		asm_ins2("cmpl", IMM(48 - 8 * num_gp), R4(REG_RAX));
-		asm_ins1("ja", IMML_ABS(stack_label, 0));
+		asm_ins2(MN_MOVL, MEM(gp_offset_offset, REG_RDI), R4(REG_RAX));
+		asm_ins2(MN_CMPL, IMM(48 - 8 * num_gp), R4(REG_RAX));
+		asm_ins1(MN_JA, IMML_ABS(stack_label, 0));
 
 		// 4. Fetch type from l->reg_save_area with an offset of l->gp_offset
 		// and/or l->fp_offset. This may require copying to a temporary loca-
@@ -441,10 +441,10 @@ static void sysv_emit_va_arg(var_id result, var_id va_list, struct type *type) {
 		// l->fp_offset = l->fp_offset + num_fp ∗ 16.
 		// 6. Return the fetched type.
 
-		asm_ins2("leal", MEM(num_gp * 8, REG_RAX), R4(REG_RDX));
-		asm_ins2("addq", MEM(reg_save_area_offset, REG_RDI), R8(REG_RAX));
-		asm_ins2("movl", R4(REG_RDX), MEM(gp_offset_offset, REG_RDI));
-		asm_ins1("jmp", IMML_ABS(fetch_label, 0));
+		asm_ins2(MN_LEAL, MEM(num_gp * 8, REG_RAX), R4(REG_RDX));
+		asm_ins2(MN_ADDQ, MEM(reg_save_area_offset, REG_RDI), R8(REG_RAX));
+		asm_ins2(MN_MOVL, R4(REG_RDX), MEM(gp_offset_offset, REG_RDI));
+		asm_ins1(MN_JMP, IMML_ABS(fetch_label, 0));
 	}
 	// 7. Align l->overflow_arg_area upwards to a 16 byte boundary if align-
 	//ment needed by type exceeds 8 byte boundary. [This is ignored.]
@@ -452,20 +452,20 @@ static void sysv_emit_va_arg(var_id result, var_id va_list, struct type *type) {
 
 	// 8. Fetch type from l->overflow_arg_area.
 
-	asm_ins2("movq", MEM(overflow_arg_area_offset, REG_RDI), R8(REG_RAX));
+	asm_ins2(MN_MOVQ, MEM(overflow_arg_area_offset, REG_RDI), R8(REG_RAX));
 
 	// 9. Set l->overflow_arg_area to:
 	// l->overflow_arg_area + sizeof(type)
 	// 10. Align l->overflow_arg_area upwards to an 8 byte boundary.
-	asm_ins2("leaq", MEM(round_up_to_nearest(calculate_size(type), 8), REG_RAX), R8(REG_RDX));
-	asm_ins2("movq", R8(REG_RDX), MEM(overflow_arg_area_offset, REG_RDI));
+	asm_ins2(MN_LEAQ, MEM(round_up_to_nearest(calculate_size(type), 8), REG_RAX), R8(REG_RDX));
+	asm_ins2(MN_MOVQ, R8(REG_RDX), MEM(overflow_arg_area_offset, REG_RDI));
 
 	// 11. Return the fetched type.
 	asm_label(0, fetch_label);
 
 	// Address is now in %%rax.
-	asm_ins2("movq", R8(REG_RAX), R8(REG_RDI));
-	asm_ins2("leaq", MEM(-variable_info[result].stack_location, REG_RBP), R8(REG_RSI));
+	asm_ins2(MN_MOVQ, R8(REG_RAX), R8(REG_RDI));
+	asm_ins2(MN_LEAQ, MEM(-variable_info[result].stack_location, REG_RBP), R8(REG_RSI));
 
 	codegen_memcpy(calculate_size(type));
 }
@@ -505,7 +505,7 @@ void abi_init_sysv(void) {
 
 	// Initialize the __builtin_va_list typedef.
 	struct symbol_typedef *sym =
-		symbols_add_typedef(sv_from_str("__builtin_va_list"));
+		symbols_add_typedef(sv_intern_str("__builtin_va_list"));
 
 	struct type *uint = type_simple(ST_UINT);
 	struct type *vptr = type_pointer(type_simple(ST_VOID));
@@ -514,13 +514,13 @@ void abi_init_sysv(void) {
 	for (int i = 0; i < 4; i++)
 		fields[i].bitfield = -1;
 	fields[0].type = uint;
-	fields[0].name = sv_from_str("gp_offset");
+	fields[0].name = sv_intern_str("gp_offset");
 	fields[1].type = uint;
-	fields[1].name = sv_from_str("fp_offset");
+	fields[1].name = sv_intern_str("fp_offset");
 	fields[2].type = vptr;
-	fields[2].name = sv_from_str("overflow_arg_area");
+	fields[2].name = sv_intern_str("overflow_arg_area");
 	fields[3].type = vptr;
-	fields[3].name = sv_from_str("reg_save_area");
+	fields[3].name = sv_intern_str("reg_save_area");
 
 	struct struct_data *struct_data = register_struct();
 	*struct_data = (struct struct_data) {
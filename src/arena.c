@@ -0,0 +1,59 @@
+#include "arena.h"
+#include "common.h"
+
+#include <string.h>
+
+#define ARENA_BLOCK_SIZE (256 * 1024)
+#define ARENA_ALIGNMENT 16
+
+// The header is 16 bytes, so data keeps the alignment of malloc.
+struct arena_block {
+	struct arena_block *next;
+	size_t size;
+	char data[];
+};
+
+static void use_block(struct arena *arena, struct arena_block *block) {
+	arena->current = block;
+	arena->ptr = block->data;
+	arena->left = block->size;
+}
+
+// Move to the next block that is large enough, blocks that are too
+// small are skipped until the arena is reset.
+static void next_block(struct arena *arena, size_t size) {
+	struct arena_block **it = arena->current ? &arena->current->next : &arena->first;
+	while (*it && (*it)->size < size)
+		it = &(*it)->next;
+
+	if (!*it) {
+		size_t block_size = MAX(size, ARENA_BLOCK_SIZE);
+		*it = malloc(sizeof **it + block_size);
+		**it = (struct arena_block) { .size = block_size };
+	}
+
+	use_block(arena, *it);
+}
+
+void *arena_alloc(struct arena *arena, size_t size) {
+	size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+
+	if (size > arena->left)
+		next_block(arena, size);
+
+	void *ret = arena->ptr;
+	arena->ptr += size;
+	arena->left -= size;
+	return ret;
+}
+
+char *arena_copy(struct arena *arena, const void *src, size_t size) {
+	char *ret = arena_alloc(arena, size);
+	memcpy(ret, src, size);
+	return ret;
+}
+
+void arena_reset(struct arena *arena) {
+	if (arena->first)
+		use_block(arena, arena->first);
+}
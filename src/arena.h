@@ -0,0 +1,20 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Region allocator. Allocations are not freed individually, instead
+// everything allocated in an arena is released at once.
+struct arena {
+	struct arena_block *first, *current;
+	char *ptr;
+	size_t left;
+};
+
+void *arena_alloc(struct arena *arena, size_t size);
+char *arena_copy(struct arena *arena, const void *src, size_t size);
+
+// Releases all allocations, the blocks are kept and reused.
+void arena_reset(struct arena *arena);
+
+#endif
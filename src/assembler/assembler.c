@@ -15,6 +15,14 @@ struct assembler_flags assembler_flags = {
 	.half_assemble = 0, .elf = 0
 };
 
+const char *mnemonic_names[MN_COUNT] = {
+#define X(A, B) B,
+#include "mnemonics.h"
+#undef X
+};
+
+struct asm_buffer asm_buffer;
+
 static FILE *out;
 static const char *current_section;
 const char *out_path = NULL;
@@ -34,6 +42,8 @@ void asm_init_text_out(const char *path) {
 }
 
 void asm_finish(void) {
+	asm_flush();
+
 	if (assembler_flags.elf) {
 		elf_finish(out_path);
 	} else {
@@ -41,80 +51,89 @@ void asm_finish(void) {
 	}
 }
 
-// Emit.
-static void asm_emit_no_newline(const char *fmt, ...) {
+static struct asm_item *add_item(int type) {
+	struct asm_item *item = &ADD_ELEMENT(asm_buffer.size, asm_buffer.cap, asm_buffer.items);
+	item->type = type;
+	return item;
+}
+
+void asm_section(const char *section) {
+	add_item(ITEM_SECTION)->section = section;
+}
+
+void asm_comment(const char *fmt, ...) {
 	if (assembler_flags.elf)
-		ICE("Can't emit assembly when writing elf files.");
+		return;
 
-	va_list args;
-	va_start(args, fmt);
-	vfprintf(out, fmt, args);
-	va_end(args);
+	va_list args1, args2;
+	va_start(args1, fmt);
+	va_copy(args2, args1);
+	int len = vsnprintf(NULL, 0, fmt, args1);
+	char *comment = malloc(len + 1);
+	vsprintf(comment, fmt, args2);
+	va_end(args1);
+	va_end(args2);
+
+	add_item(ITEM_COMMENT)->comment = comment;
 }
 
-static void emit_label(label_id id) {
-	char buffer[64];
-	rodata_get_label(id, sizeof buffer, buffer);
-	asm_emit_no_newline("%s", buffer);
+void asm_label(int global, label_id label) {
+	struct asm_item *item = add_item(ITEM_LABEL);
+	item->label.global = global;
+	item->label.label = label;
 }
 
-void asm_section(const char *section) {
-	if (assembler_flags.elf) {
-		elf_set_section(section);
-	} else {
-		if (strcmp(section, current_section) != 0)
-			asm_emit_no_newline(".section %s\n", section);
-		current_section = section;
-	}
+void asm_string(struct string_view str) {
+	add_item(ITEM_STRING)->string = str;
 }
 
-void asm_comment(const char *fmt, ...) {
+void asm_ins(struct asm_instruction *ins) {
+	add_item(ITEM_INSTRUCTION)->ins = *ins;
+}
+
+void asm_ins0(enum mnemonic mnemonic) {
+	asm_ins(&(struct asm_instruction) { mnemonic, { { 0 } } });
+}
+
+void asm_ins1(enum mnemonic mnemonic, struct operand op1) {
+	asm_ins(&(struct asm_instruction) { mnemonic, { op1 } });
+}
+
+void asm_ins2(enum mnemonic mnemonic, struct operand op1, struct operand op2) {
+	asm_ins(&(struct asm_instruction) { mnemonic, { op1, op2 } });
+}
+
+void asm_ins3(enum mnemonic mnemonic, struct operand op1, struct operand op2, struct operand op3) {
+	asm_ins(&(struct asm_instruction) { mnemonic, { op1, op2, op3 } });
+}
+
+void asm_quad(struct operand op) {
+	add_item(ITEM_QUAD)->op = op;
+}
+
+void asm_byte(struct operand op) {
+	add_item(ITEM_BYTE)->op = op;
+}
+
+void asm_zero(int len) {
+	add_item(ITEM_ZERO)->zero = len;
+}
+
+// Text backends, used for assembly and half assembled output.
+static void asm_emit_no_newline(const char *fmt, ...) {
 	if (assembler_flags.elf)
-		return;
+		ICE("Can't emit assembly when writing elf files.");
 
 	va_list args;
 	va_start(args, fmt);
-	fprintf(out, "\t#");
 	vfprintf(out, fmt, args);
-	fprintf(out, "\n");
 	va_end(args);
 }
 
-void asm_label(int global, label_id label) {
-	if (assembler_flags.elf) {
-		elf_symbol_set(label, global);
-	} else {
-		if (global) {
-			fprintf(out, ".global ");
-			emit_label(label);
-			fprintf(out, "\n");
-		}
-
-		emit_label(label);
-		fprintf(out, ":\n");
-	}
-}
-
-void asm_string(struct string_view str) {
-	if (assembler_flags.elf) {
-		elf_write((uint8_t *)str.str, str.len);
-		elf_write_byte(0);
-	} else if (assembler_flags.half_assemble) {
-		asm_emit_no_newline("\t.byte ");
-		for (int i = 0; i < str.len; i++) {
-			asm_emit_no_newline("0x%.2x", (uint8_t)str.str[i]);
-			asm_emit_no_newline(", ");
-		}
-		asm_emit_no_newline("0x0\n");
-	} else {
-		asm_emit_no_newline("\t.string \"");
-		for (int i = 0; i < str.len; i++) {
-			char buffer[5];
-			character_to_escape_sequence(str.str[i], buffer, 0);
-			asm_emit_no_newline("%s", buffer);
-		}
-		asm_emit_no_newline("\"\n");
-	}
+static void emit_label(label_id id) {
+	char buffer[64];
+	rodata_get_label(id, sizeof buffer, buffer);
+	asm_emit_no_newline("%s", buffer);
 }
 
 static void asm_emit_operand(struct operand op) {
@@ -171,137 +190,222 @@ static void asm_emit_operand(struct operand op) {
 	}
 }
 
-void asm_ins_impl(const char *mnemonic, struct operand ops[4]) {
-	if (assembler_flags.half_assemble || assembler_flags.elf) {
-		// Swap order of instructions.
-		struct operand swapped[4] = { 0 };
-		for (int i = 3, j = 0; i >= 0; i--) {
-			if (ops[i].type)
-				swapped[j++] = ops[i];
-		}
+// Instructions are encoded with the operands in Intel order.
+static void encode(struct asm_instruction *ins, uint8_t output[15], int *len,
+				   struct relocation relocations[4], int *n_relocations) {
+	struct operand swapped[4] = { 0 };
+	for (int i = 3, j = 0; i >= 0; i--) {
+		if (ins->ops[i].type)
+			swapped[j++] = ins->ops[i];
+	}
+
+	*n_relocations = 0;
+	assemble_instruction(output, len, ins->mnemonic, swapped,
+						 relocations, n_relocations);
+
+	if (*len == -1)
+		ICE("Could not assemble %s %d %d %d %d", mnemonic_names[ins->mnemonic],
+			ins->ops[0].type, ins->ops[1].type, ins->ops[2].type, ins->ops[3].type);
+}
+
+static void text_instruction(struct asm_instruction *ins) {
+	asm_emit_no_newline("\t%s ", mnemonic_names[ins->mnemonic]);
+	for (int i = 0; i < 4 && ins->ops[i].type; i++) {
+		if (i)
+			asm_emit_no_newline(", ");
+
+		asm_emit_operand(ins->ops[i]);
+	}
+	asm_emit_no_newline("\n");
+}
 
-		struct relocation relocations[4];
-		int n_relocations = 0;
-		uint8_t output[15];
-		int len;
-		assemble_instruction(output, &len, mnemonic, swapped,
-							 relocations, &n_relocations);
-
-		if (len == -1)
-			ICE("Could not assemble %s %d %d %d %d", mnemonic, ops[0].type, ops[1].type, ops[2].type, ops[3].type);
-
-		int next_relocation_idx = 0;
-
-		if (assembler_flags.elf) {
-			for (int i = 0; i < n_relocations; i++) {
-				struct relocation *rel = relocations + i;
-
-				switch (rel->size) {
-				case 8:
-					if (rel->relative)
-						NOTIMP();
-					elf_symbol_relocate(rel->label, rel->offset, rel->imm, R_X86_64_64);
-					break;
-
-				case 4:
-					if (rel->relative)
-						elf_symbol_relocate(rel->label, rel->offset, -(len - rel->offset), R_X86_64_PC32);
-					else
-						elf_symbol_relocate(rel->label, rel->offset, rel->imm, R_X86_64_32S);
-					break;
-
-				default:
-					printf("%d %s\n", rel->size, mnemonic);
+static void half_assembled_instruction(struct asm_instruction *ins) {
+	struct relocation relocations[4];
+	int n_relocations;
+	uint8_t output[15];
+	int len;
+	encode(ins, output, &len, relocations, &n_relocations);
+
+	int next_relocation_idx = 0;
+	int first = 1;
+	for (int i = 0; i < len; i++) {
+		if (next_relocation_idx < n_relocations &&
+			relocations[next_relocation_idx].offset == i) {
+			struct relocation *rel = relocations + next_relocation_idx++;
+
+			switch (rel->size) {
+			case 8:
+				if (rel->relative) {
 					NOTIMP();
+				} else {
+					asm_emit_no_newline("\n", output[i]);
+					asm_emit_no_newline(".quad ");
+					emit_label(rel->label);
+					asm_emit_no_newline("+%" PRIi64, rel->imm);
 				}
-			}
-			elf_write(output, len);
-		} else if (assembler_flags.half_assemble) {
-			int first = 1;
-			for (int i = 0; i < len; i++) {
-				if (next_relocation_idx < n_relocations &&
-					relocations[next_relocation_idx].offset == i) {
-					struct relocation *rel = relocations + next_relocation_idx++;
-
-					switch (rel->size) {
-					case 8:
-						if (rel->relative) {
-							NOTIMP();
-						} else {
-							asm_emit_no_newline("\n", output[i]);
-							asm_emit_no_newline(".quad ");
-							emit_label(rel->label);
-							asm_emit_no_newline("+%" PRIi64, rel->imm);
-						}
-						break;
-
-					case 4:
-						if (rel->relative) {
-							asm_emit_no_newline("\n", output[i]);
-							asm_emit_no_newline(".long (");
-							emit_label(rel->label);
-							asm_emit_no_newline("- .)+%" PRIi64, rel->imm + -4);
-						} else {
-							asm_emit_no_newline("\n", output[i]);
-							asm_emit_no_newline(".long ");
-							emit_label(rel->label);
-							asm_emit_no_newline("+%" PRIi64, rel->imm);
-						}
-						break;
-
-					default:
-						printf("%d %s\n", rel->size, mnemonic);
-						NOTIMP();
-					}
-
-					i += rel->size - 1;
-
-					first = 1;
-					continue;
-				}
-
-				if (first) {
-					asm_emit_no_newline("\t.byte ");
-					first = 0;
+				break;
+
+			case 4:
+				if (rel->relative) {
+					asm_emit_no_newline("\n", output[i]);
+					asm_emit_no_newline(".long (");
+					emit_label(rel->label);
+					asm_emit_no_newline("- .)+%" PRIi64, rel->imm + -4);
 				} else {
-					asm_emit_no_newline(", ", output[i]);
+					asm_emit_no_newline("\n", output[i]);
+					asm_emit_no_newline(".long ");
+					emit_label(rel->label);
+					asm_emit_no_newline("+%" PRIi64, rel->imm);
 				}
+				break;
 
-				asm_emit_no_newline("0x%.2x", output[i]);
+			default:
+				printf("%d %s\n", rel->size, mnemonic_names[ins->mnemonic]);
+				NOTIMP();
 			}
-			asm_emit_no_newline("\n");
+
+			i += rel->size - 1;
+
+			first = 1;
+			continue;
 		}
-	} else {
-		asm_emit_no_newline("\t%s ", mnemonic);
-		for (int i = 0; i < 4 && ops[i].type; i++) {
-			if (i)
-				asm_emit_no_newline(", ");
 
-			asm_emit_operand(ops[i]);
+		if (first) {
+			asm_emit_no_newline("\t.byte ");
+			first = 0;
+		} else {
+			asm_emit_no_newline(", ", output[i]);
 		}
-		asm_emit_no_newline("\n");
+
+		asm_emit_no_newline("0x%.2x", output[i]);
 	}
+	asm_emit_no_newline("\n");
 }
 
-void asm_ins(struct asm_instruction *ins) {
-	asm_ins_impl(ins->mnemonic, ins->ops);
+static void text_string(struct string_view str) {
+	if (assembler_flags.half_assemble) {
+		asm_emit_no_newline("\t.byte ");
+		for (int i = 0; i < str.len; i++) {
+			asm_emit_no_newline("0x%.2x", (uint8_t)str.str[i]);
+			asm_emit_no_newline(", ");
+		}
+		asm_emit_no_newline("0x0\n");
+	} else {
+		asm_emit_no_newline("\t.string \"");
+		for (int i = 0; i < str.len; i++) {
+			char buffer[5];
+			character_to_escape_sequence(str.str[i], buffer, 0);
+			asm_emit_no_newline("%s", buffer);
+		}
+		asm_emit_no_newline("\"\n");
+	}
 }
 
-void asm_ins0(const char *mnemonic) {
-	asm_ins_impl(mnemonic, (struct operand[4]) { 0 });
-}
+static void text_item(struct asm_item *item) {
+	switch (item->type) {
+	case ITEM_INSTRUCTION:
+		if (assembler_flags.half_assemble)
+			half_assembled_instruction(&item->ins);
+		else
+			text_instruction(&item->ins);
+		break;
+
+	case ITEM_LABEL:
+		if (item->label.global) {
+			asm_emit_no_newline(".global ");
+			emit_label(item->label.label);
+			asm_emit_no_newline("\n");
+		}
+
+		emit_label(item->label.label);
+		asm_emit_no_newline(":\n");
+		break;
+
+	case ITEM_SECTION:
+		if (strcmp(item->section, current_section) != 0)
+			asm_emit_no_newline(".section %s\n", item->section);
+		current_section = item->section;
+		break;
+
+	case ITEM_COMMENT:
+		asm_emit_no_newline("\t#%s\n", item->comment);
+		free(item->comment);
+		break;
+
+	case ITEM_QUAD:
+		asm_emit_no_newline(".quad ");
+		asm_emit_operand(item->op);
+		asm_emit_no_newline("\n");
+		break;
+
+	case ITEM_BYTE:
+		asm_emit_no_newline(".byte ");
+		asm_emit_operand(item->op);
+		asm_emit_no_newline("\n");
+		break;
 
-void asm_ins1(const char *mnemonic, struct operand op1) {
-	asm_ins_impl(mnemonic, (struct operand[4]) { op1 });
+	case ITEM_ZERO:
+		asm_emit_no_newline(".zero %d\n", item->zero);
+		break;
+
+	case ITEM_STRING:
+		text_string(item->string);
+		break;
+	}
 }
 
-void asm_ins2(const char *mnemonic, struct operand op1, struct operand op2) {
-	asm_ins_impl(mnemonic, (struct operand[4]) { op1, op2 });
+// ELF backend.
+static void elf_instruction(struct asm_instruction *ins) {
+	struct relocation relocations[4];
+	int n_relocations;
+	uint8_t output[15];
+	int len;
+	encode(ins, output, &len, relocations, &n_relocations);
+
+	for (int i = 0; i < n_relocations; i++) {
+		struct relocation *rel = relocations + i;
+
+		switch (rel->size) {
+		case 8:
+			if (rel->relative)
+				NOTIMP();
+			elf_symbol_relocate(rel->label, rel->offset, rel->imm, R_X86_64_64);
+			break;
+
+		case 4:
+			if (rel->relative)
+				elf_symbol_relocate(rel->label, rel->offset, -(len - rel->offset), R_X86_64_PC32);
+			else
+				elf_symbol_relocate(rel->label, rel->offset, rel->imm, R_X86_64_32S);
+			break;
+
+		default:
+			printf("%d %s\n", rel->size, mnemonic_names[ins->mnemonic]);
+			NOTIMP();
+		}
+	}
+	elf_write(output, len);
 }
 
-void asm_quad(struct operand op) {
-	if (assembler_flags.elf) {
-		switch (op.type) {
+static void elf_item(struct asm_item *item) {
+	switch (item->type) {
+	case ITEM_INSTRUCTION:
+		elf_instruction(&item->ins);
+		break;
+
+	case ITEM_LABEL:
+		elf_symbol_set(item->label.label, item->label.global);
+		break;
+
+	case ITEM_SECTION:
+		elf_set_section(item->section);
+		break;
+
+	case ITEM_COMMENT:
+		break;
+
+	case ITEM_QUAD:
+		switch (item->op.type) {
 		case OPERAND_IMM:
 			NOTIMP();
 			break;
@@ -310,43 +414,46 @@ void asm_quad(struct operand op) {
 			break;
 
 		case OPERAND_IMM_ABSOLUTE:
-			elf_write_quad(op.imm);
+			elf_write_quad(item->op.imm);
 			break;
 
 		case OPERAND_IMM_LABEL_ABSOLUTE:
-			elf_symbol_relocate(op.imm_label.label_, 0, op.imm_label.offset, R_X86_64_64);
+			elf_symbol_relocate(item->op.imm_label.label_, 0, item->op.imm_label.offset, R_X86_64_64);
 			elf_write_quad(0);
 			break;
 
 		default: NOTIMP();
 		}
-	} else {
-		asm_emit_no_newline(".quad ");
-		asm_emit_operand(op);
-		asm_emit_no_newline("\n");
-	}
-}
+		break;
 
-void asm_byte(struct operand op) {
-	if (assembler_flags.elf) {
-		switch (op.type) {
+	case ITEM_BYTE:
+		switch (item->op.type) {
 		case OPERAND_IMM_ABSOLUTE:
-			elf_write_byte(op.imm);
+			elf_write_byte(item->op.imm);
 			break;
 
 		default: NOTIMP();
 		}
-	} else {
-		asm_emit_no_newline(".byte ");
-		asm_emit_operand(op);
-		asm_emit_no_newline("\n");
+		break;
+
+	case ITEM_ZERO:
+		elf_write_zero(item->zero);
+		break;
+
+	case ITEM_STRING:
+		elf_write((uint8_t *)item->string.str, item->string.len);
+		elf_write_byte(0);
+		break;
 	}
 }
 
-void asm_zero(int len) {
-	if (assembler_flags.elf) {
-		elf_write_zero(len);
-	} else {
-		asm_emit_no_newline(".zero %d\n", len);
+void asm_flush(void) {
+	for (size_t i = 0; i < asm_buffer.size; i++) {
+		if (assembler_flags.elf)
+			elf_item(asm_buffer.items + i);
+		else
+			text_item(asm_buffer.items + i);
 	}
+
+	asm_buffer.size = 0;
 }
@@ -2,6 +2,7 @@
 #define ASSEMBLER_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include <string_view.h>
 #include <codegen/rodata.h>
 
@@ -96,20 +97,65 @@ struct operand {
 void asm_init_text_out(const char *path);
 void asm_finish(void);
 
-// Emit.
-void asm_section(const char *section);
-void asm_comment(const char *fmt, ...);
+enum mnemonic {
+#define X(A, B) A,
+#include "mnemonics.h"
+#undef X
+	MN_COUNT
+};
+
+extern const char *mnemonic_names[MN_COUNT];
 
 struct asm_instruction {
-	const char *mnemonic;
+	enum mnemonic mnemonic;
 	struct operand ops[4];
 };
 
+// Everything emitted is first collected in asm_buffer, and is written
+// to the output by asm_flush, which codegen calls after each function.
+// The text, half assembled, and ELF outputs all read from the buffer.
+struct asm_item {
+	enum {
+		ITEM_INSTRUCTION,
+		ITEM_LABEL,
+		ITEM_SECTION,
+		ITEM_COMMENT,
+		ITEM_QUAD,
+		ITEM_BYTE,
+		ITEM_ZERO,
+		ITEM_STRING
+	} type;
+
+	union {
+		struct asm_instruction ins;
+		struct {
+			int global;
+			label_id label;
+		} label;
+		const char *section;
+		char *comment;
+		struct operand op;
+		int zero;
+		struct string_view string;
+	};
+};
+
+extern struct asm_buffer {
+	size_t size, cap;
+	struct asm_item *items;
+} asm_buffer;
+
+void asm_flush(void);
+
+// Emit.
+void asm_section(const char *section);
+void asm_comment(const char *fmt, ...);
+
 void asm_ins(struct asm_instruction *ins);
-void asm_ins0(const char *mnemonic);
-void asm_ins1(const char *mnemonic, struct operand op1);
-void asm_ins2(const char *mnemonic, struct operand op1, struct operand op2);
-void asm_ins3(const char *mnemonic, struct operand op1, struct operand op2, struct operand op3);
+void asm_ins0(enum mnemonic mnemonic);
+void asm_ins1(enum mnemonic mnemonic, struct operand op1);
+void asm_ins2(enum mnemonic mnemonic, struct operand op1, struct operand op2);
+void asm_ins3(enum mnemonic mnemonic, struct operand op1, struct operand op2, struct operand op3);
 
 void asm_quad(struct operand op);
 void asm_byte(struct operand op);
@@ -57,7 +57,8 @@ static int register_string(const char *str) {
 }
 
 struct rela {
-	int symb_idx;
+	label_id label;
+	int symb_idx; // Set by resolve_relocations().
 	uint64_t offset;
 	uint64_t type;
 	uint64_t add;
@@ -77,7 +78,8 @@ struct section {
 
 struct symbol {
 	int string_idx; // gotten from register_string()
-	char *name;
+	label_id label;
+	int referenced; // Temporary labels are only written if a relocation uses them.
 	uint64_t value;
 	uint64_t size;
 	int section;
@@ -90,30 +92,35 @@ struct symbol {
 size_t symbol_size, symbol_cap;
 struct symbol *symbols;
 
-static int find_symbol(label_id label) {
-	char buffer[64];
-
-	rodata_get_label(label, sizeof buffer, buffer);
-
-	for (unsigned i = 0; i < symbol_size; i++) {
-		if (symbols[i].name && strcmp(symbols[i].name, buffer) == 0)
-			return i;
+// Label ids are dense, temporary labels count down from -2 and named
+// labels count up from 0. Each maps to its symbol index plus one.
+static size_t named_size, temporary_size;
+static int *named_symbols, *temporary_symbols;
+
+static int *symbol_slot(label_id label) {
+	int **array = label < 0 ? &temporary_symbols : &named_symbols;
+	size_t *size = label < 0 ? &temporary_size : &named_size;
+	size_t idx = label < 0 ? (size_t)-label : (size_t)label;
+
+	if (idx >= *size) {
+		size_t new_size = MAX(*size * 2, idx + 1);
+		*array = realloc(*array, sizeof **array * new_size);
+		memset(*array + *size, 0, sizeof **array * (new_size - *size));
+		*size = new_size;
 	}
 
-	return -1;
+	return *array + idx;
 }
 
-int elf_new_symbol(label_id label) {
-	struct symbol symb = { .section = -1, .global = -1 };
-
-	if (label != -1) {
-		char buffer[64];
+static int find_symbol(label_id label) {
+	return *symbol_slot(label) - 1;
+}
 
-		rodata_get_label(label, sizeof buffer, buffer);
+int elf_new_symbol(label_id label) {
+	struct symbol symb = { .section = -1, .global = -1, .label = label };
 
-		symb.string_idx = register_string(buffer);
-		symb.name = strdup(buffer);
-	}
+	if (label != -1)
+		*symbol_slot(label) = symbol_size + 1;
 
 	ADD_ELEMENT(symbol_size, symbol_cap, symbols) = symb;
 
@@ -181,12 +188,7 @@ void elf_symbol_relocate(label_id label, int64_t offset, int64_t add, int type)
 									 current_section->rela_cap,
 									 current_section->relas);
 
-	int idx = find_symbol(label);
-	if (idx == -1) {
-		idx = elf_new_symbol(label);
-	}
-
-	rela->symb_idx = idx;
+	rela->label = label;
 	rela->offset = current_section->size + offset;
 	rela->type = type;
 	rela->add = add;
@@ -359,51 +361,78 @@ static void allocate_sections(void) {
 	}
 }
 
-uint8_t *symbol_table_write(int *n_local) {
-	uint8_t *buffer = calloc((symbol_size + 1), 24);
+// Relative jumps to temporary labels in the same section are patched
+// directly, other relocations go through the symbol table.
+static void resolve_relocations(struct section *section) {
+	size_t n = 0;
+	for (size_t i = 0; i < section->rela_size; i++) {
+		struct rela *rela = section->relas + i;
+		int idx = find_symbol(rela->label);
+
+		if (rela->label < -1 && idx != -1 && rela->type == R_X86_64_PC32 &&
+			symbols[idx].section == section->idx) {
+			int32_t value = symbols[idx].value + rela->add - rela->offset;
+			memcpy(section->data + rela->offset, &value, sizeof value);
+			continue;
+		}
+
+		if (idx == -1)
+			idx = elf_new_symbol(rela->label);
+		symbols[idx].referenced = 1;
+		rela->symb_idx = idx;
+		section->relas[n++] = *rela;
+	}
+	section->rela_size = n;
+}
+
+static int is_written(struct symbol *symbol) {
+	return symbol->label >= -1 || symbol->referenced;
+}
 
+static void write_symbol(uint8_t *buffer, struct symbol *symbol, int idx, int info) {
+	uint8_t *ent_addr = buffer + idx * 24;
+
+	if (symbol->label != -1) {
+		char name[64];
+		rodata_get_label(symbol->label, sizeof name, name);
+		symbol->string_idx = register_string(name);
+	}
+
+	*(uint32_t *)(ent_addr + 0) = symbol->string_idx; // st_name
+	*(uint8_t *)(ent_addr + 4) = info; // st_info
+	*(uint8_t *)(ent_addr + 5) = 0; // st_other
+	if (symbol->section != -1)
+		*(uint16_t *)(ent_addr + 6) = sections[symbol->section].sh_idx; // st_shndx
+	else
+		*(uint16_t *)(ent_addr + 6) = 0; // st_shndx
+	*(uint64_t *)(ent_addr + 8) = symbol->value; // st_value
+	*(uint64_t *)(ent_addr + 16) = 0; // st_size
+
+	symbol->idx = idx;
+}
+
+uint8_t *symbol_table_write(int *n_local, int *n_total) {
 	*n_local = 1;
+	*n_total = 1;
 	for (unsigned i = 0; i < symbol_size; i++) {
+		if (!is_written(symbols + i))
+			continue;
+		(*n_total)++;
 		if (!symbols[i].global)
 			(*n_local)++;
 	}
 
+	uint8_t *buffer = calloc(*n_total, 24);
 	int curr_entry = 0;
 
 	for (unsigned i = 0; i < symbol_size; i++) {
-		if (symbols[i].global)
-			continue;
-		curr_entry++;
-		uint8_t *ent_addr = buffer + (curr_entry) * 24;
-		*(uint32_t *)(ent_addr + 0) = symbols[i].string_idx; // st_name
-		*(uint8_t *)(ent_addr + 4) = symbols[i].type; // st_info
-		*(uint8_t *)(ent_addr + 5) = 0; // st_other
-		if (symbols[i].section != -1)
-			*(uint16_t *)(ent_addr + 6) = sections[symbols[i].section].sh_idx; // st_shndx
-		else
-			*(uint16_t *)(ent_addr + 6) = 0; // st_shndx
-		*(uint64_t *)(ent_addr + 8) = symbols[i].value; // st_value
-		*(uint64_t *)(ent_addr + 16) = 0; // st_size
-
-		symbols[i].idx = curr_entry;
+		if (!symbols[i].global && is_written(symbols + i))
+			write_symbol(buffer, symbols + i, ++curr_entry, symbols[i].type);
 	}
 
 	for (unsigned i = 0; i < symbol_size; i++) {
-		if (!symbols[i].global)
-			continue;
-		curr_entry++;
-		uint8_t *ent_addr = buffer + (curr_entry) * 24;
-		*(uint32_t *)(ent_addr + 0) = symbols[i].string_idx; // st_name
-		*(uint8_t *)(ent_addr + 4) = STB_GLOBAL << 4 | symbols[i].type; // st_info
-		*(uint8_t *)(ent_addr + 5) = 0; // st_other
-		if (symbols[i].section != -1)
-			*(uint16_t *)(ent_addr + 6) = sections[symbols[i].section].sh_idx; // st_shndx
-		else
-			*(uint16_t *)(ent_addr + 6) = 0; // st_shndx
-		*(uint64_t *)(ent_addr + 8) = symbols[i].value; // st_value
-		*(uint64_t *)(ent_addr + 16) = 0; // st_size
-
-		symbols[i].idx = curr_entry;
+		if (symbols[i].global && is_written(symbols + i))
+			write_symbol(buffer, symbols + i, ++curr_entry, STB_GLOBAL << 4 | symbols[i].type);
 	}
 
 	return buffer;
@@ -436,16 +465,22 @@ void elf_finish(const char *path) {
 
 		elf_sections[id].size = section->size;
 		elf_sections[id].data = section->data;
-		elf_sections[id].header.sh_flags = SHF_ALLOC | SHF_EXECINSTR;
+		if (strcmp(section->name, ".rodata") == 0)
+			elf_sections[id].header.sh_flags = SHF_ALLOC;
+		else
+			elf_sections[id].header.sh_flags = SHF_ALLOC | SHF_EXECINSTR;
 
 		section->sh_idx = id;
 	}
 
+	for (unsigned i = 0; i < section_size; i++)
+		resolve_relocations(sections + i);
+
 	int sym = elf_add_section(register_shstring(".symtab"), SHT_SYMTAB);
 	elf_sections[sym].header.sh_entsize = 24;
-	elf_sections[sym].size = (symbol_size + 1) * 24;
-	int n_local_symb = 0;
-	elf_sections[sym].data = symbol_table_write(&n_local_symb);
+	int n_local_symb = 0, n_symb = 0;
+	elf_sections[sym].data = symbol_table_write(&n_local_symb, &n_symb);
+	elf_sections[sym].size = n_symb * 24;
 	elf_sections[sym].header.sh_info = n_local_symb;
 
 	for (unsigned i = 0; i < section_size; i++) {
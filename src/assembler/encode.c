@@ -70,6 +70,7 @@ void encode_sib(struct operand *o, int *rex_b, int *rex_x, int *modrm_mod, int *
 				   o->mem.base == REG_R13) {
 			*sib_index = 4;
 			*modrm_mod = 1;
+			*modrm_rm = 5;
 
 			*has_disp8 = 1;
 			*disp = 0;
@@ -114,6 +115,7 @@ void encode_sib(struct operand *o, int *rex_b, int *rex_x, int *modrm_mod, int *
 
 			*has_sib = 1;
 			*sib_index = 4;
+			*sib_base = 4;
 
 			*modrm_rm = register_index(o->mem.base) & 7;
 			*rex_b = (register_index(o->mem.base) & 0x8) >> 3;
@@ -190,7 +192,7 @@ void assemble_encoding(uint8_t *output, int *len, struct encoding *encoding, str
 		struct operand_encoding *oe = encoding->operand_encoding + j;
 
 		if ((o->type == OPERAND_EMPTY) != (oe->type == OE_EMPTY))
-			ICE("Invalid number of arguments to instruction %s", encoding->mnemonic);
+			ICE("Invalid number of arguments to instruction %s", mnemonic_names[encoding->mnemonic]);
 
 		if (o->type == OPERAND_REG &&
 			needs_rex(o->reg.reg, o->reg.upper_byte, o->reg.size))
@@ -245,16 +247,14 @@ void assemble_encoding(uint8_t *output, int *len, struct encoding *encoding, str
 				modrm_mod = 3;
 
 				modrm_rm = register_index(o->reg.reg);
-				if (has_rex)
-					rex_b = (modrm_rm & 0x8) >> 3;
+				rex_b = (modrm_rm & 0x8) >> 3;
 				break;
 
 			case OPERAND_SSE_REG:
 				modrm_mod = 3;
 
 				modrm_rm = o->sse_reg;
-				if (has_rex)
-					rex_b = (modrm_rm & 0x8) >> 3;
+				rex_b = (modrm_rm & 0x8) >> 3;
 				break;
 
 			case OPERAND_MEM: {
@@ -289,7 +289,8 @@ void assemble_encoding(uint8_t *output, int *len, struct encoding *encoding, str
 			break;
 
 		case OE_OPEXT:
-			op_ext = register_index(o->reg.reg);
+			op_ext = register_index(o->reg.reg) & 0x7;
+			rex_b = (register_index(o->reg.reg) & 0x8) >> 3;
 			break;
 
 		case OE_NONE:
@@ -491,7 +492,7 @@ int does_match(struct operand *o, struct operand_accepts *oa) {
 
 	case ACC_IMM8_S: {
 		long s = o->imm;
-		if (o->type != OPERAND_IMM && o->type != OPERAND_IMM_LABEL)
+		if (o->type != OPERAND_IMM)
 			return 0;
 		if (s < INT8_MIN || s > INT8_MAX)
 			return 0;
@@ -499,7 +500,7 @@ int does_match(struct operand *o, struct operand_accepts *oa) {
 
 	case ACC_IMM8_U: {
 		long s = o->imm;
-		if (o->type != OPERAND_IMM && o->type != OPERAND_IMM_LABEL)
+		if (o->type != OPERAND_IMM)
 			return 0;
 		if (s > UINT8_MAX)
 			return 0;
@@ -507,7 +508,7 @@ int does_match(struct operand *o, struct operand_accepts *oa) {
 
 	case ACC_IMM16_S: {
 		long s = o->imm;
-		if (o->type != OPERAND_IMM && o->type != OPERAND_IMM_LABEL)
+		if (o->type != OPERAND_IMM)
 			return 0;
 		if (s < INT16_MIN || s > INT16_MAX)
 			return 0;
@@ -515,7 +516,7 @@ int does_match(struct operand *o, struct operand_accepts *oa) {
 
 	case ACC_IMM16_U: {
 		long s = o->imm;
-		if (o->type != OPERAND_IMM && o->type != OPERAND_IMM_LABEL)
+		if (o->type != OPERAND_IMM)
 			return 0;
 		if (s > UINT16_MAX)
 			return 0;
@@ -525,14 +526,15 @@ int does_match(struct operand *o, struct operand_accepts *oa) {
 		long s = o->imm;
 		if (o->type != OPERAND_IMM && o->type != OPERAND_IMM_LABEL)
 			return 0;
-		if (s < INT32_MIN || s > INT32_MAX)
+		// Labels are resolved by 32-bit relocations.
+		if (o->type == OPERAND_IMM && (s < INT32_MIN || s > INT32_MAX))
 			return 0;
 	} break;
 
 	case ACC_IMM32_U: {
 		if (o->type != OPERAND_IMM && o->type != OPERAND_IMM_LABEL)
 			return 0;
-		if (o->imm > UINT32_MAX)
+		if (o->type == OPERAND_IMM && o->imm > UINT32_MAX)
 			return 0;
 	} break;
 
@@ -574,17 +576,36 @@ int does_match(struct operand *o, struct operand_accepts *oa) {
 	return 1;
 }
 
-void assemble_instruction(uint8_t *output, int *len, const char *mnemonic, struct operand ops[4],
+#define N_ENCODINGS (sizeof encodings / sizeof *encodings)
+
+// Encodings grouped by mnemonic, keeping the order of the table. The
+// encodings of mnemonic m are sorted[first[m]] to sorted[first[m + 1] - 1].
+static struct encoding *sorted[N_ENCODINGS];
+static int first[MN_COUNT + 1];
+
+static void index_encodings(void) {
+	for (unsigned i = 0; i < N_ENCODINGS; i++)
+		first[encodings[i].mnemonic + 1]++;
+
+	for (int i = 0; i < MN_COUNT; i++)
+		first[i + 1] += first[i];
+
+	int next[MN_COUNT];
+	memcpy(next, first, sizeof next);
+	for (unsigned i = 0; i < N_ENCODINGS; i++)
+		sorted[next[encodings[i].mnemonic]++] = encodings + i;
+}
+
+void assemble_instruction(uint8_t *output, int *len, enum mnemonic mnemonic, struct operand ops[4],
 						  struct relocation relocations[], int *n_relocations) {
 	int best_len = 16;
 	uint8_t best_output[15] = { 0 };
 
-	// TODO: Just order the instructions in such a way that we can just take the first one that appears.
-	for (unsigned i = 0; i < sizeof encodings / sizeof *encodings; i++) {
-		struct encoding *encoding = encodings + i;
+	if (!first[MN_COUNT])
+		index_encodings();
 
-		if (strcmp(encoding->mnemonic, mnemonic) != 0)
-			continue;
+	for (int i = first[mnemonic]; i < first[mnemonic + 1]; i++) {
+		struct encoding *encoding = sorted[i];
 
 		int matches = 1;
 		for (int j = 0; j < 4; j++) {
@@ -18,7 +18,7 @@ struct relocation {
 	uint64_t imm;
 };
 
-void assemble_instruction(uint8_t *output, int *len, const char *mnemonic, struct operand ops[4],
+void assemble_instruction(uint8_t *output, int *len, enum mnemonic mnemonic, struct operand ops[4],
 						  struct relocation relocations[], int *n_relocations);
 
 #endif
@@ -1,6 +1,8 @@
 #ifndef INSTRUCTIONS_H
 #define INSTRUCTIONS_H
 
+#include "assembler.h"
+
 #include <stdint.h>
 
 struct operand_encoding {
@@ -74,7 +76,7 @@ struct operand_accepts {
 #define A_RCX(SIZE) {.type = ACC_RCX, .reg.size = SIZE }
 
 struct encoding {
-	const char *mnemonic;
+	enum mnemonic mnemonic;
 	uint8_t opcode;
 	uint8_t op2, op3;
 	int rex, rexw;
@@ -92,179 +94,208 @@ struct encoding {
 // generated automatically from the manual at some
 // point.
 struct encoding encodings[] = {
-	{"addq", 0x05, .rex = 1, .rexw = 1, .operand_encoding = {{OE_NONE, 0}, {OE_IMM32, 0}}, .operand_accepts = {A_RAX(8), A_IMM32_S}},
-	{"addq", 0x04, .operand_encoding = {{OE_NONE, 0}, {OE_IMM8, 0}}, .operand_accepts = {A_REG(4), A_IMM8_S}},
-	{"addq", 0x83, .rex = 1, .rexw = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM8, 0}}, .operand_accepts = {A_REG(8), A_IMM8_S}},
-	{"addq", 0x81, .rexw = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM32, 0}}, .operand_accepts = {A_REG(8), A_IMM32_S}},
-	{"addl", 0x01, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_REG(4), A_REG(4)}},
-	{"addq", 0x01, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_REG(8), A_REG(8)}},
-	{"addq", 0x03, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(8), A_MODRM(8)}},
-
-	{"subq", 0x83, .rex = 1, .rexw = 1, .modrm_extension = 5, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM8, 0}}, .operand_accepts = {A_MODRM(8), A_IMM8_S}},
-	{"subq", 0x81, .rex = 1, .rexw = 1, .modrm_extension = 5, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM32, 0}}, .operand_accepts = {A_MODRM(8), A_IMM32_S}},
-	{"subq", 0x29, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(8), A_REG(8)}},
-	{"subl", 0x29, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(4), A_REG(4)}},
-
-	{"andl", 0x21, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_REG(4), A_REG(4)}},
-	{"andq", 0x21, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_REG(8), A_REG(8)}},
-	{"andq", 0x83, .rex = 1, .rexw = 1, .modrm_extension = 4, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM8, 0}}, .operand_accepts = {A_REG(8), A_IMM8_S}},
-
-	{"orl", 0x09, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_REG(4), A_REG(4)}},
-	{"orq", 0x09, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_REG(8), A_REG(8)}},
-
-	{"xor", 0x31, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_REG(8), A_REG(8)}},
-	{"xorq", 0x31, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_REG(8), A_REG(8)}},
-	{"xorl", 0x31, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_REG(4), A_REG(4)}},
-
-	{"divl", 0xf7, .modrm_extension = 6, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(4)}},
-	{"divq", 0xf7, .rexw = 1, .modrm_extension = 6, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(8)}},
-
-	{"idivl", 0xf7, .modrm_extension = 7, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(4)}},
-	{"idivq", 0xf7, .rexw = 1, .modrm_extension = 7, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(8)}},
-
-	{"imulq", 0x69, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 1}, {OE_MODRM_REG, 0}, {OE_IMM32, 0}}, .operand_accepts = {A_REG(8), A_IMM32_S}},
-	{"imulq", 0x6b, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 1}, {OE_MODRM_REG, 0}, {OE_IMM8, 0}}, .operand_accepts = {A_REG(8), A_IMM8_S}},
-	{"imulq", 0x0f, .op2 = 0xaf, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(8), A_MODRM(8)}},
-
-	{"imull", 0x0f, .op2 = 0xaf, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(4), A_MODRM(4)}},
-
-	{"callq", 0xff, .modrm_extension = 2, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_REG_STAR(8)}},
-	{ "cltd", .opcode = 0x99 },
-	{ "cqto", .rexw = 1, .opcode = 0x99 },
-	{ "leave", .opcode = 0xc9 },
-	{ "ret", .opcode = 0xc3 },
-	{ "ud2", .opcode = 0x0f, .op2 = 0x0b },
+	{MN_ADDQ, 0x05, .rex = 1, .rexw = 1, .operand_encoding = {{OE_NONE, 0}, {OE_IMM32, 0}}, .operand_accepts = {A_RAX(8), A_IMM32_S}},
+	{MN_ADDQ, 0x04, .operand_encoding = {{OE_NONE, 0}, {OE_IMM8, 0}}, .operand_accepts = {A_REG(4), A_IMM8_S}},
+	{MN_ADDQ, 0x83, .rex = 1, .rexw = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM8, 0}}, .operand_accepts = {A_REG(8), A_IMM8_S}},
+	{MN_ADDQ, 0x81, .rexw = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM32, 0}}, .operand_accepts = {A_REG(8), A_IMM32_S}},
+	{MN_ADDL, 0x01, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_REG(4), A_REG(4)}},
+	{MN_ADDQ, 0x01, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_REG(8), A_REG(8)}},
+	{MN_ADDQ, 0x03, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(8), A_MODRM(8)}},
+	{MN_ADDL, 0x03, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(4), A_MODRM(4)}},
+
+	{MN_SUBQ, 0x83, .rex = 1, .rexw = 1, .modrm_extension = 5, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM8, 0}}, .operand_accepts = {A_MODRM(8), A_IMM8_S}},
+	{MN_SUBQ, 0x81, .rex = 1, .rexw = 1, .modrm_extension = 5, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM32, 0}}, .operand_accepts = {A_MODRM(8), A_IMM32_S}},
+	{MN_SUBQ, 0x29, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(8), A_REG(8)}},
+	{MN_SUBL, 0x83, .modrm_extension = 5, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM8, 0}}, .operand_accepts = {A_REG(4), A_IMM8_S}},
+	{MN_SUBL, 0x81, .modrm_extension = 5, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM32, 0}}, .operand_accepts = {A_REG(4), A_IMM32_S}},
+	{MN_SUBL, 0x29, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(4), A_REG(4)}},
+	{MN_SUBQ, 0x2b, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(8), A_MODRM(8)}},
+	{MN_SUBL, 0x2b, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(4), A_MODRM(4)}},
+
+	{MN_ANDL, 0x21, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_REG(4), A_REG(4)}},
+	{MN_ANDQ, 0x21, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_REG(8), A_REG(8)}},
+	{MN_ANDQ, 0x83, .rex = 1, .rexw = 1, .modrm_extension = 4, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM8, 0}}, .operand_accepts = {A_REG(8), A_IMM8_S}},
+	{MN_ANDL, 0x23, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(4), A_MODRM(4)}},
+	{MN_ANDQ, 0x23, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(8), A_MODRM(8)}},
+
+	{MN_ORL, 0x09, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_REG(4), A_REG(4)}},
+	{MN_ORQ, 0x09, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_REG(8), A_REG(8)}},
+	{MN_ORL, 0x0b, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(4), A_MODRM(4)}},
+	{MN_ORQ, 0x0b, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(8), A_MODRM(8)}},
+
+	{MN_XOR, 0x31, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_REG(8), A_REG(8)}},
+	{MN_XORQ, 0x31, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_REG(8), A_REG(8)}},
+	{MN_XORL, 0x31, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_REG(4), A_REG(4)}},
+	{MN_XORL, 0x33, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(4), A_MODRM(4)}},
+	{MN_XORQ, 0x33, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(8), A_MODRM(8)}},
+
+	{MN_DIVL, 0xf7, .modrm_extension = 6, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(4)}},
+	{MN_DIVQ, 0xf7, .rexw = 1, .modrm_extension = 6, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(8)}},
+
+	{MN_IDIVL, 0xf7, .modrm_extension = 7, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(4)}},
+	{MN_IDIVQ, 0xf7, .rexw = 1, .modrm_extension = 7, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(8)}},
+
+	{MN_IMULQ, 0x69, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 1}, {OE_MODRM_REG, 0}, {OE_IMM32, 0}}, .operand_accepts = {A_REG(8), A_IMM32_S}},
+	{MN_IMULQ, 0x6b, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 1}, {OE_MODRM_REG, 0}, {OE_IMM8, 0}}, .operand_accepts = {A_REG(8), A_IMM8_S}},
+	{MN_IMULQ, 0x0f, .op2 = 0xaf, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(8), A_MODRM(8)}},
+
+	{MN_IMULL, 0x0f, .op2 = 0xaf, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(4), A_MODRM(4)}},
+
+	{MN_CALLQ, 0xff, .modrm_extension = 2, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_REG_STAR(8)}},
+	{MN_JMPQ, 0xff, .modrm_extension = 4, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_REG_STAR(8)}},
+	{ MN_CLTD, .opcode = 0x99 },
+	{ MN_CQTO, .rexw = 1, .opcode = 0x99 },
+	{ MN_LEAVE, .opcode = 0xc9 },
+	{ MN_RET, .opcode = 0xc3 },
+	{ MN_UD2, .opcode = 0x0f, .op2 = 0x0b },
+	{ MN_REP_MOVSQ, .rexw = 1, .repe_prefix = 1, .opcode = 0xa5 },
+	{ MN_REP_STOSQ, .rexw = 1, .repe_prefix = 1, .opcode = 0xab },
 	
-	{"jmp", 0xe9, .operand_encoding = {{OE_REL32, 0}}, .operand_accepts = {A_REL32}},
-	{"jnae", 0x0f, .op2 = 0x82, .operand_encoding = {{OE_REL32, 0}}, .operand_accepts = {A_REL32}},
-	{"jnb", 0x0f, .op2 = 0x83, .operand_encoding = {{OE_REL32, 0}}, .operand_accepts = {A_REL32}},
-	{"je", 0x0f, .op2 = 0x84, .operand_encoding = {{OE_REL32, 0}}, .operand_accepts = {A_REL32}},
-	{"jne", 0x0f, .op2 = 0x85, .operand_encoding = {{OE_REL32, 0}}, .operand_accepts = {A_REL32}},
-	{"jna", 0x0f, .op2 = 0x86, .operand_encoding = {{OE_REL32, 0}}, .operand_accepts = {A_REL32}},
-	{"ja", 0x0f, .op2 = 0x87, .operand_encoding = {{OE_REL32, 0}}, .operand_accepts = {A_REL32}},
-
-	{"cmpl", 0x39, .slash_r = 1, .operand_encoding = MR, .operand_accepts = {A_REG(4), A_REG(4)}},
-	{"cmpq", 0x39, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = MR, .operand_accepts = {A_MODRM(8), A_REG(8)}},
-
-	{"cmpl", 0x83, .modrm_extension = 7, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM8, 0}}, .operand_accepts = {A_REG(4), A_IMM8}},
-	{"cmpq", 0x83, .rex = 1, .rexw = 1, .modrm_extension = 7, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM8, 0}}, .operand_accepts = {A_REG(8), A_IMM8}},
-
-	{"cmpl", 0x81, .modrm_extension = 7, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM32, 0}}, .operand_accepts = {A_REG(4), A_IMM32}},
-	{"cmpq", 0x81, .rex = 1, .rexw = 1, .modrm_extension = 7, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM32, 0}}, .operand_accepts = {A_REG(8), A_IMM32_S}},
-
-	{"movl", 0xb8, .modrm_extension = 0, .operand_encoding = {{OE_OPEXT, 0}, {OE_IMM32, 0}}, .operand_accepts = {A_REG(4), A_IMM32}},
-	{"movl", 0xc7, .modrm_extension = 0, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM32, 0}}, .operand_accepts = {A_MODRM(4), A_IMM32}},
-	{"movl", 0xc7, .modrm_extension = 0, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM32, 0}}, .operand_accepts = {A_MODRM(4), A_IMM32_S}},
-	{"movl", 0x89, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(4), A_REG(4)}},
-	{"movl", 0x89, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(4), A_REG(4)}},
-	{"movw", 0xc7, .op_size_prefix = 1, .modrm_extension = 0, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM16, 0}}, .operand_accepts = {A_MODRM(2), A_IMM16}},
-	{"movw", 0xc7, .op_size_prefix = 1, .modrm_extension = 0, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM16, 0}}, .operand_accepts = {A_MODRM(2), A_IMM16_S}},
-	{"movw", 0x89, .op_size_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(2), A_REG(2)}},
-	{"movw", 0x8b, .op_size_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(2), A_MODRM(2)}},
-	{"movq", 0x89, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(8), A_REG(8)}},
-	{"movq", 0x8b, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(8), A_MODRM(8)}},
-	{"movb", 0x8a, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(1), A_MODRM(1)}},
-	{"movb", 0x88, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(1), A_REG(1)}},
-	{"movb", 0xc6, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM8, 0}}, .operand_accepts = {A_MODRM(1), A_IMM8_S}},
-	{"movb", 0xc6, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM8, 0}}, .operand_accepts = {A_MODRM(1), A_IMM8}},
-	{"movl", 0x8b, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(4), A_MODRM(4)}},
-	{"movq", 0xc7, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM32, 0}}, .operand_accepts = {A_MODRM(8), A_IMM32_S}},
-
-	{"movabsq", 0xb8, .rex = 1, .rexw = 1, .operand_encoding = {{OE_OPEXT, 0}, {OE_IMM64, 0}}, .operand_accepts = {A_REG(8), A_IMM64}},
-
-	{"leaq", 0x8d, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(8), A_MODRM(8)}},
-	{"leal", 0x8d, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(4), A_MODRM(4)}},
-
-	{"movswl", 0x0f, .op2 = 0xbf, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(4), A_MODRM(2)}},
-	{"movswq", 0x0f, .rexw = 1, .op2 = 0xbf, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(8), A_MODRM(2)}},
-	{"movslq", 0x63, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(8), A_MODRM(4)}},
-	{"movsbl", 0x0f, .op2 = 0xbe, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(4), A_MODRM(1)}},
-	{"movsbw", 0x0f, .op_size_prefix = 1, .op2 = 0xbe, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(2), A_MODRM(1)}},
-	{"movsbq", 0x0f, .rexw = 1, .op2 = 0xbe, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(8), A_MODRM(1)}},
-
-	{"movzwl", 0x0f, .op2 = 0xb7, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(4), A_MODRM(2)}},
-	{"movzbl", 0x0f, .op2 = 0xb6, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(4), A_MODRM(1)}},
-
-	{"pushq", 0x50, .operand_encoding = {{OE_OPEXT, 0}}, .operand_accepts = {A_REG(8)}},
-
-	{"notl", 0xf7, .modrm_extension = 2, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(4)}},
-	{"notq", 0xf7, .rex = 1, .rexw = 1, .modrm_extension = 2, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(8)}},
-
-	{"negl", 0xf7, .modrm_extension = 3, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(4)}},
-	{"negq", 0xf7, .rexw = 1, .modrm_extension = 3, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(8)}},
-
-	{"seta", 0x0f, .op2 = 0x97, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(1)}},
-	{"setb", 0x0f, .op2 = 0x92, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(1)}},
-	{"setbe", 0x0f, .op2 = 0x96, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(1)}},
-	{"sete", 0x0f, .op2 = 0x94, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(1)}},
-	{"setg", 0x0f, .op2 = 0x9f, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(1)}},
-	{"setge", 0x0f, .op2 = 0x9d, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(1)}},
-	{"setgl", 0x0f, .op2 = 0x9c, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(1)}},
-	{"setl", 0x0f, .op2 = 0x9c, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(1)}},
-	{"setle", 0x0f, .op2 = 0x9e, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(1)}},
-	{"setnb", 0x0f, .op2 = 0x93, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(1)}},
-	{"setne", 0x0f, .op2 = 0x95, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(1)}},
+	{MN_JMP, 0xe9, .operand_encoding = {{OE_REL32, 0}}, .operand_accepts = {A_REL32}},
+	{MN_JNAE, 0x0f, .op2 = 0x82, .operand_encoding = {{OE_REL32, 0}}, .operand_accepts = {A_REL32}},
+	{MN_JNB, 0x0f, .op2 = 0x83, .operand_encoding = {{OE_REL32, 0}}, .operand_accepts = {A_REL32}},
+	{MN_JE, 0x0f, .op2 = 0x84, .operand_encoding = {{OE_REL32, 0}}, .operand_accepts = {A_REL32}},
+	{MN_JNE, 0x0f, .op2 = 0x85, .operand_encoding = {{OE_REL32, 0}}, .operand_accepts = {A_REL32}},
+	{MN_JNA, 0x0f, .op2 = 0x86, .operand_encoding = {{OE_REL32, 0}}, .operand_accepts = {A_REL32}},
+	{MN_JA, 0x0f, .op2 = 0x87, .operand_encoding = {{OE_REL32, 0}}, .operand_accepts = {A_REL32}},
+	{MN_JL, 0x0f, .op2 = 0x8c, .operand_encoding = {{OE_REL32, 0}}, .operand_accepts = {A_REL32}},
+	{MN_JGE, 0x0f, .op2 = 0x8d, .operand_encoding = {{OE_REL32, 0}}, .operand_accepts = {A_REL32}},
+	{MN_JLE, 0x0f, .op2 = 0x8e, .operand_encoding = {{OE_REL32, 0}}, .operand_accepts = {A_REL32}},
+	{MN_JG, 0x0f, .op2 = 0x8f, .operand_encoding = {{OE_REL32, 0}}, .operand_accepts = {A_REL32}},
+
+	{MN_CMPL, 0x39, .slash_r = 1, .operand_encoding = MR, .operand_accepts = {A_REG(4), A_REG(4)}},
+	{MN_CMPQ, 0x39, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = MR, .operand_accepts = {A_MODRM(8), A_REG(8)}},
+	{MN_CMPL, 0x3b, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(4), A_MODRM(4)}},
+	{MN_CMPQ, 0x3b, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(8), A_MODRM(8)}},
+
+	{MN_CMPL, 0x83, .modrm_extension = 7, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM8, 0}}, .operand_accepts = {A_REG(4), A_IMM8_S}},
+	{MN_CMPQ, 0x83, .rex = 1, .rexw = 1, .modrm_extension = 7, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM8, 0}}, .operand_accepts = {A_REG(8), A_IMM8_S}},
+
+	{MN_CMPL, 0x81, .modrm_extension = 7, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM32, 0}}, .operand_accepts = {A_REG(4), A_IMM32}},
+	{MN_CMPL, 0x81, .modrm_extension = 7, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM32, 0}}, .operand_accepts = {A_REG(4), A_IMM32_S}},
+	{MN_CMPQ, 0x81, .rex = 1, .rexw = 1, .modrm_extension = 7, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM32, 0}}, .operand_accepts = {A_REG(8), A_IMM32_S}},
+
+	{MN_MOVL, 0xb8, .modrm_extension = 0, .operand_encoding = {{OE_OPEXT, 0}, {OE_IMM32, 0}}, .operand_accepts = {A_REG(4), A_IMM32}},
+	{MN_MOVL, 0xc7, .modrm_extension = 0, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM32, 0}}, .operand_accepts = {A_MODRM(4), A_IMM32}},
+	{MN_MOVL, 0xc7, .modrm_extension = 0, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM32, 0}}, .operand_accepts = {A_MODRM(4), A_IMM32_S}},
+	{MN_MOVL, 0x89, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(4), A_REG(4)}},
+	{MN_MOVL, 0x89, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(4), A_REG(4)}},
+	{MN_MOVW, 0xc7, .op_size_prefix = 1, .modrm_extension = 0, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM16, 0}}, .operand_accepts = {A_MODRM(2), A_IMM16}},
+	{MN_MOVW, 0xc7, .op_size_prefix = 1, .modrm_extension = 0, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM16, 0}}, .operand_accepts = {A_MODRM(2), A_IMM16_S}},
+	{MN_MOVW, 0x89, .op_size_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(2), A_REG(2)}},
+	{MN_MOVW, 0x8b, .op_size_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(2), A_MODRM(2)}},
+	{MN_MOVQ, 0x89, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(8), A_REG(8)}},
+	{MN_MOVQ, 0x8b, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(8), A_MODRM(8)}},
+	{MN_MOVB, 0x8a, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(1), A_MODRM(1)}},
+	{MN_MOVB, 0x88, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(1), A_REG(1)}},
+	{MN_MOVB, 0xc6, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM8, 0}}, .operand_accepts = {A_MODRM(1), A_IMM8_S}},
+	{MN_MOVB, 0xc6, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM8, 0}}, .operand_accepts = {A_MODRM(1), A_IMM8}},
+	{MN_MOVL, 0x8b, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(4), A_MODRM(4)}},
+	{MN_MOVQ, 0xc7, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM32, 0}}, .operand_accepts = {A_MODRM(8), A_IMM32_S}},
+
+	{MN_MOVABSQ, 0xb8, .rex = 1, .rexw = 1, .operand_encoding = {{OE_OPEXT, 0}, {OE_IMM64, 0}}, .operand_accepts = {A_REG(8), A_IMM64}},
+
+	{MN_LEAQ, 0x8d, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(8), A_MODRM(8)}},
+	{MN_LEAL, 0x8d, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(4), A_MODRM(4)}},
+
+	{MN_MOVSWL, 0x0f, .op2 = 0xbf, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(4), A_MODRM(2)}},
+	{MN_MOVSWQ, 0x0f, .rexw = 1, .op2 = 0xbf, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(8), A_MODRM(2)}},
+	{MN_MOVSLQ, 0x63, .rex = 1, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(8), A_MODRM(4)}},
+	{MN_MOVSBL, 0x0f, .op2 = 0xbe, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(4), A_MODRM(1)}},
+	{MN_MOVSBW, 0x0f, .op_size_prefix = 1, .op2 = 0xbe, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(2), A_MODRM(1)}},
+	{MN_MOVSBQ, 0x0f, .rexw = 1, .op2 = 0xbe, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(8), A_MODRM(1)}},
+
+	{MN_MOVZWL, 0x0f, .op2 = 0xb7, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(4), A_MODRM(2)}},
+	{MN_MOVZBL, 0x0f, .op2 = 0xb6, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(4), A_MODRM(1)}},
+
+	{MN_PUSHQ, 0x50, .operand_encoding = {{OE_OPEXT, 0}}, .operand_accepts = {A_REG(8)}},
+
+	{MN_NOTL, 0xf7, .modrm_extension = 2, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(4)}},
+	{MN_NOTQ, 0xf7, .rex = 1, .rexw = 1, .modrm_extension = 2, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(8)}},
+
+	{MN_NEGL, 0xf7, .modrm_extension = 3, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(4)}},
+	{MN_NEGQ, 0xf7, .rexw = 1, .modrm_extension = 3, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(8)}},
+
+	{MN_SETA, 0x0f, .op2 = 0x97, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(1)}},
+	{MN_SETB, 0x0f, .op2 = 0x92, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(1)}},
+	{MN_SETBE, 0x0f, .op2 = 0x96, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(1)}},
+	{MN_SETE, 0x0f, .op2 = 0x94, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(1)}},
+	{MN_SETG, 0x0f, .op2 = 0x9f, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(1)}},
+	{MN_SETGE, 0x0f, .op2 = 0x9d, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(1)}},
+	{MN_SETGL, 0x0f, .op2 = 0x9c, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(1)}},
+	{MN_SETL, 0x0f, .op2 = 0x9c, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(1)}},
+	{MN_SETLE, 0x0f, .op2 = 0x9e, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(1)}},
+	{MN_SETNB, 0x0f, .op2 = 0x93, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(1)}},
+	{MN_SETNE, 0x0f, .op2 = 0x95, .operand_encoding = {{OE_MODRM_RM, 0}}, .operand_accepts = {A_MODRM(1)}},
 	
-	{"salq", 0xd3, .rex = 1, .rexw = 1, .modrm_extension = 4, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_NONE, 0}}, .operand_accepts = {A_MODRM(8), A_RCX(1)}},
-	{"sall", 0xd3, .modrm_extension = 4, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_NONE, 0}}, .operand_accepts = {A_MODRM(4), A_RCX(1)}},
+	{MN_SALQ, 0xc1, .rex = 1, .rexw = 1, .modrm_extension = 4, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM8, 0}}, .operand_accepts = {A_MODRM(8), A_IMM8}},
+	{MN_SALQ, 0xd3, .rex = 1, .rexw = 1, .modrm_extension = 4, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_NONE, 0}}, .operand_accepts = {A_MODRM(8), A_RCX(1)}},
+	{MN_SALL, 0xd3, .modrm_extension = 4, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_NONE, 0}}, .operand_accepts = {A_MODRM(4), A_RCX(1)}},
+
+	{MN_SARL, 0xd3, .modrm_extension = 7, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_NONE, 0}}, .operand_accepts = {A_MODRM(4), A_RCX(1)}},
+	{MN_SARQ, 0xd3, .rexw = 1, .modrm_extension = 7, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_NONE, 0}}, .operand_accepts = {A_MODRM(8), A_RCX(1)}},
 
-	{"sarl", 0xd3, .modrm_extension = 7, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_NONE, 0}}, .operand_accepts = {A_MODRM(4), A_RCX(1)}},
-	{"sarq", 0xd3, .rexw = 1, .modrm_extension = 7, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_NONE, 0}}, .operand_accepts = {A_MODRM(8), A_RCX(1)}},
+	{MN_SHRL, 0xd3, .modrm_extension = 5, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_NONE, 0}}, .operand_accepts = {A_MODRM(4), A_RCX(1)}},
+	{MN_SHRQ, 0xd3, .rexw = 1, .modrm_extension = 5, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_NONE, 0}}, .operand_accepts = {A_MODRM(8), A_RCX(1)}},
+	{MN_SHRQ, 0xc1, .rexw = 1, .modrm_extension = 5, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM8, 0}}, .operand_accepts = {A_REG(8), A_IMM8}},
 
-	{"shrl", 0xd3, .modrm_extension = 5, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_NONE, 0}}, .operand_accepts = {A_MODRM(4), A_RCX(1)}},
-	{"shrq", 0xd3, .rexw = 1, .modrm_extension = 5, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_NONE, 0}}, .operand_accepts = {A_MODRM(8), A_RCX(1)}},
-	{"shrq", 0xc1, .rexw = 1, .modrm_extension = 5, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_IMM8, 0}}, .operand_accepts = {A_REG(8), A_IMM8}},
+	{MN_TESTB, 0x84, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(1), A_REG(1)}},
+	{MN_TESTW, 0x85, .op_size_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(2), A_REG(2)}},
+	{MN_TESTL, 0x85, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(4), A_REG(4)}},
+	{MN_TESTQ, 0x85, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(8), A_REG(8)}},
 
-	{"testb", 0x84, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(1), A_REG(1)}},
-	{"testl", 0x85, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(4), A_REG(4)}},
-	{"testq", 0x85, .rexw = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(8), A_REG(8)}},
+	{MN_MOVSD, 0x0f, .op2 = 0x11, .repne_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_XMM_M64, A_XMM}},
+	{MN_MOVSD, 0x0f, .op2 = 0x10, .repne_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M64}},
 
-	{"movsd", 0x0f, .op2 = 0x11, .repne_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_XMM_M64, A_XMM}},
-	{"movsd", 0x0f, .op2 = 0x10, .repne_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M64}},
+	{MN_MOVSS, 0x0f, .op2 = 0x11, .repe_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_XMM_M32, A_XMM}},
+	{MN_MOVSS, 0x0f, .op2 = 0x10, .repe_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M32}},
 
-	{"movss", 0x0f, .op2 = 0x11, .repe_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_XMM_M32, A_XMM}},
+	{MN_MOVAPS, 0x0f, .op2 = 0x28, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM}},
 
-	{"movd", 0x0f, .op2 = 0x7e, .op_size_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(4), A_XMM}},
-	{"movd", 0x0f, .op2 = 0x6e, .op_size_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_MODRM(4)}},
+	{MN_MOVD, 0x0f, .op2 = 0x7e, .op_size_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(4), A_XMM}},
+	{MN_MOVD, 0x0f, .op2 = 0x6e, .op_size_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_MODRM(4)}},
 
-	{"movd", 0x0f, .op2 = 0x7e, .op_size_prefix = 1, .slash_r = 1, .rexw = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(8), A_XMM}},
-	{"movd", 0x0f, .op2 = 0x6e, .op_size_prefix = 1, .slash_r = 1, .rexw = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_MODRM(8)}},
+	{MN_MOVD, 0x0f, .op2 = 0x7e, .op_size_prefix = 1, .slash_r = 1, .rexw = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(8), A_XMM}},
+	{MN_MOVD, 0x0f, .op2 = 0x6e, .op_size_prefix = 1, .slash_r = 1, .rexw = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_MODRM(8)}},
 
 	// TODO: Is `movd %rax, %xmm0` the same as `movq %rax, %xmm0`?
-	{"movq", 0x0f, .op2 = 0x7e, .op_size_prefix = 1, .slash_r = 1, .rexw = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(8), A_XMM}},
-	{"movq", 0x0f, .op2 = 0x6e, .op_size_prefix = 1, .slash_r = 1, .rexw = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_MODRM(8)}},
+	{MN_MOVQ, 0x0f, .op2 = 0x7e, .op_size_prefix = 1, .slash_r = 1, .rexw = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_MODRM(8), A_XMM}},
+	{MN_MOVQ, 0x0f, .op2 = 0x6e, .op_size_prefix = 1, .slash_r = 1, .rexw = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_MODRM(8)}},
+
+	{MN_CVTSI2SS, 0x0f, .op2 = 0x2a, .repe_prefix = 1, .slash_r = 1, .rexw = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_MODRM(8)}},
+	{MN_CVTSI2SD, 0x0f, .op2 = 0x2a, .repne_prefix = 1, .slash_r = 1, .rexw = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_MODRM(8)}},
 
-	{"cvtsi2ss", 0x0f, .op2 = 0x2a, .repe_prefix = 1, .slash_r = 1, .rexw = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_MODRM(8)}},
-	{"cvtsi2sd", 0x0f, .op2 = 0x2a, .repne_prefix = 1, .slash_r = 1, .rexw = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_MODRM(8)}},
+	{MN_CVTSD2SS, 0x0f, .op2 = 0x5a, .repne_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M64}},
+	{MN_CVTSS2SD, 0x0f, .op2 = 0x5a, .repe_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M32}},
 
-	{"cvtsd2ss", 0x0f, .op2 = 0x5a, .repne_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M64}},
-	{"cvtss2sd", 0x0f, .op2 = 0x5a, .repe_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M32}},
+	{MN_CVTTSS2SI, 0x0f, .op2 = 0x2c, .repe_prefix = 1, .slash_r = 1, .rexw = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(8), A_XMM_M32}},
 
-	{"cvttss2si", 0x0f, .op2 = 0x2c, .repe_prefix = 1, .slash_r = 1, .rexw = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(8), A_XMM_M32}},
+	{MN_CVTTSD2SI, 0x0f, .op2 = 0x2c, .repne_prefix = 1, .slash_r = 1, .rexw = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(8), A_XMM_M64}},
 
-	{"cvttsd2si", 0x0f, .op2 = 0x2c, .repne_prefix = 1, .slash_r = 1, .rexw = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_REG(8), A_XMM_M64}},
+	{MN_XORPS, 0x0f, .op2 = 0x57, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M128}},
 
-	{"xorps", 0x0f, .op2 = 0x57, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M128}},
+	{MN_MOVDQU, 0x0f, .op2 = 0x6f, .repe_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M128}},
+	{MN_MOVDQU, 0x0f, .op2 = 0x7f, .repe_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_RM, 0}, {OE_MODRM_REG, 0}}, .operand_accepts = {A_XMM_M128, A_XMM}},
 
-	{"subss", 0x0f, .op2 = 0x5c, .repe_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M32}},
+	{MN_SUBSS, 0x0f, .op2 = 0x5c, .repe_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M32}},
 
-	{"subsd", 0x0f, .op2 = 0x5c, .repne_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M64}},
+	{MN_SUBSD, 0x0f, .op2 = 0x5c, .repne_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M64}},
 
-	{"addss", 0x0f, .op2 = 0x58, .repe_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M32}},
+	{MN_ADDSS, 0x0f, .op2 = 0x58, .repe_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M32}},
 
-	{"addsd", 0x0f, .op2 = 0x58, .repne_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M64}},
+	{MN_ADDSD, 0x0f, .op2 = 0x58, .repne_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M64}},
 
-	{"mulss", 0x0f, .op2 = 0x59, .repe_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M32}},
+	{MN_MULSS, 0x0f, .op2 = 0x59, .repe_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M32}},
 
-	{"mulsd", 0x0f, .op2 = 0x59, .repne_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M64}},
+	{MN_MULSD, 0x0f, .op2 = 0x59, .repne_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M64}},
 
-	{"divss", 0x0f, .op2 = 0x5e, .repe_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M32}},
+	{MN_DIVSS, 0x0f, .op2 = 0x5e, .repe_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M32}},
 
-	{"divsd", 0x0f, .op2 = 0x5e, .repne_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M64}},
+	{MN_DIVSD, 0x0f, .op2 = 0x5e, .repne_prefix = 1, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M64}},
 
-	{"ucomiss", 0x0f, .op2 = 0x2e, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M32}},
+	{MN_UCOMISS, 0x0f, .op2 = 0x2e, .slash_r = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M32}},
 
-	{"ucomisd", 0x0f, .op2 = 0x2e, .slash_r = 1, .op_size_prefix = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M64}},
+	{MN_UCOMISD, 0x0f, .op2 = 0x2e, .slash_r = 1, .op_size_prefix = 1, .operand_encoding = {{OE_MODRM_REG, 0}, {OE_MODRM_RM, 0}}, .operand_accepts = {A_XMM, A_XMM_M64}},
 };
 
 #endif
@@ -0,0 +1,107 @@
+// Using x-macro.
+// Mnemonics of the instructions in instructions.h, in the order they first appear.
+
+X(MN_NONE, NULL)
+
+X(MN_ADDQ, "addq")
+X(MN_ADDL, "addl")
+X(MN_SUBQ, "subq")
+X(MN_SUBL, "subl")
+X(MN_ANDL, "andl")
+X(MN_ANDQ, "andq")
+X(MN_ORL, "orl")
+X(MN_ORQ, "orq")
+X(MN_XOR, "xor")
+X(MN_XORQ, "xorq")
+X(MN_XORL, "xorl")
+X(MN_DIVL, "divl")
+X(MN_DIVQ, "divq")
+X(MN_IDIVL, "idivl")
+X(MN_IDIVQ, "idivq")
+X(MN_IMULQ, "imulq")
+X(MN_IMULL, "imull")
+X(MN_CALLQ, "callq")
+X(MN_JMPQ, "jmpq")
+X(MN_CLTD, "cltd")
+X(MN_CQTO, "cqto")
+X(MN_LEAVE, "leave")
+X(MN_RET, "ret")
+X(MN_UD2, "ud2")
+X(MN_REP_MOVSQ, "rep movsq")
+X(MN_REP_STOSQ, "rep stosq")
+X(MN_JMP, "jmp")
+X(MN_JNAE, "jnae")
+X(MN_JNB, "jnb")
+X(MN_JE, "je")
+X(MN_JNE, "jne")
+X(MN_JNA, "jna")
+X(MN_JA, "ja")
+X(MN_JL, "jl")
+X(MN_JGE, "jge")
+X(MN_JLE, "jle")
+X(MN_JG, "jg")
+X(MN_CMPL, "cmpl")
+X(MN_CMPQ, "cmpq")
+X(MN_MOVL, "movl")
+X(MN_MOVW, "movw")
+X(MN_MOVQ, "movq")
+X(MN_MOVB, "movb")
+X(MN_MOVABSQ, "movabsq")
+X(MN_LEAQ, "leaq")
+X(MN_LEAL, "leal")
+X(MN_MOVSWL, "movswl")
+X(MN_MOVSWQ, "movswq")
+X(MN_MOVSLQ, "movslq")
+X(MN_MOVSBL, "movsbl")
+X(MN_MOVSBW, "movsbw")
+X(MN_MOVSBQ, "movsbq")
+X(MN_MOVZWL, "movzwl")
+X(MN_MOVZBL, "movzbl")
+X(MN_PUSHQ, "pushq")
+X(MN_NOTL, "notl")
+X(MN_NOTQ, "notq")
+X(MN_NEGL, "negl")
+X(MN_NEGQ, "negq")
+X(MN_SETA, "seta")
+X(MN_SETB, "setb")
+X(MN_SETBE, "setbe")
+X(MN_SETE, "sete")
+X(MN_SETG, "setg")
+X(MN_SETGE, "setge")
+X(MN_SETGL, "setgl")
+X(MN_SETL, "setl")
+X(MN_SETLE, "setle")
+X(MN_SETNB, "setnb")
+X(MN_SETNE, "setne")
+X(MN_SALQ, "salq")
+X(MN_SALL, "sall")
+X(MN_SARL, "sarl")
+X(MN_SARQ, "sarq")
+X(MN_SHRL, "shrl")
+X(MN_SHRQ, "shrq")
+X(MN_TESTB, "testb")
+X(MN_TESTW, "testw")
+X(MN_TESTL, "testl")
+X(MN_TESTQ, "testq")
+X(MN_MOVSD, "movsd")
+X(MN_MOVSS, "movss")
+X(MN_MOVAPS, "movaps")
+X(MN_MOVD, "movd")
+X(MN_CVTSI2SS, "cvtsi2ss")
+X(MN_CVTSI2SD, "cvtsi2sd")
+X(MN_CVTSD2SS, "cvtsd2ss")
+X(MN_CVTSS2SD, "cvtss2sd")
+X(MN_CVTTSS2SI, "cvttss2si")
+X(MN_CVTTSD2SI, "cvttsd2si")
+X(MN_XORPS, "xorps")
+X(MN_MOVDQU, "movdqu")
+X(MN_SUBSS, "subss")
+X(MN_SUBSD, "subsd")
+X(MN_ADDSS, "addss")
+X(MN_ADDSD, "addsd")
+X(MN_MULSS, "mulss")
+X(MN_MULSD, "mulsd")
+X(MN_DIVSS, "divss")
+X(MN_DIVSD, "divsd")
+X(MN_UCOMISS, "ucomiss")
+X(MN_UCOMISD, "ucomisd")
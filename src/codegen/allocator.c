@@ -0,0 +1,366 @@
+#include "allocator.h"
+#include "codegen.h"
+
+#include <common.h>
+
+#include <limits.h>
+#include <string.h>
+
+// R10 and R11 are clobbered by calls, and are only given to intervals
+// that do not cross a call. RBX is used for the function pointer in calls,
+// and the rest are used as scratch registers by the code generator.
+static const int caller_saved[] = { REG_R10, REG_R11 };
+static const int callee_saved[] = { REG_R12, REG_R13, REG_R14, REG_R15 };
+
+// Floating point values can be kept in xmm8 to xmm15. All SSE registers
+// are clobbered by calls, xmm0 to xmm7 are used for arguments, and
+// xmm0 and xmm1 as scratch registers by the code generator.
+static const int sse_registers[] = { 8, 9, 10, 11, 12, 13, 14, 15 };
+
+struct interval {
+	var_id var;
+	int start, end;
+	int crosses_call;
+	int reg;
+
+	// is_float if used by a floating point instruction, and
+	// no_xmm if it has a use that codegen can not take from an SSE register.
+	int is_float, no_xmm;
+	int xmm;
+};
+
+// Index among the variables considered for allocation, -1 otherwise.
+static int *var_index = NULL;
+static int var_index_size = 0;
+
+static int *block_index = NULL;
+static size_t block_index_size = 0;
+
+static void mark_memory(var_id var) {
+	if (var < var_index_size)
+		var_index[var] = -1;
+}
+
+static void mark_variables(struct function *func) {
+	if (var_index_size < get_n_vars()) {
+		var_index = realloc(var_index, sizeof *var_index * get_n_vars());
+		for (int i = var_index_size; i < get_n_vars(); i++)
+			var_index[i] = -1;
+		var_index_size = get_n_vars();
+	}
+
+	for (int i = 0; i < func->var_size; i++) {
+		var_id var = func->vars[i];
+		int size = get_variable_size(var);
+		variable_info[var].storage = VAR_STOR_NONE;
+		var_index[var] = (size == 1 || size == 2 || size == 4 || size == 8) ? 0 : -1;
+	}
+
+	// Variables that are accessed through their stack location.
+	for (int i = 0; i < func->size; i++) {
+		struct block *block = get_block(func->blocks[i]);
+		for (int j = 0; j < block->size; j++) {
+			var_id *var = ir_instruction_memory_operand(block->instructions + j);
+			if (var)
+				mark_memory(*var);
+		}
+	}
+}
+
+static int get_index(var_id var) {
+	return var < var_index_size ? var_index[var] : -1;
+}
+
+// 2 if ins operates on operand as a floating point value, 1 if it
+// is only moved, and 0 if it can not be taken from an SSE register.
+static int sse_operand(struct instruction *ins, var_id *operand) {
+	int is_result = operand == &ins->result;
+	switch (ins->type) {
+	case IR_BINARY_OPERATOR:
+		switch (ins->binary_operator.type) {
+		case IBO_FLT_ADD: case IBO_FLT_SUB: case IBO_FLT_MUL: case IBO_FLT_DIV:
+			return 2;
+		case IBO_FLT_LESS: case IBO_FLT_GREATER: case IBO_FLT_LESS_EQ:
+		case IBO_FLT_GREATER_EQ: case IBO_FLT_EQUAL: case IBO_FLT_NOT_EQUAL:
+			// The result of comparisons is an integer.
+			return is_result ? 0 : 2;
+		default:
+			return 0;
+		}
+	case IR_NEGATE_FLOAT: case IR_FLOAT_CAST:
+		return 2;
+	case IR_INT_FLOAT_CAST:
+		return is_result != ins->int_float_cast.from_float ? 2 : 0;
+	case IR_CONSTANT:
+		return ins->constant.constant.type == CONSTANT_TYPE;
+	case IR_COPY:
+		return get_variable_size(ins->result) == get_variable_size(ins->copy.source);
+	case IR_LOAD:
+		return is_result;
+	case IR_STORE:
+		return operand == &ins->store.value;
+	case IR_SET_REG:
+	case IR_GET_REG:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+static void mark_sse_operand(struct interval *intervals, struct instruction *ins, var_id *operand) {
+	int idx = get_index(*operand);
+	if (idx == -1)
+		return;
+	int sse = ins ? sse_operand(ins, operand) : 0;
+	if (sse == 2)
+		intervals[idx].is_float = 1;
+	else if (sse == 0)
+		intervals[idx].no_xmm = 1;
+}
+
+#define BIT_SET(SET, IDX) ((SET)[(IDX) / 64] |= (uint64_t)1 << ((IDX) % 64))
+#define BIT_GET(SET, IDX) (((SET)[(IDX) / 64] >> ((IDX) % 64)) & 1)
+
+static int compare_intervals(const void *a, const void *b) {
+	const struct interval *ia = a, *ib = b;
+	return ia->start - ib->start;
+}
+
+static int is_callee_saved(int reg) {
+	for (unsigned i = 0; i < sizeof callee_saved / sizeof *callee_saved; i++)
+		if (callee_saved[i] == reg)
+			return 1;
+	return 0;
+}
+
+// Active interval of the same register class that ends last, if it ends after it.
+static int spill_victim(struct interval **active, int n_active, struct interval *it, int xmm) {
+	int victim = -1;
+	for (int j = 0; j < n_active; j++) {
+		if (active[j]->xmm != xmm)
+			continue;
+		if (!xmm && it->crosses_call && !is_callee_saved(active[j]->reg))
+			continue;
+		if (victim == -1 || active[j]->end > active[victim]->end)
+			victim = j;
+	}
+
+	if (victim == -1 || active[victim]->end <= it->end)
+		return -1;
+	return victim;
+}
+
+unsigned allocate_registers(struct function *func) {
+	mark_variables(func);
+
+	int n_vars = 0;
+	static size_t intervals_size, intervals_cap;
+	static struct interval *intervals = NULL;
+	intervals_size = 0;
+	for (int i = 0; i < func->var_size; i++) {
+		var_id var = func->vars[i];
+		if (var_index[var] == -1)
+			continue;
+		var_index[var] = n_vars++;
+		ADD_ELEMENT(intervals_size, intervals_cap, intervals) = (struct interval) {
+			.var = var, .start = INT_MAX, .end = -1, .reg = -1
+		};
+	}
+
+	for (int i = 0; i < func->size; i++) {
+		if ((size_t)func->blocks[i] >= block_index_size) {
+			size_t new_size = func->blocks[i] * 2 + 1;
+			block_index = realloc(block_index, sizeof *block_index * new_size);
+			block_index_size = new_size;
+		}
+		block_index[func->blocks[i]] = i;
+	}
+
+	int words = (n_vars + 63) / 64;
+	uint64_t *use = calloc(func->size * words + 1, sizeof *use),
+		*def = calloc(func->size * words + 1, sizeof *def),
+		*live_in = calloc(func->size * words + 1, sizeof *live_in),
+		*live_out = calloc(func->size * words + 1, sizeof *live_out);
+	int *block_start = malloc(sizeof *block_start * func->size),
+		*block_end = malloc(sizeof *block_end * func->size);
+
+	static size_t calls_size, calls_cap;
+	static int *calls = NULL;
+	calls_size = 0;
+
+	// Local use/def sets, and positions. Uses of an instruction are
+	// at an even position, and the definition at the following odd position.
+	int pos = 0;
+	for (int i = 0; i < func->size; i++) {
+		struct block *block = get_block(func->blocks[i]);
+		uint64_t *b_use = use + i * words, *b_def = def + i * words;
+		var_id *uses[IR_MAX_USES];
+
+		block_start[i] = pos * 2;
+		for (int j = 0; j <= block->size; j++, pos++) {
+			struct instruction *ins = j < block->size ? block->instructions + j : NULL;
+			int n_uses = ins ? ir_instruction_uses(ins, uses) :
+				ir_block_exit_uses(&block->exit, uses);
+			var_id *defp = ins ? ir_instruction_def(ins) : NULL;
+
+			if (ins && ins->type == IR_CALL)
+				ADD_ELEMENT(calls_size, calls_cap, calls) = pos * 2;
+
+			for (int k = 0; k < n_uses; k++) {
+				int idx = get_index(*uses[k]);
+				if (idx == -1)
+					continue;
+				mark_sse_operand(intervals, ins, uses[k]);
+				if (!BIT_GET(b_def, idx))
+					BIT_SET(b_use, idx);
+				intervals[idx].start = MIN(intervals[idx].start, pos * 2);
+				intervals[idx].end = MAX(intervals[idx].end, pos * 2);
+			}
+
+			int idx = defp ? get_index(*defp) : -1;
+			if (idx != -1) {
+				mark_sse_operand(intervals, ins, defp);
+				BIT_SET(b_def, idx);
+				intervals[idx].start = MIN(intervals[idx].start, pos * 2 + 1);
+				intervals[idx].end = MAX(intervals[idx].end, pos * 2 + 1);
+			}
+		}
+		block_end[i] = pos * 2 - 1;
+	}
+
+	// Liveness.
+	int changed = 1;
+	while (changed) {
+		changed = 0;
+		for (int i = func->size - 1; i >= 0; i--) {
+			uint64_t *out = live_out + i * words, *in = live_in + i * words;
+			block_id *successors;
+			int n_successors = ir_block_successors(func, i, &successors);
+
+			for (int j = 0; j < n_successors; j++) {
+				uint64_t *s_in = live_in + block_index[successors[j]] * words;
+				for (int k = 0; k < words; k++)
+					out[k] |= s_in[k];
+			}
+
+			for (int k = 0; k < words; k++) {
+				uint64_t new_in = use[i * words + k] | (out[k] & ~def[i * words + k]);
+				if (new_in != in[k]) {
+					in[k] = new_in;
+					changed = 1;
+				}
+			}
+		}
+	}
+
+	// Extend intervals to cover all blocks where the variable is live.
+	for (int i = 0; i < func->size; i++) {
+		uint64_t *out = live_out + i * words, *in = live_in + i * words;
+		for (int idx = 0; idx < n_vars; idx++) {
+			if (BIT_GET(in, idx))
+				intervals[idx].start = MIN(intervals[idx].start, block_start[i]);
+			if (BIT_GET(out, idx))
+				intervals[idx].end = MAX(intervals[idx].end, block_end[i]);
+		}
+	}
+
+	for (int i = 0; i < n_vars; i++) {
+		struct interval *it = intervals + i;
+		// Find first call after start.
+		int lo = 0, hi = calls_size;
+		while (lo < hi) {
+			int mid = (lo + hi) / 2;
+			if (calls[mid] <= it->start)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		it->crosses_call = lo < (int)calls_size && calls[lo] < it->end;
+	}
+
+	// intervals is NULL when the function has no candidates.
+	if (n_vars)
+		qsort(intervals, n_vars, sizeof *intervals, compare_intervals);
+
+	struct interval *active[32];
+	int n_active = 0;
+	unsigned used_regs = 0;
+	for (int i = 0; i < n_vars; i++) {
+		struct interval *it = intervals + i;
+		if (it->end == -1)
+			continue;
+
+		unsigned occupied = 0, occupied_xmm = 0;
+		for (int j = 0; j < n_active; j++) {
+			if (active[j]->end < it->start) {
+				active[j--] = active[--n_active];
+				continue;
+			}
+			if (active[j]->xmm)
+				occupied_xmm |= 1u << active[j]->reg;
+			else
+				occupied |= 1u << active[j]->reg;
+		}
+
+		if (it->is_float && !it->no_xmm && !it->crosses_call) {
+			for (unsigned j = 0; it->reg == -1 && j < sizeof sse_registers / sizeof *sse_registers; j++)
+				if (!(occupied_xmm & (1u << sse_registers[j])))
+					it->reg = sse_registers[j];
+
+			int victim = it->reg == -1 ? spill_victim(active, n_active, it, 1) : -1;
+			if (victim != -1) {
+				it->reg = active[victim]->reg;
+				active[victim]->reg = -1;
+				active[victim] = active[--n_active];
+			}
+
+			it->xmm = it->reg != -1;
+		}
+
+		if (it->reg == -1 && !it->crosses_call) {
+			for (unsigned j = 0; it->reg == -1 && j < sizeof caller_saved / sizeof *caller_saved; j++)
+				if (!(occupied & (1u << caller_saved[j])))
+					it->reg = caller_saved[j];
+		}
+
+		for (unsigned j = 0; it->reg == -1 && j < sizeof callee_saved / sizeof *callee_saved; j++)
+			if (!(occupied & (1u << callee_saved[j])))
+				it->reg = callee_saved[j];
+
+		if (it->reg == -1) {
+			// Spill the interval that ends last.
+			int victim = spill_victim(active, n_active, it, 0);
+			if (victim == -1)
+				continue;
+
+			it->reg = active[victim]->reg;
+			active[victim]->reg = -1;
+			active[victim] = active[--n_active];
+		}
+
+		active[n_active++] = it;
+	}
+
+	for (int i = 0; i < n_vars; i++) {
+		struct interval *it = intervals + i;
+		var_index[it->var] = -1;
+		if (it->reg == -1)
+			continue;
+		variable_info[it->var].storage = it->xmm ? VAR_STOR_XMM : VAR_STOR_REG;
+		variable_info[it->var].reg = it->reg;
+		if (!it->xmm)
+			used_regs |= 1u << it->reg;
+	}
+
+	for (int i = 0; i < func->var_size; i++)
+		var_index[func->vars[i]] = -1;
+
+	free(use);
+	free(def);
+	free(live_in);
+	free(live_out);
+	free(block_start);
+	free(block_end);
+
+	return used_regs;
+}
@@ -0,0 +1,14 @@
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <ir/ir.h>
+
+// Linear scan register allocation over live intervals.
+// Variables that get a register are marked VAR_STOR_REG in
+// variable_info, or VAR_STOR_XMM for floating point values in SSE
+// registers. All other are left as VAR_STOR_NONE and are
+// given stack slots by codegen_function.
+// Returns a bitmask of the registers used.
+unsigned allocate_registers(struct function *func);
+
+#endif
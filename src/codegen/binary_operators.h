@@ -5,135 +5,140 @@
 #include <assembler/assembler.h>
 
 #define BINARY_INS(MNEMONIC) {						\
-		{"movq", {R8_(REG_RDI), R8_(REG_RAX)}},		\
+		{MN_MOVQ, {R8_(REG_RDI), R8_(REG_RAX)}},		\
 		{MNEMONIC, {R4_(REG_RSI), R4_(REG_RAX)}}	\
 	}
 
 #define BINARY_COMP(MNEMONIC) {					\
-		{"xorq", {R8_(REG_RAX), R8_(REG_RAX)}},	\
-		{"cmpl", {R4_(REG_RSI), R4_(REG_RDI)}},	\
+		{MN_XORQ, {R8_(REG_RAX), R8_(REG_RAX)}},	\
+		{MN_CMPL, {R4_(REG_RSI), R4_(REG_RDI)}},	\
 		{MNEMONIC, {R1_(REG_RAX)}}				\
 	}
 
-#define BINARY_INS_FLT(MNEMONIC) {				\
-		{"movd", {R4_(REG_RDI), XMM_(0)}},		\
-		{"movd", {R4_(REG_RSI), XMM_(1)}},		\
-		{MNEMONIC, {XMM_(1), XMM_(0)}},			\
-		{"movd", {XMM_(0), R4_(REG_RAX)}},		\
-	}
-
-#define BINARY_COMP_FLT(MNEMONIC) {				\
-		{"movd", {R4_(REG_RDI), XMM_(0)}},		\
-		{"movd", {R4_(REG_RSI), XMM_(1)}},		\
-		{"ucomiss", {XMM_(1), XMM_(0)}},		\
-		{MNEMONIC, {R1_(REG_RAX)}},				\
-	}
-
 #define BINARY_INS_64(MNEMONIC) {						\
-		{"movq", {R8_(REG_RDI), R8_(REG_RAX)}},		\
+		{MN_MOVQ, {R8_(REG_RDI), R8_(REG_RAX)}},		\
 		{MNEMONIC, {R8_(REG_RSI), R8_(REG_RAX)}}	\
 	}
 
 #define BINARY_COMP_64(MNEMONIC) {					\
-		{"xorq", {R8_(REG_RAX), R8_(REG_RAX)}},	\
-		{"cmpq", {R8_(REG_RSI), R8_(REG_RDI)}},	\
+		{MN_XORQ, {R8_(REG_RAX), R8_(REG_RAX)}},	\
+		{MN_CMPQ, {R8_(REG_RSI), R8_(REG_RDI)}},	\
 		{MNEMONIC, {R1_(REG_RAX)}}				\
 	}
 
-#define BINARY_INS_FLT_64(MNEMONIC) {				\
-		{"movq", {R8_(REG_RDI), XMM_(0)}},		\
-		{"movq", {R8_(REG_RSI), XMM_(1)}},		\
-		{MNEMONIC, {XMM_(1), XMM_(0)}},			\
-		{"movq", {XMM_(0), R8_(REG_RAX)}},		\
-	}
+struct asm_instruction binary_operator_output[2][IBO_COUNT][5] = {
+	[0][IBO_ADD] = BINARY_INS(MN_ADDL),
+	[0][IBO_SUB] = BINARY_INS(MN_SUBL),
+	[0][IBO_IMUL] = BINARY_INS(MN_IMULL),
+	[0][IBO_MUL] = BINARY_INS(MN_IMULL),
+	[0][IBO_BXOR] = BINARY_INS(MN_XORL),
+	[0][IBO_BOR] = BINARY_INS(MN_ORL),
+	[0][IBO_BAND] = BINARY_INS(MN_ANDL),
+	[0][IBO_IDIV] = {{MN_MOVQ, {R8_(REG_RDI), R8_(REG_RAX)}}, {MN_CLTD, { { 0 } }}, {MN_IDIVL, {R4_(REG_RSI)}}},
+	[0][IBO_IMOD] = {{MN_MOVQ, {R8_(REG_RDI), R8_(REG_RAX)}}, {MN_CLTD, { { 0 } }},
+					 {MN_IDIVL, {R4_(REG_RSI)}}, {MN_MOVL, {R4_(REG_RDX), R4_(REG_RAX)}}},
+	[0][IBO_LSHIFT] = {{MN_MOVQ, {R8_(REG_RSI), R8_(REG_RCX)}}, {MN_MOVQ, {R8_(REG_RDI), R8_(REG_RAX)}},
+					   {MN_SALL, {R1_(REG_RCX), R4_(REG_RAX)}}},
+	[0][IBO_IRSHIFT] = {{MN_MOVQ, {R8_(REG_RSI), R8_(REG_RCX)}}, {MN_MOVQ, {R8_(REG_RDI), R8_(REG_RAX)}},
+						{MN_SARL, {R1_(REG_RCX), R4_(REG_RAX)}}},
+	[0][IBO_RSHIFT] = {{MN_MOVQ, {R8_(REG_RSI), R8_(REG_RCX)}}, {MN_MOVQ, {R8_(REG_RDI), R8_(REG_RAX)}},
+						{MN_SHRL, {R1_(REG_RCX), R4_(REG_RAX)}}},
+	[0][IBO_IGREATER] = BINARY_COMP(MN_SETG),
+	[0][IBO_ILESS_EQ] = BINARY_COMP(MN_SETLE),
+	[0][IBO_ILESS] = BINARY_COMP(MN_SETL),
+	[0][IBO_IGREATER_EQ] = BINARY_COMP(MN_SETGE),
+	[0][IBO_EQUAL] = BINARY_COMP(MN_SETE),
+	[0][IBO_NOT_EQUAL] = BINARY_COMP(MN_SETNE),
+	[0][IBO_LESS] = BINARY_COMP(MN_SETB),
+	[0][IBO_GREATER] = BINARY_COMP(MN_SETA),
+	[0][IBO_LESS_EQ] = BINARY_COMP(MN_SETBE),
+	[0][IBO_GREATER_EQ] = BINARY_COMP(MN_SETNB),
+	[0][IBO_DIV] = {{MN_MOVQ, {R8_(REG_RDI), R8_(REG_RAX)}}, {MN_XORQ, {R8_(REG_RDX), R8_(REG_RDX)}}, {MN_DIVL, {R4_(REG_RSI)}}},
+	[0][IBO_MOD] = {{MN_MOVQ, {R8_(REG_RDI), R8_(REG_RAX)}}, {MN_XORQ, {R8_(REG_RDX), R8_(REG_RDX)}}, {MN_DIVL, {R4_(REG_RSI)}}, {MN_MOVL, {R4_(REG_RDX), R4_(REG_RAX)}}},
 
-#define BINARY_COMP_FLT_64(MNEMONIC) {				\
-		{"movq", {R8_(REG_RDI), XMM_(0)}},		\
-		{"movq", {R8_(REG_RSI), XMM_(1)}},		\
-		{"ucomisd", {XMM_(1), XMM_(0)}},		\
-		{MNEMONIC, {R1_(REG_RAX)}},				\
-	}
 
-struct asm_instruction binary_operator_output[2][IBO_COUNT][5] = {
-	[0][IBO_ADD] = BINARY_INS("addl"),
-	[0][IBO_SUB] = BINARY_INS("subl"),
-	[0][IBO_IMUL] = BINARY_INS("imull"),
-	[0][IBO_MUL] = BINARY_INS("imull"),
-	[0][IBO_BXOR] = BINARY_INS("xorl"),
-	[0][IBO_BOR] = BINARY_INS("orl"),
-	[0][IBO_BAND] = BINARY_INS("andl"),
-	[0][IBO_IDIV] = {{"movq", {R8_(REG_RDI), R8_(REG_RAX)}}, {"cltd", { { 0 } }}, {"idivl", {R4_(REG_RSI)}}},
-	[0][IBO_IMOD] = {{"movq", {R8_(REG_RDI), R8_(REG_RAX)}}, {"cltd", { { 0 } }},
-					 {"idivl", {R4_(REG_RSI)}}, {"movl", {R4_(REG_RDX), R4_(REG_RAX)}}},
-	[0][IBO_LSHIFT] = {{"movq", {R8_(REG_RSI), R8_(REG_RCX)}}, {"movq", {R8_(REG_RDI), R8_(REG_RAX)}},
-					   {"sall", {R1_(REG_RCX), R4_(REG_RAX)}}},
-	[0][IBO_IRSHIFT] = {{"movq", {R8_(REG_RSI), R8_(REG_RCX)}}, {"movq", {R8_(REG_RDI), R8_(REG_RAX)}},
-						{"sarl", {R1_(REG_RCX), R4_(REG_RAX)}}},
-	[0][IBO_RSHIFT] = {{"movq", {R8_(REG_RSI), R8_(REG_RCX)}}, {"movq", {R8_(REG_RDI), R8_(REG_RAX)}},
-						{"shrl", {R1_(REG_RCX), R4_(REG_RAX)}}},
-	[0][IBO_IGREATER] = BINARY_COMP("setg"),
-	[0][IBO_ILESS_EQ] = BINARY_COMP("setle"),
-	[0][IBO_ILESS] = BINARY_COMP("setl"),
-	[0][IBO_IGREATER_EQ] = BINARY_COMP("setge"),
-	[0][IBO_EQUAL] = BINARY_COMP("sete"),
-	[0][IBO_NOT_EQUAL] = BINARY_COMP("setne"),
-	[0][IBO_LESS] = BINARY_COMP("setb"),
-	[0][IBO_GREATER] = BINARY_COMP("seta"),
-	[0][IBO_LESS_EQ] = BINARY_COMP("setbe"),
-	[0][IBO_GREATER_EQ] = BINARY_COMP("setnb"),
-	[0][IBO_DIV] = {{"movq", {R8_(REG_RDI), R8_(REG_RAX)}}, {"xorq", {R8_(REG_RDX), R8_(REG_RDX)}}, {"divl", {R4_(REG_RSI)}}},
-	[0][IBO_MOD] = {{"movq", {R8_(REG_RDI), R8_(REG_RAX)}}, {"xorq", {R8_(REG_RDX), R8_(REG_RDX)}}, {"divl", {R4_(REG_RSI)}}, {"movl", {R4_(REG_RDX), R4_(REG_RAX)}}},
-
-	[0][IBO_FLT_ADD] = BINARY_INS_FLT("addss"),
-	[0][IBO_FLT_SUB] = BINARY_INS_FLT("subss"),
-	[0][IBO_FLT_MUL] = BINARY_INS_FLT("mulss"),
-	[0][IBO_FLT_DIV] = BINARY_INS_FLT("divss"),
-	[0][IBO_FLT_LESS] = BINARY_COMP_FLT("setb"),
-	[0][IBO_FLT_GREATER] = BINARY_COMP_FLT("seta"),
-	[0][IBO_FLT_LESS_EQ] = BINARY_COMP_FLT("setbe"),
-	[0][IBO_FLT_GREATER_EQ] = BINARY_COMP_FLT("setnb"),
-	[0][IBO_FLT_EQUAL] = BINARY_COMP_FLT("sete"),
-	[0][IBO_FLT_NOT_EQUAL] = BINARY_COMP_FLT("setne"),
-
-	[1][IBO_ADD] = BINARY_INS_64("addq"),
-	[1][IBO_SUB] = BINARY_INS_64("subq"),
-	[1][IBO_IMUL] = BINARY_INS_64("imulq"),
-	[1][IBO_MUL] = BINARY_INS_64("imulq"),
-	[1][IBO_BXOR] = BINARY_INS_64("xorq"),
-	[1][IBO_BOR] = BINARY_INS_64("orq"),
-	[1][IBO_BAND] = BINARY_INS_64("andq"),
-	[1][IBO_IDIV] = {{"movq", {R8_(REG_RDI), R8_(REG_RAX)}}, {"cqto", { { 0 } }}, {"idivq", {R8_(REG_RSI)}}},
-	[1][IBO_IMOD] = {{"movq", {R8_(REG_RDI), R8_(REG_RAX)}}, {"cqto", { { 0 } }},
-					 {"idivq", {R8_(REG_RSI)}}, {"movq", {R8_(REG_RDX), R8_(REG_RAX)}}},
-	[1][IBO_LSHIFT] = {{"movq", {R8_(REG_RSI), R8_(REG_RCX)}}, {"movq", {R8_(REG_RDI), R8_(REG_RAX)}},
-					   {"salq", {R1_(REG_RCX), R8_(REG_RAX)}}},
-	[1][IBO_IRSHIFT] = {{"movq", {R8_(REG_RSI), R8_(REG_RCX)}}, {"movq", {R8_(REG_RDI), R8_(REG_RAX)}},
-						{"sarq", {R1_(REG_RCX), R8_(REG_RAX)}}},
-	[1][IBO_RSHIFT] = {{"movq", {R8_(REG_RSI), R8_(REG_RCX)}}, {"movq", {R8_(REG_RDI), R8_(REG_RAX)}},
-						{"shrq", {R1_(REG_RCX), R8_(REG_RAX)}}},
-	[1][IBO_IGREATER] = BINARY_COMP_64("setg"),
-	[1][IBO_ILESS_EQ] = BINARY_COMP_64("setle"),
-	[1][IBO_ILESS] = BINARY_COMP_64("setl"),
-	[1][IBO_IGREATER_EQ] = BINARY_COMP_64("setge"),
-	[1][IBO_EQUAL] = BINARY_COMP_64("sete"),
-	[1][IBO_NOT_EQUAL] = BINARY_COMP_64("setne"),
-	[1][IBO_LESS] = BINARY_COMP_64("setb"),
-	[1][IBO_GREATER] = BINARY_COMP_64("seta"),
-	[1][IBO_LESS_EQ] = BINARY_COMP_64("setbe"),
-	[1][IBO_GREATER_EQ] = BINARY_COMP_64("setnb"),
-	[1][IBO_DIV] = {{"movq", {R8_(REG_RDI), R8_(REG_RAX)}}, {"xorq", {R8_(REG_RDX), R8_(REG_RDX)}}, {"divq", {R8_(REG_RSI)}}},
-	[1][IBO_MOD] = {{"movq", {R8_(REG_RDI), R8_(REG_RAX)}}, {"xorq", {R8_(REG_RDX), R8_(REG_RDX)}}, {"divq", {R8_(REG_RSI)}}, {"movq", {R8_(REG_RDX), R8_(REG_RAX)}}},
-
-	[1][IBO_FLT_ADD] = BINARY_INS_FLT_64("addsd"),
-	[1][IBO_FLT_SUB] = BINARY_INS_FLT_64("subsd"),
-	[1][IBO_FLT_MUL] = BINARY_INS_FLT_64("mulsd"),
-	[1][IBO_FLT_DIV] = BINARY_INS_FLT_64("divsd"),
-	[1][IBO_FLT_LESS] = BINARY_COMP_FLT_64("setb"),
-	[1][IBO_FLT_GREATER] = BINARY_COMP_FLT_64("seta"),
-	[1][IBO_FLT_LESS_EQ] = BINARY_COMP_FLT_64("setbe"),
-	[1][IBO_FLT_GREATER_EQ] = BINARY_COMP_FLT_64("setnb"),
-	[1][IBO_FLT_EQUAL] = BINARY_COMP_FLT_64("sete"),
-	[1][IBO_FLT_NOT_EQUAL] = BINARY_COMP_FLT_64("setne"),
+	[1][IBO_ADD] = BINARY_INS_64(MN_ADDQ),
+	[1][IBO_SUB] = BINARY_INS_64(MN_SUBQ),
+	[1][IBO_IMUL] = BINARY_INS_64(MN_IMULQ),
+	[1][IBO_MUL] = BINARY_INS_64(MN_IMULQ),
+	[1][IBO_BXOR] = BINARY_INS_64(MN_XORQ),
+	[1][IBO_BOR] = BINARY_INS_64(MN_ORQ),
+	[1][IBO_BAND] = BINARY_INS_64(MN_ANDQ),
+	[1][IBO_IDIV] = {{MN_MOVQ, {R8_(REG_RDI), R8_(REG_RAX)}}, {MN_CQTO, { { 0 } }}, {MN_IDIVQ, {R8_(REG_RSI)}}},
+	[1][IBO_IMOD] = {{MN_MOVQ, {R8_(REG_RDI), R8_(REG_RAX)}}, {MN_CQTO, { { 0 } }},
+					 {MN_IDIVQ, {R8_(REG_RSI)}}, {MN_MOVQ, {R8_(REG_RDX), R8_(REG_RAX)}}},
+	[1][IBO_LSHIFT] = {{MN_MOVQ, {R8_(REG_RSI), R8_(REG_RCX)}}, {MN_MOVQ, {R8_(REG_RDI), R8_(REG_RAX)}},
+					   {MN_SALQ, {R1_(REG_RCX), R8_(REG_RAX)}}},
+	[1][IBO_IRSHIFT] = {{MN_MOVQ, {R8_(REG_RSI), R8_(REG_RCX)}}, {MN_MOVQ, {R8_(REG_RDI), R8_(REG_RAX)}},
+						{MN_SARQ, {R1_(REG_RCX), R8_(REG_RAX)}}},
+	[1][IBO_RSHIFT] = {{MN_MOVQ, {R8_(REG_RSI), R8_(REG_RCX)}}, {MN_MOVQ, {R8_(REG_RDI), R8_(REG_RAX)}},
+						{MN_SHRQ, {R1_(REG_RCX), R8_(REG_RAX)}}},
+	[1][IBO_IGREATER] = BINARY_COMP_64(MN_SETG),
+	[1][IBO_ILESS_EQ] = BINARY_COMP_64(MN_SETLE),
+	[1][IBO_ILESS] = BINARY_COMP_64(MN_SETL),
+	[1][IBO_IGREATER_EQ] = BINARY_COMP_64(MN_SETGE),
+	[1][IBO_EQUAL] = BINARY_COMP_64(MN_SETE),
+	[1][IBO_NOT_EQUAL] = BINARY_COMP_64(MN_SETNE),
+	[1][IBO_LESS] = BINARY_COMP_64(MN_SETB),
+	[1][IBO_GREATER] = BINARY_COMP_64(MN_SETA),
+	[1][IBO_LESS_EQ] = BINARY_COMP_64(MN_SETBE),
+	[1][IBO_GREATER_EQ] = BINARY_COMP_64(MN_SETNB),
+	[1][IBO_DIV] = {{MN_MOVQ, {R8_(REG_RDI), R8_(REG_RAX)}}, {MN_XORQ, {R8_(REG_RDX), R8_(REG_RDX)}}, {MN_DIVQ, {R8_(REG_RSI)}}},
+	[1][IBO_MOD] = {{MN_MOVQ, {R8_(REG_RDI), R8_(REG_RAX)}}, {MN_XORQ, {R8_(REG_RDX), R8_(REG_RDX)}}, {MN_DIVQ, {R8_(REG_RSI)}}, {MN_MOVQ, {R8_(REG_RDX), R8_(REG_RAX)}}},
+
+};
+
+// Operators that can be computed with a single instruction
+// taking the right hand side from either a register or memory.
+enum mnemonic binary_operator_direct[2][IBO_COUNT] = {
+	[0][IBO_ADD] = MN_ADDL, [0][IBO_SUB] = MN_SUBL,
+	[0][IBO_MUL] = MN_IMULL, [0][IBO_IMUL] = MN_IMULL,
+	[0][IBO_BXOR] = MN_XORL, [0][IBO_BOR] = MN_ORL, [0][IBO_BAND] = MN_ANDL,
+
+	[1][IBO_ADD] = MN_ADDQ, [1][IBO_SUB] = MN_SUBQ,
+	[1][IBO_MUL] = MN_IMULQ, [1][IBO_IMUL] = MN_IMULQ,
+	[1][IBO_BXOR] = MN_XORQ, [1][IBO_BOR] = MN_ORQ, [1][IBO_BAND] = MN_ANDQ,
+};
+
+// Floating point operators, computed in SSE registers. Comparisons
+// are done with ucomiss and ucomisd, followed by the setcc below.
+enum mnemonic binary_operator_float[2][IBO_COUNT] = {
+	[0][IBO_FLT_ADD] = MN_ADDSS, [0][IBO_FLT_SUB] = MN_SUBSS,
+	[0][IBO_FLT_MUL] = MN_MULSS, [0][IBO_FLT_DIV] = MN_DIVSS,
+
+	[1][IBO_FLT_ADD] = MN_ADDSD, [1][IBO_FLT_SUB] = MN_SUBSD,
+	[1][IBO_FLT_MUL] = MN_MULSD, [1][IBO_FLT_DIV] = MN_DIVSD,
+};
+
+enum mnemonic binary_operator_float_setcc[IBO_COUNT] = {
+	[IBO_FLT_LESS] = MN_SETB, [IBO_FLT_GREATER] = MN_SETA,
+	[IBO_FLT_LESS_EQ] = MN_SETBE, [IBO_FLT_GREATER_EQ] = MN_SETNB,
+	[IBO_FLT_EQUAL] = MN_SETE, [IBO_FLT_NOT_EQUAL] = MN_SETNE,
+};
+
+enum mnemonic binary_operator_setcc[IBO_COUNT] = {
+	[IBO_IGREATER] = MN_SETG, [IBO_ILESS_EQ] = MN_SETLE,
+	[IBO_ILESS] = MN_SETL, [IBO_IGREATER_EQ] = MN_SETGE,
+	[IBO_EQUAL] = MN_SETE, [IBO_NOT_EQUAL] = MN_SETNE,
+	[IBO_LESS] = MN_SETB, [IBO_GREATER] = MN_SETA,
+	[IBO_LESS_EQ] = MN_SETBE, [IBO_GREATER_EQ] = MN_SETNB,
+};
+
+// Conditional jumps taken when the comparison holds, and when it does not.
+enum mnemonic binary_operator_jcc[IBO_COUNT] = {
+	[IBO_IGREATER] = MN_JG, [IBO_ILESS_EQ] = MN_JLE,
+	[IBO_ILESS] = MN_JL, [IBO_IGREATER_EQ] = MN_JGE,
+	[IBO_EQUAL] = MN_JE, [IBO_NOT_EQUAL] = MN_JNE,
+	[IBO_LESS] = MN_JNAE, [IBO_GREATER] = MN_JA,
+	[IBO_LESS_EQ] = MN_JNA, [IBO_GREATER_EQ] = MN_JNB,
+};
+
+enum mnemonic binary_operator_jcc_inverse[IBO_COUNT] = {
+	[IBO_IGREATER] = MN_JLE, [IBO_ILESS_EQ] = MN_JG,
+	[IBO_ILESS] = MN_JGE, [IBO_IGREATER_EQ] = MN_JL,
+	[IBO_EQUAL] = MN_JNE, [IBO_NOT_EQUAL] = MN_JE,
+	[IBO_LESS] = MN_JNB, [IBO_GREATER] = MN_JNA,
+	[IBO_LESS_EQ] = MN_JA, [IBO_GREATER_EQ] = MN_JNAE,
 };
 
 #endif
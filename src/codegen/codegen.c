@@ -1,6 +1,7 @@
 #include "codegen.h"
 #include "registers.h"
 #include "binary_operators.h"
+#include "allocator.h"
 
 #include <common.h>
 #include <parser/declaration.h>
@@ -26,20 +27,109 @@ struct vla_info {
 	} *slots;
 } vla_info;
 
+// Number of uses of each variable in the current function.
+static int *use_count;
+
+static int is_direct_compare(enum ir_binary_operator ibo, var_id lhs, var_id rhs) {
+	int size = get_variable_size(lhs);
+	return (size == 4 || size == 8) && get_variable_size(rhs) == size &&
+		binary_operator_setcc[ibo];
+}
+
+// Set the flags according to lhs compared with rhs.
+static void codegen_compare(var_id lhs, var_id rhs) {
+	int size = get_variable_size(lhs);
+	int lhs_reg = REG_RDI;
+	if (scalar_is_reg(lhs))
+		lhs_reg = variable_info[lhs].reg;
+	else
+		scalar_to_reg(lhs, REG_RDI);
+
+	asm_ins2(size == 4 ? MN_CMPL : MN_CMPQ, scalar_operand(rhs), reg_operand(lhs_reg, size));
+}
+
+// Operands are taken directly from memory or SSE registers,
+// xmm0 and xmm1 are used when they are in general purpose registers.
+static void codegen_float_operator(enum ir_binary_operator ibo,
+								   var_id lhs, var_id rhs, var_id res) {
+	int size = get_variable_size(lhs);
+	if (binary_operator_float_setcc[ibo]) {
+		scalar_to_xmm(lhs, 0);
+		struct operand rhs_operand = scalar_xmm_operand(rhs, 1);
+		asm_ins2(MN_XORL, R4(REG_RAX), R4(REG_RAX));
+		asm_ins2(size == 4 ? MN_UCOMISS : MN_UCOMISD, rhs_operand, XMM(0));
+		asm_ins1(binary_operator_float_setcc[ibo], R1(REG_RAX));
+		reg_to_scalar(REG_RAX, res);
+		return;
+	}
+
+	int commutative = ibo == IBO_FLT_ADD || ibo == IBO_FLT_MUL;
+	if (commutative && scalar_is_xmm(res) && scalar_is_xmm(rhs) &&
+		variable_info[rhs].reg == variable_info[res].reg) {
+		var_id tmp = lhs;
+		lhs = rhs;
+		rhs = tmp;
+	}
+
+	int target = 0;
+	if (scalar_is_xmm(res) &&
+		!(scalar_is_xmm(rhs) && variable_info[rhs].reg == variable_info[res].reg))
+		target = variable_info[res].reg;
+
+	scalar_to_xmm(lhs, target);
+	struct operand rhs_operand = scalar_xmm_operand(rhs, 1);
+	asm_ins2(binary_operator_float[size == 8][ibo], rhs_operand, XMM(target));
+
+	if (target == 0)
+		xmm_to_scalar(0, res);
+}
+
 void codegen_binary_operator(enum ir_binary_operator ibo,
 							 var_id lhs, var_id rhs, var_id res) {
+	int size = get_variable_size(lhs);
+	int size_idx = size == 4 ? 0 : 1;
+
+	if ((size == 4 || size == 8) &&
+		(binary_operator_float[size_idx][ibo] || binary_operator_float_setcc[ibo])) {
+		codegen_float_operator(ibo, lhs, rhs, res);
+		return;
+	}
+
+	if ((size == 4 || size == 8) && get_variable_size(rhs) == size &&
+		binary_operator_direct[size_idx][ibo]) {
+		// Compute directly into the register of the result, if it
+		// does not hold the right hand side.
+		int target = REG_RAX;
+		if (scalar_is_reg(res) && get_variable_size(res) == size &&
+			!(scalar_is_reg(rhs) && variable_info[rhs].reg == variable_info[res].reg))
+			target = variable_info[res].reg;
+
+		scalar_to_reg(lhs, target);
+		asm_ins2(binary_operator_direct[size_idx][ibo], scalar_operand(rhs), reg_operand(target, size));
+
+		if (target == REG_RAX)
+			reg_to_scalar(REG_RAX, res);
+		return;
+	}
+
+	if (is_direct_compare(ibo, lhs, rhs)) {
+		asm_ins2(MN_XORL, R4(REG_RAX), R4(REG_RAX));
+		codegen_compare(lhs, rhs);
+		asm_ins1(binary_operator_setcc[ibo], R1(REG_RAX));
+		reg_to_scalar(REG_RAX, res);
+		return;
+	}
+
 	scalar_to_reg(lhs, REG_RDI);
 	scalar_to_reg(rhs, REG_RSI);
 
-	int size = get_variable_size(lhs);
-
 	if (size != 4 && size != 8) {
 		printf("Invalid size %d = %d op %d with %d\n", get_variable_size(res), size, get_variable_size(rhs), ibo);
 	}
 
 	assert(size == 4 || size == 8);
 
-	struct asm_instruction *bin_op = binary_operator_output[size == 4 ? 0 : 1][ibo];
+	struct asm_instruction *bin_op = binary_operator_output[size_idx][ibo];
 	if (bin_op->mnemonic) {
 		for (int i = 0; i < 5 && bin_op[i].mnemonic; i++) {
 			asm_ins(bin_op + i);
@@ -53,75 +143,102 @@ void codegen_binary_operator(enum ir_binary_operator ibo,
 
 void codegen_call(var_id variable, int non_clobbered_register) {
 	scalar_to_reg(variable, non_clobbered_register);
-	asm_ins1("callq", R8S(non_clobbered_register));
+	asm_ins1(MN_CALLQ, R8S(non_clobbered_register));
 }
 
-// Address in rdi.
-void codegen_memzero(int len) {
+// Copies and zeroing of at most COPY_UNROLL_MAX bytes are unrolled into
+// scalar moves, and up to COPY_SSE_MAX into 16 byte SSE moves.
+// Larger sizes use rep movsq/stosq.
+#define COPY_UNROLL_MAX 64
+#define COPY_SSE_MAX 256
+
+static void codegen_copy_unrolled(int src_base, int src, int dest_base, int dest, int len) {
 	for (int i = 0; i < len;) {
 		if (i + 8 <= len) {
-			asm_ins2("movq", IMM(0), MEM(i, REG_RDI));
+			asm_ins2(MN_MOVQ, MEM(src + i, src_base), R8(REG_RAX));
+			asm_ins2(MN_MOVQ, R8(REG_RAX), MEM(dest + i, dest_base));
 			i += 8;
 		} else if (i + 4 <= len) {
-			asm_ins2("movl", IMM(0), MEM(i, REG_RDI));
+			asm_ins2(MN_MOVL, MEM(src + i, src_base), R4(REG_RAX));
+			asm_ins2(MN_MOVL, R4(REG_RAX), MEM(dest + i, dest_base));
 			i += 4;
 		} else if (i + 2 <= len) {
-			asm_ins2("movw", IMM(0), MEM(i, REG_RDI));
+			asm_ins2(MN_MOVW, MEM(src + i, src_base), R2(REG_RAX));
+			asm_ins2(MN_MOVW, R2(REG_RAX), MEM(dest + i, dest_base));
 			i += 2;
-		} else if (i + 1 <= len) {
-			asm_ins2("movb", IMM(0), MEM(i, REG_RDI));
+		} else {
+			asm_ins2(MN_MOVB, MEM(src + i, src_base), R1(REG_RAX));
+			asm_ins2(MN_MOVB, R1(REG_RAX), MEM(dest + i, dest_base));
 			i += 1;
-		} else
-			break;
+		}
 	}
 }
 
-void codegen_memcpy(int len) {
-	for (int i = 0; i < len;) {
-		if (i + 8 <= len) {
-			asm_ins2("movq", MEM(i, REG_RDI), R8(REG_RAX));
-			asm_ins2("movq", R8(REG_RAX), MEM(i, REG_RSI));
-			i += 8;
-		} else if (i + 4 <= len) {
-			asm_ins2("movl", MEM(i, REG_RDI), R4(REG_RAX));
-			asm_ins2("movl", R4(REG_RAX), MEM(i, REG_RSI));
-			i += 4;
-		} else if (i + 2 <= len) {
-			asm_ins2("movw", MEM(i, REG_RDI), R2(REG_RAX));
-			asm_ins2("movw", R2(REG_RAX), MEM(i, REG_RSI));
-			i += 2;
-		} else if (i + 1 <= len) {
-			asm_ins2("movb", MEM(i, REG_RDI), R1(REG_RAX));
-			asm_ins2("movb", R1(REG_RAX), MEM(i, REG_RSI));
-			i += 1;
-		} else
-			break;
+// Clobbers rax, rcx, rsi, rdi, and xmm0.
+static void codegen_copy(int src_base, int src, int dest_base, int dest, int len) {
+	if (len <= COPY_UNROLL_MAX) {
+		codegen_copy_unrolled(src_base, src, dest_base, dest, len);
+	} else if (len <= COPY_SSE_MAX) {
+		int i = 0;
+		for (; i + 16 <= len; i += 16) {
+			asm_ins2(MN_MOVDQU, MEM(src + i, src_base), XMM(0));
+			asm_ins2(MN_MOVDQU, XMM(0), MEM(dest + i, dest_base));
+		}
+		codegen_copy_unrolled(src_base, src + i, dest_base, dest + i, len - i);
+	} else {
+		asm_ins2(MN_LEAQ, MEM(src, src_base), R8(REG_RAX));
+		asm_ins2(MN_LEAQ, MEM(dest, dest_base), R8(REG_RDI));
+		asm_ins2(MN_MOVQ, R8(REG_RAX), R8(REG_RSI));
+		asm_ins2(MN_MOVL, IMM(len / 8), R4(REG_RCX));
+		asm_ins0(MN_REP_MOVSQ);
+		codegen_copy_unrolled(REG_RSI, 0, REG_RDI, 0, len % 8);
 	}
 }
 
-void codegen_stackcpy(int dest, int source, int len) {
+static void codegen_zero_unrolled(int offset, int len) {
 	for (int i = 0; i < len;) {
 		if (i + 8 <= len) {
-			asm_ins2("movq", MEM(source + i, REG_RBP), R8(REG_RAX));
-			asm_ins2("movq", R8(REG_RAX), MEM(dest + i, REG_RBP));
+			asm_ins2(MN_MOVQ, IMM(0), MEM(offset + i, REG_RDI));
 			i += 8;
 		} else if (i + 4 <= len) {
-			asm_ins2("movl", MEM(source + i, REG_RBP), R4(REG_RAX));
-			asm_ins2("movl", R4(REG_RAX), MEM(dest + i, REG_RBP));
+			asm_ins2(MN_MOVL, IMM(0), MEM(offset + i, REG_RDI));
 			i += 4;
 		} else if (i + 2 <= len) {
-			asm_ins2("movw", MEM(source + i, REG_RBP), R2(REG_RAX));
-			asm_ins2("movw", R2(REG_RAX), MEM(dest + i, REG_RBP));
+			asm_ins2(MN_MOVW, IMM(0), MEM(offset + i, REG_RDI));
 			i += 2;
-		} else if (i + 1 <= len) {
-			asm_ins2("movb", MEM(source + i, REG_RBP), R1(REG_RAX));
-			asm_ins2("movb", R1(REG_RAX), MEM(dest + i, REG_RBP));
+		} else {
+			asm_ins2(MN_MOVB, IMM(0), MEM(offset + i, REG_RDI));
 			i += 1;
-		} else
-			break;
+		}
+	}
+}
+
+// Address in rdi. Clobbers rax, rcx, rdi, and xmm0.
+void codegen_memzero(int len) {
+	if (len <= COPY_UNROLL_MAX) {
+		codegen_zero_unrolled(0, len);
+	} else if (len <= COPY_SSE_MAX) {
+		int i = 0;
+		asm_ins2(MN_XORPS, XMM(0), XMM(0));
+		for (; i + 16 <= len; i += 16)
+			asm_ins2(MN_MOVDQU, XMM(0), MEM(i, REG_RDI));
+		codegen_zero_unrolled(i, len - i);
+	} else {
+		asm_ins2(MN_XORL, R4(REG_RAX), R4(REG_RAX));
+		asm_ins2(MN_MOVL, IMM(len / 8), R4(REG_RCX));
+		asm_ins0(MN_REP_STOSQ);
+		codegen_zero_unrolled(0, len % 8);
 	}
 }
 
+void codegen_memcpy(int len) {
+	codegen_copy(REG_RDI, 0, REG_RSI, 0, len);
+}
+
+void codegen_stackcpy(int dest, int source, int len) {
+	codegen_copy(REG_RBP, source, REG_RBP, dest, len);
+}
+
 void codegen_instruction(struct instruction ins, struct function *func) {
 	const char *ins_str = dbg_instruction(ins);
 	asm_comment("instruction start \"%s\":", ins_str);
@@ -131,21 +248,47 @@ void codegen_instruction(struct instruction ins, struct function *func) {
 		switch (c.type) {
 		case CONSTANT_TYPE: {
 			int size = calculate_size(c.data_type);
-			if (c.data_type->type == TY_SIMPLE ||
+			if (scalar_is_xmm(ins.result)) {
+				int xmm = variable_info[ins.result].reg;
+				uint64_t value = constant_to_u64(c);
+				if (size < 8)
+					value &= ((uint64_t)1 << (size * 8)) - 1;
+
+				if (value == 0) {
+					asm_ins2(MN_XORPS, XMM(xmm), XMM(xmm));
+				} else {
+					label_id constant = rodata_register_constant(value, size);
+					asm_ins2(codegen_flags.cmodel == CMODEL_LARGE ? MN_MOVABSQ : MN_MOVQ,
+							 IMML(constant, 0), R8(REG_RDI));
+					asm_ins2(size == 4 ? MN_MOVSS : MN_MOVSD, MEM(0, REG_RDI), XMM(xmm));
+				}
+			} else if (scalar_is_reg(ins.result)) {
+				int reg = variable_info[ins.result].reg;
+				uint64_t value = constant_to_u64(c);
+				int64_t svalue = value;
+				if (size < 8) {
+					value &= ((uint64_t)1 << (size * 8)) - 1;
+					asm_ins2(MN_MOVL, IMM(value), R4(reg));
+				} else if (svalue >= INT32_MIN && svalue <= INT32_MAX) {
+					asm_ins2(MN_MOVQ, IMM(value), R8(reg));
+				} else {
+					asm_ins2(MN_MOVABSQ, IMM(value), R8(reg));
+				}
+			} else if (c.data_type->type == TY_SIMPLE ||
 				type_is_pointer(c.data_type)) {
 				switch (size) {
 				case 1:
-					asm_ins2("movb", IMM(constant_to_u64(c)), MEM(-variable_info[ins.result].stack_location, REG_RBP));
+					asm_ins2(MN_MOVB, IMM(constant_to_u64(c)), MEM(-variable_info[ins.result].stack_location, REG_RBP));
 					break;
 				case 2:
-					asm_ins2("movw", IMM(constant_to_u64(c)), MEM(-variable_info[ins.result].stack_location, REG_RBP));
+					asm_ins2(MN_MOVW, IMM(constant_to_u64(c)), MEM(-variable_info[ins.result].stack_location, REG_RBP));
 					break;
 				case 4:
-					asm_ins2("movl", IMM(constant_to_u64(c)), MEM(-variable_info[ins.result].stack_location, REG_RBP));
+					asm_ins2(MN_MOVL, IMM(constant_to_u64(c)), MEM(-variable_info[ins.result].stack_location, REG_RBP));
 					break;
 				case 8:
-					asm_ins2("movabsq", IMM(constant_to_u64(c)), R8(REG_RAX));
-					asm_ins2("movq", R8(REG_RAX), MEM(-variable_info[ins.result].stack_location, REG_RBP));
+					asm_ins2(MN_MOVABSQ, IMM(constant_to_u64(c)), R8(REG_RAX));
+					asm_ins2(MN_MOVQ, R8(REG_RAX), MEM(-variable_info[ins.result].stack_location, REG_RBP));
 					break;
 
 				case 0: break;
@@ -154,28 +297,34 @@ void codegen_instruction(struct instruction ins, struct function *func) {
 				}
 			} else {
 				uint8_t buffer[size];
+				memset(buffer, 0, size);
 				constant_to_buffer(buffer, c, 0, -1);
-				for (int i = 0; i < size; i++)
-					asm_ins2("movb", IMM(buffer[i]), MEM(-variable_info[ins.result].stack_location - i, REG_RBP));
+				label_id image = rodata_register_data(buffer, size);
+				asm_ins2(codegen_flags.cmodel == CMODEL_LARGE ? MN_MOVABSQ : MN_MOVQ, IMML(image, 0), R8(REG_RDI));
+				asm_ins2(MN_LEAQ, MEM(-variable_info[ins.result].stack_location, REG_RBP), R8(REG_RSI));
+				codegen_memcpy(size);
 			}
 		} break;
 
 		case CONSTANT_LABEL:
 			if (codegen_flags.cmodel == CMODEL_LARGE) {
-				asm_ins2("movabsq", IMML(c.label.label, c.label.offset), R8(REG_RDI));
+				asm_ins2(MN_MOVABSQ, IMML(c.label.label, c.label.offset), R8(REG_RDI));
 			} else if (codegen_flags.cmodel == CMODEL_SMALL) {
-				asm_ins2("movq", IMML(c.label.label, c.label.offset), R8(REG_RDI));
+				asm_ins2(MN_MOVQ, IMML(c.label.label, c.label.offset), R8(REG_RDI));
 			}
-			asm_ins2("leaq", MEM(-variable_info[ins.result].stack_location, REG_RBP), R8(REG_RSI));
+			asm_ins2(MN_LEAQ, MEM(-variable_info[ins.result].stack_location, REG_RBP), R8(REG_RSI));
 			codegen_memcpy(get_variable_size(ins.result));
 			break;
 
 		case CONSTANT_LABEL_POINTER:
-			if (codegen_flags.cmodel == CMODEL_LARGE) {
-				asm_ins2("movabsq", IMML(c.label.label, c.label.offset), R8(REG_RAX));
-				asm_ins2("movq", R8(REG_RAX), MEM(-variable_info[ins.result].stack_location, REG_RBP));
+			if (scalar_is_reg(ins.result)) {
+				asm_ins2(codegen_flags.cmodel == CMODEL_LARGE ? MN_MOVABSQ : MN_MOVQ,
+						 IMML(c.label.label, c.label.offset), R8(variable_info[ins.result].reg));
+			} else if (codegen_flags.cmodel == CMODEL_LARGE) {
+				asm_ins2(MN_MOVABSQ, IMML(c.label.label, c.label.offset), R8(REG_RAX));
+				asm_ins2(MN_MOVQ, R8(REG_RAX), MEM(-variable_info[ins.result].stack_location, REG_RBP));
 			} else if (codegen_flags.cmodel == CMODEL_SMALL) {
-				asm_ins2("movq", IMML(c.label.label, c.label.offset),
+				asm_ins2(MN_MOVQ, IMML(c.label.label, c.label.offset),
 						 MEM(-variable_info[ins.result].stack_location, REG_RBP));
 			}
 			break;
@@ -194,29 +343,41 @@ void codegen_instruction(struct instruction ins, struct function *func) {
 
 	case IR_BINARY_NOT:
 		scalar_to_reg(ins.int_cast.rhs, REG_RAX);
-		asm_ins1("notq", R8(REG_RAX));
+		asm_ins1(MN_NOTQ, R8(REG_RAX));
 		reg_to_scalar(REG_RAX, ins.result);
 		break;
 
 	case IR_NEGATE_INT:
 		scalar_to_reg(ins.int_cast.rhs, REG_RAX);
-		asm_ins1("negq", R8(REG_RAX));
+		asm_ins1(MN_NEGQ, R8(REG_RAX));
 		reg_to_scalar(REG_RAX, ins.result);
 		break;
 
 	case IR_NEGATE_FLOAT:
+		// Flip the sign bit, subtracting from zero gives the wrong sign for -0.0.
+		if (scalar_is_xmm(ins.result) || scalar_is_xmm(ins.negate_float.operand)) {
+			int target = scalar_is_xmm(ins.result) ? variable_info[ins.result].reg : 0;
+			scalar_to_xmm(ins.negate_float.operand, target);
+			if (get_variable_size(ins.result) == 4) {
+				asm_ins2(MN_MOVL, IMM(0x80000000), R4(REG_RAX));
+				asm_ins2(MN_MOVD, R4(REG_RAX), XMM(1));
+			} else {
+				asm_ins2(MN_MOVABSQ, IMM(0x8000000000000000), R8(REG_RAX));
+				asm_ins2(MN_MOVQ, R8(REG_RAX), XMM(1));
+			}
+			asm_ins2(MN_XORPS, XMM(1), XMM(target));
+			if (target == 0)
+				xmm_to_scalar(0, ins.result);
+			break;
+		}
+
 		scalar_to_reg(ins.int_cast.rhs, REG_RAX);
 		if (get_variable_size(ins.result) == 4) {
-			asm_ins2("movd", R4(REG_RAX), XMM(1));
-			asm_ins1("negq", R8(REG_RAX));
-			asm_ins2("xorps", XMM(0), XMM(0));
-			asm_ins2("subss", XMM(1), XMM(0));
-			asm_ins2("movd", XMM(0), R4(REG_RAX));
+			asm_ins2(MN_MOVL, IMM(0x80000000), R4(REG_RDI));
+			asm_ins2(MN_XORL, R4(REG_RDI), R4(REG_RAX));
 		} else if (get_variable_size(ins.result) == 8) {
-			asm_ins2("movq", R8(REG_RAX), XMM(1));
-			asm_ins2("xorps", XMM(0), XMM(0));
-			asm_ins2("subsd", XMM(1), XMM(0));
-			asm_ins2("movq", XMM(0), R8(REG_RAX));
+			asm_ins2(MN_MOVABSQ, IMM(0x8000000000000000), R8(REG_RDI));
+			asm_ins2(MN_XORQ, R8(REG_RDI), R8(REG_RAX));
 		} else {
 			NOTIMP();
 		}
@@ -228,34 +389,108 @@ void codegen_instruction(struct instruction ins, struct function *func) {
 		break;
 
 	case IR_LOAD: {
+		if (scalar_is_xmm(ins.result)) {
+			int base = REG_RDI;
+			if (scalar_is_reg(ins.load.pointer))
+				base = variable_info[ins.load.pointer].reg;
+			else
+				scalar_to_reg(ins.load.pointer, REG_RDI);
+
+			asm_ins2(get_variable_size(ins.result) == 4 ? MN_MOVSS : MN_MOVSD,
+					 MEM(0, base), XMM(variable_info[ins.result].reg));
+			break;
+		}
+
+		if (scalar_is_reg(ins.result)) {
+			int base = REG_RDI;
+			if (scalar_is_reg(ins.load.pointer))
+				base = variable_info[ins.load.pointer].reg;
+			else
+				scalar_to_reg(ins.load.pointer, REG_RDI);
+
+			int reg = variable_info[ins.result].reg;
+			switch (get_variable_size(ins.result)) {
+			case 1: asm_ins2(MN_MOVZBL, MEM(0, base), R4(reg)); break;
+			case 2: asm_ins2(MN_MOVZWL, MEM(0, base), R4(reg)); break;
+			case 4: asm_ins2(MN_MOVL, MEM(0, base), R4(reg)); break;
+			case 8: asm_ins2(MN_MOVQ, MEM(0, base), R8(reg)); break;
+			}
+			break;
+		}
+
 		scalar_to_reg(ins.load.pointer, REG_RDI);
-		asm_ins2("leaq", MEM(-variable_info[ins.result].stack_location, REG_RBP), R8(REG_RSI));
+		asm_ins2(MN_LEAQ, MEM(-variable_info[ins.result].stack_location, REG_RBP), R8(REG_RSI));
 
 		codegen_memcpy(get_variable_size(ins.result));
 	} break;
 
 	case IR_LOAD_BASE_RELATIVE:
-		asm_ins2("leaq", MEM(ins.load_base_relative.offset, REG_RBP), R8(REG_RDI));
-		asm_ins2("leaq", MEM(-variable_info[ins.result].stack_location, REG_RBP), R8(REG_RSI));
+		asm_ins2(MN_LEAQ, MEM(ins.load_base_relative.offset, REG_RBP), R8(REG_RDI));
+		asm_ins2(MN_LEAQ, MEM(-variable_info[ins.result].stack_location, REG_RBP), R8(REG_RSI));
 
 		codegen_memcpy(get_variable_size(ins.result));
 	break;
 
 	case IR_STORE: {
+		if (scalar_is_xmm(ins.store.value)) {
+			int base = REG_RSI;
+			if (scalar_is_reg(ins.store.pointer))
+				base = variable_info[ins.store.pointer].reg;
+			else
+				scalar_to_reg(ins.store.pointer, REG_RSI);
+
+			asm_ins2(get_variable_size(ins.store.value) == 4 ? MN_MOVSS : MN_MOVSD,
+					 XMM(variable_info[ins.store.value].reg), MEM(0, base));
+			break;
+		}
+
+		if (scalar_is_reg(ins.store.value)) {
+			int base = REG_RSI;
+			if (scalar_is_reg(ins.store.pointer))
+				base = variable_info[ins.store.pointer].reg;
+			else
+				scalar_to_reg(ins.store.pointer, REG_RSI);
+
+			int size = get_variable_size(ins.store.value);
+			asm_ins2(size == 1 ? MN_MOVB : size == 2 ? MN_MOVW : size == 4 ? MN_MOVL : MN_MOVQ,
+					 reg_operand(variable_info[ins.store.value].reg, size), MEM(0, base));
+			break;
+		}
+
 		scalar_to_reg(ins.store.pointer, REG_RSI);
-		asm_ins2("leaq", MEM(-variable_info[ins.store.value].stack_location, REG_RBP), R8(REG_RDI));
+		asm_ins2(MN_LEAQ, MEM(-variable_info[ins.store.value].stack_location, REG_RBP), R8(REG_RDI));
 
 		codegen_memcpy(get_variable_size(ins.store.value));
 	} break;
 
 	case IR_STORE_STACK_RELATIVE: {
-		asm_ins2("leaq", MEM(ins.store_stack_relative.offset, REG_RSP), R8(REG_RSI));
-		asm_ins2("leaq", MEM(-variable_info[ins.store_stack_relative.variable].stack_location, REG_RBP), R8(REG_RDI));
+		asm_ins2(MN_LEAQ, MEM(ins.store_stack_relative.offset, REG_RSP), R8(REG_RSI));
+		asm_ins2(MN_LEAQ, MEM(-variable_info[ins.store_stack_relative.variable].stack_location, REG_RBP), R8(REG_RDI));
 
 		codegen_memcpy(get_variable_size(ins.store_stack_relative.variable));
 	} break;
 
 	case IR_COPY:
+		if (scalar_is_xmm(ins.result)) {
+			scalar_to_xmm(ins.copy.source, variable_info[ins.result].reg);
+			break;
+		} else if (scalar_is_xmm(ins.copy.source)) {
+			xmm_to_scalar(variable_info[ins.copy.source].reg, ins.result);
+			break;
+		}
+
+		if (scalar_is_reg(ins.result) || scalar_is_reg(ins.copy.source)) {
+			if (get_variable_size(ins.result) == get_variable_size(ins.copy.source) &&
+				scalar_is_reg(ins.result)) {
+				scalar_to_reg(ins.copy.source, variable_info[ins.result].reg);
+			} else if (get_variable_size(ins.result) == get_variable_size(ins.copy.source)) {
+				reg_to_scalar(variable_info[ins.copy.source].reg, ins.result);
+			} else {
+				scalar_to_reg(ins.copy.source, REG_RAX);
+				reg_to_scalar(REG_RAX, ins.result);
+			}
+			break;
+		}
 		codegen_stackcpy(-variable_info[ins.result].stack_location,
 						 -variable_info[ins.copy.source].stack_location,
 						 get_variable_size(ins.copy.source));
@@ -267,11 +502,11 @@ void codegen_instruction(struct instruction ins, struct function *func) {
 			size_result = get_variable_size(ins.result);
 		if (size_result > size_rhs && ins.int_cast.sign_extend) {
 			if (size_rhs == 1) {
-				asm_ins2("movsbq", R1(REG_RAX), R8(REG_RAX));
+				asm_ins2(MN_MOVSBQ, R1(REG_RAX), R8(REG_RAX));
 			} else if (size_rhs == 2) {
-				asm_ins2("movswq", R2(REG_RAX), R8(REG_RAX));
+				asm_ins2(MN_MOVSWQ, R2(REG_RAX), R8(REG_RAX));
 			} else if (size_rhs == 4) {
-				asm_ins2("movslq", R4(REG_RAX), R8(REG_RAX));
+				asm_ins2(MN_MOVSLQ, R4(REG_RAX), R8(REG_RAX));
 			}
 		}
 		reg_to_scalar(REG_RAX, ins.result);
@@ -280,73 +515,74 @@ void codegen_instruction(struct instruction ins, struct function *func) {
 	case IR_BOOL_CAST: {
 		scalar_to_reg(ins.bool_cast.rhs, REG_RAX);
 
-		asm_ins2("testq", R8(REG_RAX), R8(REG_RAX));
-		asm_ins1("setne", R1(REG_RAX));
+		asm_ins2(MN_TESTQ, R8(REG_RAX), R8(REG_RAX));
+		asm_ins1(MN_SETNE, R1(REG_RAX));
 
 		reg_to_scalar(REG_RAX, ins.result);
 	} break;
 
 	case IR_FLOAT_CAST: {
-		scalar_to_reg(ins.float_cast.rhs, REG_RAX);
 		int size_rhs = get_variable_size(ins.float_cast.rhs),
 			size_result = get_variable_size(ins.result);
+		int target = scalar_is_xmm(ins.result) ? variable_info[ins.result].reg : 0;
 
 		if (size_rhs == 4 && size_result == 8) {
-			asm_ins2("movd", R4(REG_RAX), XMM(0));
-			asm_ins2("cvtss2sd", XMM(0), XMM(0));
-			asm_ins2("movq", XMM(0), R8(REG_RAX));
+			asm_ins2(MN_CVTSS2SD, scalar_xmm_operand(ins.float_cast.rhs, 1), XMM(target));
 		} else if (size_rhs == 8 && size_result == 4) {
-			asm_ins2("movq", R8(REG_RAX), XMM(0));
-			asm_ins2("cvtsd2ss", XMM(0), XMM(0));
-			asm_ins2("movd", XMM(0), R4(REG_RAX));
+			asm_ins2(MN_CVTSD2SS, scalar_xmm_operand(ins.float_cast.rhs, 1), XMM(target));
 		} else {
 			assert(size_rhs == size_result);
+			scalar_to_xmm(ins.float_cast.rhs, target);
 		}
 
-		reg_to_scalar(REG_RAX, ins.result);
+		if (target == 0)
+			xmm_to_scalar(0, ins.result);
 	} break;
 
 	case IR_INT_FLOAT_CAST: {
-		scalar_to_reg(ins.int_float_cast.rhs, REG_RAX);
 		int size_rhs = get_variable_size(ins.int_float_cast.rhs),
 			size_result = get_variable_size(ins.result);
 		int sign = ins.int_float_cast.sign;
 		if (ins.int_float_cast.from_float) {
 			// This is not the exact same as gcc and clang in the
 			// case of unsigned long. But within the C standard?
-			if (size_rhs == 4) {
-				asm_ins2("movd", R4(REG_RAX), XMM(0));
-				asm_ins2("cvttss2si", XMM(0), R8(REG_RAX));
-			} else if (size_rhs == 8) {
-				asm_ins2("movd", R8(REG_RAX), XMM(0));
-				asm_ins2("cvttsd2si", XMM(0), R8(REG_RAX));
-			}
+			asm_ins2(size_rhs == 4 ? MN_CVTTSS2SI : MN_CVTTSD2SI,
+					 scalar_xmm_operand(ins.int_float_cast.rhs, 0), R8(REG_RAX));
 		} else {
+			scalar_to_reg(ins.int_float_cast.rhs, REG_RAX);
 			if (sign && size_rhs == 1) {
-				asm_ins2("movsbl", R1(REG_RAX), R4(REG_RAX));
+				asm_ins2(MN_MOVSBL, R1(REG_RAX), R4(REG_RAX));
 			} else if (!sign && size_rhs == 1) {
-				asm_ins2("movzbl", R1(REG_RAX), R4(REG_RAX));
+				asm_ins2(MN_MOVZBL, R1(REG_RAX), R4(REG_RAX));
 			} else if (sign && size_rhs == 2) {
-				asm_ins2("movswl", R2(REG_RAX), R4(REG_RAX));
+				asm_ins2(MN_MOVSWL, R2(REG_RAX), R4(REG_RAX));
 			} else if (!sign && size_rhs == 2) {
-				asm_ins2("movzwl", R2(REG_RAX), R4(REG_RAX));
+				asm_ins2(MN_MOVZWL, R2(REG_RAX), R4(REG_RAX));
 			}
 
+			int target = scalar_is_xmm(ins.result) ? variable_info[ins.result].reg : 0;
 			if (size_result == 4) {
-				asm_ins2("cvtsi2ss", R8(REG_RAX), XMM(0));
-				asm_ins2("movd", XMM(0), R4(REG_RAX));
+				asm_ins2(MN_CVTSI2SS, R8(REG_RAX), XMM(target));
 			} else if (size_result == 8) {
-				asm_ins2("cvtsi2sd", R8(REG_RAX), XMM(0));
-				asm_ins2("movq", XMM(0), R8(REG_RAX));
+				asm_ins2(MN_CVTSI2SD, R8(REG_RAX), XMM(target));
 			} else {
 				NOTIMP();
 			}
+
+			if (target == 0)
+				xmm_to_scalar(0, ins.result);
+			break;
 		}
 		reg_to_scalar(REG_RAX, ins.result);
 	} break;
 
 	case IR_ADDRESS_OF:
-		asm_ins2("leaq", MEM(-variable_info[ins.address_of.variable].stack_location, REG_RBP), R8(REG_RAX));
+		if (scalar_is_reg(ins.result)) {
+			asm_ins2(MN_LEAQ, MEM(-variable_info[ins.address_of.variable].stack_location, REG_RBP),
+					 R8(variable_info[ins.result].reg));
+			break;
+		}
+		asm_ins2(MN_LEAQ, MEM(-variable_info[ins.address_of.variable].stack_location, REG_RBP), R8(REG_RAX));
 		reg_to_scalar(REG_RAX, ins.result);
 		break;
 
@@ -359,7 +595,7 @@ void codegen_instruction(struct instruction ins, struct function *func) {
 		break;
 
 	case IR_SET_ZERO:
-		asm_ins2("leaq", MEM(-variable_info[ins.result].stack_location, REG_RBP), R8(REG_RDI));
+		asm_ins2(MN_LEAQ, MEM(-variable_info[ins.result].stack_location, REG_RBP), R8(REG_RDI));
 		codegen_memzero(get_variable_size(ins.result));
 		break;
 
@@ -369,28 +605,28 @@ void codegen_instruction(struct instruction ins, struct function *func) {
 			if (vla_info.slots[i].dominance == ins.stack_alloc.dominance) {
 				slot = vla_info.slots + i;
 			} else if (vla_info.slots[i].dominance > ins.stack_alloc.dominance) {
-				asm_ins2("movq", IMM(0), MEM(-variable_info[vla_info.slots[i].slot].stack_location, REG_RBP));
+				asm_ins2(MN_MOVQ, IMM(0), MEM(-variable_info[vla_info.slots[i].slot].stack_location, REG_RBP));
 			}
 		}
 		assert(slot);
 
 		label_id tmp_label = register_label();
-		asm_ins2("movq", MEM(-variable_info[slot->slot].stack_location, REG_RBP), R8(REG_RAX));
-		asm_ins2("cmpq", IMM(0), R8(REG_RAX));
-		asm_ins1("jne", IMML_ABS(tmp_label, 0));
-		asm_ins2("movq", R8(REG_RSP), R8(REG_RAX));
-		asm_ins2("movq", R8(REG_RAX), MEM(-variable_info[slot->slot].stack_location, REG_RBP));
+		asm_ins2(MN_MOVQ, MEM(-variable_info[slot->slot].stack_location, REG_RBP), R8(REG_RAX));
+		asm_ins2(MN_CMPQ, IMM(0), R8(REG_RAX));
+		asm_ins1(MN_JNE, IMML_ABS(tmp_label, 0));
+		asm_ins2(MN_MOVQ, R8(REG_RSP), R8(REG_RAX));
+		asm_ins2(MN_MOVQ, R8(REG_RAX), MEM(-variable_info[slot->slot].stack_location, REG_RBP));
 		asm_label(0, tmp_label);
 		tmp_label++;
 
-		asm_ins2("movq", R8(REG_RAX), R8(REG_RSP));
+		asm_ins2(MN_MOVQ, R8(REG_RAX), R8(REG_RSP));
 
-		asm_ins2("movq", R8(REG_RSP), MEM(-variable_info[slot->slot].stack_location, REG_RBP));
+		asm_ins2(MN_MOVQ, R8(REG_RSP), MEM(-variable_info[slot->slot].stack_location, REG_RBP));
 		scalar_to_reg(ins.stack_alloc.length, REG_RAX);
-		asm_ins2("subq", R8(REG_RAX), R8(REG_RSP));
+		asm_ins2(MN_SUBQ, R8(REG_RAX), R8(REG_RSP));
 		reg_to_scalar(REG_RSP, ins.result);
 		// Align %rsp to 16 boundary. (Remember stack grows downwards. So rounding down is actually correct.)
-		asm_ins2("andq", IMM(-16), R8(REG_RSP));
+		asm_ins2(MN_ANDQ, IMM(-16), R8(REG_RSP));
 	} break;
 
 	case IR_CLEAR_STACK_BUCKET: // no-op
@@ -399,8 +635,7 @@ void codegen_instruction(struct instruction ins, struct function *func) {
 
 	case IR_SET_REG:
 		if (ins.set_reg.is_ssa) {
-			asm_ins2("movsd", MEM(-variable_info[ins.set_reg.variable].stack_location, REG_RBP),
-					 XMM(ins.set_reg.register_index));
+			scalar_to_xmm(ins.set_reg.variable, ins.set_reg.register_index);
 		} else {
 			scalar_to_reg(ins.set_reg.variable, ins.set_reg.register_index);
 		}
@@ -408,20 +643,14 @@ void codegen_instruction(struct instruction ins, struct function *func) {
 
 	case IR_GET_REG:
 		if (ins.get_reg.is_ssa) {
-			if (get_variable_size(ins.result) == 4) {
-				asm_ins2("movss", XMM(ins.get_reg.register_index),
-						 MEM(-variable_info[ins.result].stack_location, REG_RBP));
-			} else {
-				asm_ins2("movsd", XMM(ins.get_reg.register_index),
-						 MEM(-variable_info[ins.result].stack_location, REG_RBP));
-			}
+			xmm_to_scalar(ins.get_reg.register_index, ins.result);
 		} else {
 			reg_to_scalar(ins.get_reg.register_index, ins.result);
 		}
 		break;
 
 	case IR_MODIFY_STACK_POINTER:
-		asm_ins2("addq", IMM(ins.modify_stack_pointer.change), R8(REG_RSP));
+		asm_ins2(MN_ADDQ, IMM(ins.modify_stack_pointer.change), R8(REG_RSP));
 		break;
 
 	default:
@@ -430,71 +659,289 @@ void codegen_instruction(struct instruction ins, struct function *func) {
 	}
 }
 
-void codegen_block(struct block *block, struct function *func) {
+// Callee saved registers used by the register allocator.
+static struct {
+	int size;
+	struct saved_register {
+		int reg, stack_location;
+	} regs[16];
+} saved_registers;
+
+static void codegen_restore_registers(void) {
+	for (int i = 0; i < saved_registers.size; i++)
+		asm_ins2(MN_MOVQ, MEM(-saved_registers.regs[i].stack_location, REG_RBP),
+				 R8(saved_registers.regs[i].reg));
+}
+
+static void codegen_jump(block_id target, struct block *next) {
+	struct block *block = get_block(target);
+	if (block != next)
+		asm_ins1(MN_JMP, IMML_ABS(block->label, 0));
+}
+
+// Switch lowering. The controlling expression is always cast to int
+// by the parser, so all comparisons are signed 32-bit.
+#define SWITCH_LINEAR_MAX 4
+#define SWITCH_TABLE_MIN_CASES 5
+#define SWITCH_TABLE_MAX_RANGE 4096
+
+struct switch_case {
+	int value, index;
+	label_id label;
+};
+
+static int compare_switch_cases(const void *a, const void *b) {
+	const struct switch_case *ca = a, *cb = b;
+	if (ca->value != cb->value)
+		return ca->value < cb->value ? -1 : 1;
+	return ca->index - cb->index;
+}
+
+static void codegen_switch_jump(enum mnemonic mnemonic, label_id label, label_id fallthrough) {
+	if (label != fallthrough)
+		asm_ins1(mnemonic, IMML_ABS(label, 0));
+}
+
+static void codegen_switch_linear(struct switch_case *cases, int n,
+								  label_id default_label, label_id fallthrough) {
+	for (int i = 0; i < n; i++) {
+		asm_ins2(MN_CMPL, IMM(cases[i].value), R4(REG_RDI));
+		asm_ins1(MN_JE, IMML_ABS(cases[i].label, 0));
+	}
+	codegen_switch_jump(MN_JMP, default_label, fallthrough);
+}
+
+// Cases need to cover at least a third of the range.
+static int switch_is_dense(struct switch_case *cases, int n) {
+	int64_t range = (int64_t)cases[n - 1].value - cases[0].value + 1;
+	return n >= SWITCH_TABLE_MIN_CASES && range <= SWITCH_TABLE_MAX_RANGE && range <= 3 * n;
+}
+
+static void codegen_switch_table(struct switch_case *cases, int n, label_id default_label) {
+	int min = cases[0].value;
+	int range = cases[n - 1].value - min + 1;
+	label_id table = register_label();
+
+	asm_ins2(MN_MOVL, R4(REG_RDI), R4(REG_RAX));
+	if (min)
+		asm_ins2(MN_SUBL, IMM(min), R4(REG_RAX));
+	asm_ins2(MN_CMPL, IMM(range - 1), R4(REG_RAX));
+	asm_ins1(MN_JA, IMML_ABS(default_label, 0));
+	asm_ins2(codegen_flags.cmodel == CMODEL_LARGE ? MN_MOVABSQ : MN_MOVQ, IMML(table, 0), R8(REG_RSI));
+	asm_ins2(MN_SALQ, IMM(3), R8(REG_RAX));
+	asm_ins2(MN_ADDQ, R8(REG_RSI), R8(REG_RAX));
+	asm_ins2(MN_MOVQ, MEM(0, REG_RAX), R8(REG_RAX));
+	asm_ins1(MN_JMPQ, R8S(REG_RAX));
+
+	asm_section(".rodata");
+	asm_label(0, table);
+	int64_t value = min;
+	for (int i = 0; i < n; value++) {
+		if (cases[i].value == value)
+			asm_quad(IMML_ABS(cases[i++].label, 0));
+		else
+			asm_quad(IMML_ABS(default_label, 0));
+	}
+	asm_section(".text");
+}
+
+// Binary search on the sorted cases, using jump tables or linear
+// chains for the leaves.
+static void codegen_switch_tree(struct switch_case *cases, int n,
+								label_id default_label, label_id fallthrough) {
+	if (n <= SWITCH_LINEAR_MAX) {
+		codegen_switch_linear(cases, n, default_label, fallthrough);
+	} else if (switch_is_dense(cases, n)) {
+		codegen_switch_table(cases, n, default_label);
+	} else {
+		int mid = n / 2;
+		label_id upper = register_label();
+		asm_ins2(MN_CMPL, IMM(cases[mid].value), R4(REG_RDI));
+		asm_ins1(MN_JGE, IMML_ABS(upper, 0));
+		codegen_switch_tree(cases, mid, default_label, -1);
+		asm_label(0, upper);
+		codegen_switch_tree(cases + mid, n - mid, default_label, fallthrough);
+	}
+}
+
+static void codegen_switch(struct block_exit *block_exit, struct block *next) {
+	struct case_labels *labels = &block_exit->switch_.labels;
+	struct switch_case *cases = malloc(sizeof *cases * (labels->size + 1));
+	for (int i = 0; i < labels->size; i++) {
+		cases[i] = (struct switch_case) {
+			.value = labels->labels[i].value.int_d,
+			.index = i,
+			.label = get_block(labels->labels[i].block)->label
+		};
+	}
+
+	// Only the first of duplicate cases can be reached.
+	qsort(cases, labels->size, sizeof *cases, compare_switch_cases);
+	int n = 0;
+	for (int i = 0; i < labels->size; i++)
+		if (n == 0 || cases[n - 1].value != cases[i].value)
+			cases[n++] = cases[i];
+
+	// Without default, control falls through to the next block.
+	label_id fallthrough = next ? next->label : -1;
+	label_id default_label = labels->default_ ? get_block(labels->default_)->label : register_label();
+
+	scalar_to_reg(block_exit->switch_.condition, REG_RDI);
+	codegen_switch_tree(cases, n, default_label, labels->default_ ? fallthrough : default_label);
+
+	if (!labels->default_)
+		asm_label(0, default_label);
+
+	free(cases);
+}
+
+// A comparison that is only used by the exit of the block can jump
+// directly on the flags, instead of going through setcc and test.
+// Returns the index of the comparison, or -1.
+static int fused_compare(struct block *block) {
+	if (block->exit.type != BLOCK_EXIT_IF)
+		return -1;
+
+	// Skip instructions that do not emit any code.
+	int idx = block->size - 1;
+	while (idx >= 0 && (block->instructions[idx].type == IR_CLEAR_STACK_BUCKET ||
+						block->instructions[idx].type == IR_ADD_TEMPORARY))
+		idx--;
+
+	if (idx < 0)
+		return -1;
+
+	struct instruction *ins = block->instructions + idx;
+	var_id cond = block->exit.if_.condition;
+	if (ins->type != IR_BINARY_OPERATOR || ins->result != cond || use_count[cond] != 1 ||
+		!is_direct_compare(ins->binary_operator.type, ins->binary_operator.lhs, ins->binary_operator.rhs))
+		return -1;
+
+	return idx;
+}
+
+void codegen_block(struct block *block, struct function *func, struct block *next) {
 	asm_label(0, block->label);
 
+	int compare_idx = fused_compare(block);
+
 	for (int i = 0; i < block->size; i++)
-		codegen_instruction(block->instructions[i], func);
+		if (i != compare_idx)
+			codegen_instruction(block->instructions[i], func);
 
 	struct block_exit *block_exit = &block->exit;
 	asm_comment("EXIT IS OF TYPE : %d", block_exit->type);
 	switch (block_exit->type) {
 	case BLOCK_EXIT_JUMP:
-		asm_ins1("jmp", IMML_ABS(get_block(block_exit->jump)->label, 0));
+		codegen_jump(block_exit->jump, next);
 		break;
 
 	case BLOCK_EXIT_IF: {
-		var_id cond = block_exit->if_.condition;
-		int size = get_variable_size(cond);
-		scalar_to_reg(cond, REG_RDI);
-		switch (size) {
-		case 1: asm_ins2("testb", R1(REG_RDI), R1(REG_RDI)); break;
-		case 2: asm_ins2("testw", R2(REG_RDI), R2(REG_RDI)); break;
-		case 4: asm_ins2("testl", R4(REG_RDI), R4(REG_RDI)); break;
-		case 8: asm_ins2("testq", R8(REG_RDI), R8(REG_RDI)); break;
-		default: ICE("Invalid argument to if selection.");
+		enum mnemonic jcc = MN_JNE, jcc_inverse = MN_JE;
+		if (compare_idx != -1) {
+			struct instruction *compare = block->instructions + compare_idx;
+			enum ir_binary_operator ibo = compare->binary_operator.type;
+			codegen_compare(compare->binary_operator.lhs, compare->binary_operator.rhs);
+			jcc = binary_operator_jcc[ibo];
+			jcc_inverse = binary_operator_jcc_inverse[ibo];
+		} else {
+			var_id cond = block_exit->if_.condition;
+			int size = get_variable_size(cond);
+			int reg = REG_RDI;
+			if (scalar_is_reg(cond))
+				reg = variable_info[cond].reg;
+			else
+				scalar_to_reg(cond, REG_RDI);
+			switch (size) {
+			case 1: asm_ins2(MN_TESTB, R1(reg), R1(reg)); break;
+			case 2: asm_ins2(MN_TESTW, R2(reg), R2(reg)); break;
+			case 4: asm_ins2(MN_TESTL, R4(reg), R4(reg)); break;
+			case 8: asm_ins2(MN_TESTQ, R8(reg), R8(reg)); break;
+			default: ICE("Invalid argument to if selection.");
+			}
+		}
+
+		struct block *block_true = get_block(block_exit->if_.block_true),
+			*block_false = get_block(block_exit->if_.block_false);
+		if (block_false == next) {
+			asm_ins1(jcc, IMML_ABS(block_true->label, 0));
+		} else {
+			asm_ins1(jcc_inverse, IMML_ABS(block_false->label, 0));
+			codegen_jump(block_exit->if_.block_true, next);
 		}
-		asm_ins1("je", IMML_ABS(get_block(block_exit->if_.block_false)->label, 0));
-		asm_ins1("jmp", IMML_ABS(get_block(block_exit->if_.block_true)->label, 0));
 	} break;
 
 	case BLOCK_EXIT_RETURN:
-		asm_ins0("leave");
-		asm_ins0("ret");
+		codegen_restore_registers();
+		asm_ins0(MN_LEAVE);
+		asm_ins0(MN_RET);
 		break;
 
 	case BLOCK_EXIT_RETURN_ZERO:
-		asm_ins2("xorq", R8(REG_RAX), R8(REG_RAX));
-		asm_ins0("leave");
-		asm_ins0("ret");
+		codegen_restore_registers();
+		asm_ins2(MN_XORQ, R8(REG_RAX), R8(REG_RAX));
+		asm_ins0(MN_LEAVE);
+		asm_ins0(MN_RET);
 		break;
 
-	case BLOCK_EXIT_SWITCH: {
+	case BLOCK_EXIT_SWITCH:
 		asm_comment("SWITCH");
-		var_id control = block_exit->switch_.condition;
-		scalar_to_reg(control, REG_RDI);
-		for (int i = 0; i < block_exit->switch_.labels.size; i++) {
-			asm_ins2("cmpl", IMM(block_exit->switch_.labels.labels[i].value.int_d), R4(REG_RDI));
-			asm_ins1("je", IMML_ABS(get_block(block_exit->switch_.labels.labels[i].block)->label, 0));
-		}
-		if (block_exit->switch_.labels.default_) {
-			asm_ins1("jmp", IMML_ABS(get_block(block_exit->switch_.labels.default_)->label, 0));
-		}
-	} break;
+		codegen_switch(block_exit, next);
+		break;
 
 	case BLOCK_EXIT_NONE:
-		asm_ins0("ud2");
+		asm_ins0(MN_UD2);
 		break;
 	}
 }
 
+static void count_uses(struct function *func) {
+	for (int i = 0; i < func->var_size; i++)
+		use_count[func->vars[i]] = 0;
+
+	for (int i = 0; i < func->size; i++) {
+		struct block *block = get_block(func->blocks[i]);
+		var_id *uses[IR_MAX_USES];
+		for (int j = 0; j < block->size; j++) {
+			struct instruction *ins = block->instructions + j;
+			int n_uses = ir_instruction_uses(ins, uses);
+			for (int k = 0; k < n_uses; k++)
+				use_count[*uses[k]]++;
+
+			// Variables accessed through memory can not be fused.
+			var_id *memory = ir_instruction_memory_operand(ins);
+			if (memory)
+				use_count[*memory] += 2;
+		}
+
+		int n_uses = ir_block_exit_uses(&block->exit, uses);
+		for (int k = 0; k < n_uses; k++)
+			use_count[*uses[k]]++;
+	}
+}
+
 void codegen_function(struct function *func) {
 	int temp_stack_count = 0, perm_stack_count = 0;
 	int max_temp_stack = 0;
 
+	unsigned used_regs = allocate_registers(func);
+
+	count_uses(func);
+
+	saved_registers.size = 0;
+	for (int reg = REG_RBX; reg <= REG_R15; reg++) {
+		if (!(used_regs & (1u << reg)) ||
+			!(reg == REG_RBX || reg >= REG_R12))
+			continue;
+		perm_stack_count += 8;
+		saved_registers.regs[saved_registers.size++] = (struct saved_register) {
+			.reg = reg, .stack_location = perm_stack_count
+		};
+	}
+
 	for (int i = 0; i < func->var_size; i++) {
 		var_id var = func->vars[i];
-		if (get_variable_stack_bucket(var))
+		if (get_variable_stack_bucket(var) || scalar_is_reg(var) || scalar_is_xmm(var))
 			continue;
 
 		int size = get_variable_size(var);
@@ -515,7 +962,7 @@ void codegen_function(struct function *func) {
 
 			if (ins->type == IR_ADD_TEMPORARY) {
 				var_id var = ins->result;
-				if (!get_variable_stack_bucket(var))
+				if (!get_variable_stack_bucket(var) || scalar_is_reg(var) || scalar_is_xmm(var))
 					continue;
 
 				int size = get_variable_size(var);
@@ -538,28 +985,36 @@ void codegen_function(struct function *func) {
 
 	label_id func_label = register_label_name(sv_from_str((char *)func->name));
 	asm_label(func->is_global, func_label);
-	asm_ins1("pushq", R8(REG_RBP));
-	asm_ins2("movq", R8(REG_RSP), R8(REG_RBP));
+	asm_ins1(MN_PUSHQ, R8(REG_RBP));
+	asm_ins2(MN_MOVQ, R8(REG_RSP), R8(REG_RBP));
 
 	int stack_sub = round_up_to_nearest(perm_stack_count + max_temp_stack, 16);
 	if (stack_sub)
-		asm_ins2("subq", IMM(stack_sub), R8(REG_RSP));
+		asm_ins2(MN_SUBQ, IMM(stack_sub), R8(REG_RSP));
+
+	for (int i = 0; i < saved_registers.size; i++)
+		asm_ins2(MN_MOVQ, R8(saved_registers.regs[i].reg),
+				 MEM(-saved_registers.regs[i].stack_location, REG_RBP));
 
 	for (size_t i = 0; i < vla_info.size; i++)
-		asm_ins2("movq", IMM(0), MEM(-variable_info[vla_info.slots[i].slot].stack_location, REG_RBP));
+		asm_ins2(MN_MOVQ, IMM(0), MEM(-variable_info[vla_info.slots[i].slot].stack_location, REG_RBP));
 
 	abi_emit_function_preamble(func);
 
 	for (int i = 0; i < func->size; i++)
-		codegen_block(get_block(func->blocks[i]), func);
+		codegen_block(get_block(func->blocks[i]), func,
+					  i + 1 < func->size ? get_block(func->blocks[i + 1]) : NULL);
 
 	int total_stack_usage = max_temp_stack + perm_stack_count;
 	if (codegen_flags.debug_stack_size && total_stack_usage >= codegen_flags.debug_stack_min)
 		printf("Function %s has stack consumption: %d\n", func->name, total_stack_usage);
+
+	asm_flush();
 }
 
 void codegen(const char *path) {
-	variable_info = malloc(sizeof(*variable_info) * get_n_vars());
+	variable_info = calloc(get_n_vars(), sizeof *variable_info);
+	use_count = calloc(get_n_vars(), sizeof *use_count);
 
 	asm_init_text_out(path);
 
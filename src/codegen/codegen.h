@@ -15,10 +15,13 @@ extern struct codegen_flags {
 struct variable_info {
 	enum {
 		VAR_STOR_NONE,
-		VAR_STOR_STACK
+		VAR_STOR_STACK,
+		VAR_STOR_REG,
+		VAR_STOR_XMM
 	} storage;
 
 	int stack_location;
+	int reg; // Index of the SSE register for VAR_STOR_XMM.
 };
 
 extern struct variable_info *variable_info;
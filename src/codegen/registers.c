@@ -48,46 +48,106 @@ const char *get_reg_name(int id, int size) {
 	return registers[id][size_to_idx(size)];
 }
 
+int scalar_is_reg(var_id scalar) {
+	return variable_info[scalar].storage == VAR_STOR_REG;
+}
+
+int scalar_is_xmm(var_id scalar) {
+	return variable_info[scalar].storage == VAR_STOR_XMM;
+}
+
+struct operand reg_operand(int reg, int size) {
+	switch (size) {
+	case 1: return R1(reg);
+	case 2: return R2(reg);
+	case 4: return R4(reg);
+	case 8: return R8(reg);
+	default: ICE("Invalid register size %d", size);
+	}
+}
+
+struct operand scalar_operand(var_id scalar) {
+	if (scalar_is_reg(scalar))
+		return reg_operand(variable_info[scalar].reg, get_variable_size(scalar));
+	return MEM(-variable_info[scalar].stack_location, REG_RBP);
+}
+
 void scalar_to_reg(var_id scalar, int reg) {
 	int size = get_variable_size(scalar);
+	if (scalar_is_xmm(scalar)) {
+		if (size == 4)
+			asm_ins2(MN_MOVD, XMM(variable_info[scalar].reg), R4(reg));
+		else
+			asm_ins2(MN_MOVQ, XMM(variable_info[scalar].reg), R8(reg));
+		return;
+	}
+
+	if (scalar_is_reg(scalar)) {
+		if (variable_info[scalar].reg != reg)
+			asm_ins2(MN_MOVQ, R8(variable_info[scalar].reg), R8(reg));
+		return;
+	}
+
 	struct operand mem = MEM(-variable_info[scalar].stack_location, REG_RBP);
 	switch (size) {
 	case 1:
-		asm_ins2("xorq", R8(reg), R8(reg));
-		asm_ins2("movb", mem, R1(reg));
+		asm_ins2(MN_XORQ, R8(reg), R8(reg));
+		asm_ins2(MN_MOVB, mem, R1(reg));
 		break;
 	case 2:
-		asm_ins2("xorq", R8(reg), R8(reg));
-		asm_ins2("movw", mem, R2(reg));
+		asm_ins2(MN_XORQ, R8(reg), R8(reg));
+		asm_ins2(MN_MOVW, mem, R2(reg));
 		break;
 	case 4:
-		asm_ins2("movl", mem, R4(reg));
+		asm_ins2(MN_MOVL, mem, R4(reg));
 		break;
 	case 8:
-		asm_ins2("movq", mem, R8(reg));
+		asm_ins2(MN_MOVQ, mem, R8(reg));
 		break;
 	}
 }
 
 void reg_to_scalar(int reg, var_id scalar) {
 	int size = get_variable_size(scalar);
+	if (scalar_is_xmm(scalar)) {
+		if (size == 4)
+			asm_ins2(MN_MOVD, R4(reg), XMM(variable_info[scalar].reg));
+		else
+			asm_ins2(MN_MOVQ, R8(reg), XMM(variable_info[scalar].reg));
+		return;
+	}
+
+	if (scalar_is_reg(scalar)) {
+		int dest = variable_info[scalar].reg;
+		switch (size) {
+		case 1: asm_ins2(MN_MOVZBL, R1(reg), R4(dest)); break;
+		case 2: asm_ins2(MN_MOVZWL, R2(reg), R4(dest)); break;
+		case 4: asm_ins2(MN_MOVL, R4(reg), R4(dest)); break;
+		case 8:
+			if (reg != dest)
+				asm_ins2(MN_MOVQ, R8(reg), R8(dest));
+			break;
+		}
+		return;
+	}
+
 	int msize = 0;
 	for (int i = 0; i < size;) {
 		if (msize)
-			asm_ins2("shrq", IMM(msize * 8), R8(reg));
+			asm_ins2(MN_SHRQ, IMM(msize * 8), R8(reg));
 
 		struct operand mem = MEM(-variable_info[scalar].stack_location + i, REG_RBP);
 		if (i + 8 <= size) {
-			asm_ins2("movq", R8(reg), mem);
+			asm_ins2(MN_MOVQ, R8(reg), mem);
 			msize = 8;
 		} else if (i + 4 <= size) {
-			asm_ins2("movl", R4(reg), mem);
+			asm_ins2(MN_MOVL, R4(reg), mem);
 			msize = 4;
 		} else if (i + 2 <= size) {
-			asm_ins2("movw", R2(reg), mem);
+			asm_ins2(MN_MOVW, R2(reg), mem);
 			msize = 2;
 		} else if (i + 1 <= size) {
-			asm_ins2("movb", R1(reg), mem);
+			asm_ins2(MN_MOVB, R1(reg), mem);
 			msize = 1;
 		}
 
@@ -95,14 +155,56 @@ void reg_to_scalar(int reg, var_id scalar) {
 	}
 }
 
+void scalar_to_xmm(var_id scalar, int xmm) {
+	int size = get_variable_size(scalar);
+	if (scalar_is_xmm(scalar)) {
+		if (variable_info[scalar].reg != xmm)
+			asm_ins2(MN_MOVAPS, XMM(variable_info[scalar].reg), XMM(xmm));
+	} else if (scalar_is_reg(scalar)) {
+		if (size == 4)
+			asm_ins2(MN_MOVD, R4(variable_info[scalar].reg), XMM(xmm));
+		else
+			asm_ins2(MN_MOVQ, R8(variable_info[scalar].reg), XMM(xmm));
+	} else {
+		asm_ins2(size == 4 ? MN_MOVSS : MN_MOVSD,
+				 MEM(-variable_info[scalar].stack_location, REG_RBP), XMM(xmm));
+	}
+}
+
+void xmm_to_scalar(int xmm, var_id scalar) {
+	int size = get_variable_size(scalar);
+	if (scalar_is_xmm(scalar)) {
+		if (variable_info[scalar].reg != xmm)
+			asm_ins2(MN_MOVAPS, XMM(xmm), XMM(variable_info[scalar].reg));
+	} else if (scalar_is_reg(scalar)) {
+		if (size == 4)
+			asm_ins2(MN_MOVD, XMM(xmm), R4(variable_info[scalar].reg));
+		else
+			asm_ins2(MN_MOVQ, XMM(xmm), R8(variable_info[scalar].reg));
+	} else {
+		asm_ins2(size == 4 ? MN_MOVSS : MN_MOVSD,
+				 XMM(xmm), MEM(-variable_info[scalar].stack_location, REG_RBP));
+	}
+}
+
+struct operand scalar_xmm_operand(var_id scalar, int scratch) {
+	if (scalar_is_xmm(scalar))
+		return XMM(variable_info[scalar].reg);
+	if (scalar_is_reg(scalar)) {
+		scalar_to_xmm(scalar, scratch);
+		return XMM(scratch);
+	}
+	return MEM(-variable_info[scalar].stack_location, REG_RBP);
+}
+
 void load_address(struct type *type, var_id result) {
 	if (type_is_pointer(type)) {
-		asm_ins2("movq", MEM(0, REG_RDI), R8(REG_RAX));
+		asm_ins2(MN_MOVQ, MEM(0, REG_RDI), R8(REG_RAX));
 		reg_to_scalar(REG_RAX, result);
 	} else if (type->type == TY_SIMPLE) {
 		switch (type->simple) {
 		case ST_INT:
-			asm_ins2("movl", MEM(0, REG_RDI), R4(REG_RAX));
+			asm_ins2(MN_MOVL, MEM(0, REG_RDI), R4(REG_RAX));
 			reg_to_scalar(REG_RAX, result);
 			break;
 
@@ -117,12 +219,12 @@ void load_address(struct type *type, var_id result) {
 void store_address(struct type *type, var_id result) {
 	if (type_is_pointer(type)) {
 		scalar_to_reg(result, REG_RAX);
-		asm_ins2("movq", R8(REG_RAX), MEM(0, REG_RDI));
+		asm_ins2(MN_MOVQ, R8(REG_RAX), MEM(0, REG_RDI));
 	} else if (type->type == TY_SIMPLE) {
 		switch (type->simple) {
 		case ST_INT:
 			scalar_to_reg(result, REG_RAX);
-			asm_ins2("movl", R4(REG_RAX), MEM(0, REG_RDI));
+			asm_ins2(MN_MOVL, R4(REG_RAX), MEM(0, REG_RDI));
 			break;
 
 		default:
@@ -2,10 +2,25 @@
 #define REGISTERS_H
 
 #include <parser/parser.h>
+#include <assembler/assembler.h>
 
+// Variables allocated to registers always hold their value zero-extended.
 void scalar_to_reg(var_id scalar, int reg);
 void reg_to_scalar(int reg, var_id scalar);
 
+int scalar_is_reg(var_id scalar);
+struct operand reg_operand(int reg, int size);
+// Register or memory operand holding scalar.
+struct operand scalar_operand(var_id scalar);
+
+// Floating point scalars of size 4 or 8 in SSE registers.
+int scalar_is_xmm(var_id scalar);
+void scalar_to_xmm(var_id scalar, int xmm);
+void xmm_to_scalar(int xmm, var_id scalar);
+// SSE register or memory operand holding scalar,
+// scalars in general purpose registers are moved to scratch.
+struct operand scalar_xmm_operand(var_id scalar, int scratch);
+
 char size_to_suffix(int size);
 const char *get_reg_name(int id, int size);
 
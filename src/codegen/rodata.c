@@ -2,8 +2,10 @@
 #include "codegen.h"
 
 #include <common.h>
+#include <hash_table.h>
 #include <arch/x64.h>
 #include <parser/expression.h>
+#include <parser/parser.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -23,13 +25,27 @@ struct entry {
 static struct entry *entries = NULL;
 static int entries_size = 0, entries_cap = 0;
 
+// Maps (type, name) to the index of the entry, plus one since the
+// values can not be NULL. String literals are not interned.
+static struct hash_table entry_map = { .name = "labels" };
+
+struct entry_key {
+	enum entry_type type;
+	struct string_view name;
+};
+
+static int entry_equal(const void *value, const void *key) {
+	const struct entry *entry = entries + ((intptr_t)value - 1);
+	const struct entry_key *k = key;
+	return entry->type == k->type && sv_cmp(entry->name, k->name);
+}
+
 label_id label_register(enum entry_type type, struct string_view str) {
-	for (int i = 0; i < entries_size; i++) {
-		if (sv_cmp(entries[i].name, str) &&
-			entries[i].type == type) {
-			return entries[i].id;
-		}
-	}
+	struct entry_key key = { type, str };
+	uint32_t hash = sv_hash(str) ^ type;
+	intptr_t idx = (intptr_t)hash_table_get(&entry_map, hash, entry_equal, &key);
+	if (idx)
+		return entries[idx - 1].id;
 
 	int id = entries_size;
 	ADD_ELEMENT(entries_size, entries_cap, entries) = (struct entry) {
@@ -37,6 +53,7 @@ label_id label_register(enum entry_type type, struct string_view str) {
 		.name = str,
 		.id = id
 	};
+	hash_table_set(&entry_map, hash, entry_equal, &key, (void *)(intptr_t)entries_size);
 
 	return id;
 }
@@ -61,6 +78,99 @@ void rodata_get_label(label_id id, int n, char buffer[]) {
 		ICE("Label name too long");
 }
 
+struct image {
+	label_id label;
+
+	// If data is NULL, the image is generated from the initializer.
+	struct type *type;
+	struct initializer init;
+
+	uint8_t *data;
+	int size;
+};
+
+static struct image *images = NULL;
+static int images_size, images_cap;
+
+// The image is generated after the declaration is released, so the
+// expressions, which are all constants, are moved to the static arena.
+static void keep_initializer(struct initializer *init) {
+	if (init->type == INIT_EXPRESSION)
+		init->expr = (struct expr *)arena_copy(&static_ast_arena, init->expr, sizeof *init->expr);
+	else if (init->type == INIT_BRACE)
+		for (int i = 0; i < init->brace.size; i++)
+			keep_initializer(init->brace.entries + i);
+}
+
+label_id rodata_register_initializer(struct type *type, struct initializer init) {
+	label_id label = register_label();
+	keep_initializer(&init);
+	ADD_ELEMENT(images_size, images_cap, images) = (struct image) {
+		.label = label,
+		.type = type,
+		.init = init
+	};
+	return label;
+}
+
+label_id rodata_register_data(const uint8_t *data, int size) {
+	label_id label = register_label();
+	uint8_t *copy = malloc(size);
+	memcpy(copy, data, size);
+	ADD_ELEMENT(images_size, images_cap, images) = (struct image) {
+		.label = label,
+		.data = copy,
+		.size = size
+	};
+	return label;
+}
+
+static struct pool_constant {
+	label_id label;
+	uint64_t value;
+	int size;
+} *pool = NULL;
+static int pool_size, pool_cap;
+
+// Maps (value, size) to the index of the constant, plus one.
+static struct hash_table pool_map = { .name = "constants" };
+
+static int pool_equal(const void *value, const void *key) {
+	const struct pool_constant *constant = pool + ((intptr_t)value - 1);
+	const struct pool_constant *k = key;
+	return constant->value == k->value && constant->size == k->size;
+}
+
+label_id rodata_register_constant(uint64_t value, int size) {
+	struct pool_constant key = { .value = value, .size = size };
+	uint32_t hash = hash32((uint32_t)value ^ (uint32_t)(value >> 32)) ^ size;
+	intptr_t idx = (intptr_t)hash_table_get(&pool_map, hash, pool_equal, &key);
+	if (idx)
+		return pool[idx - 1].label;
+
+	key.label = register_label();
+	ADD_ELEMENT(pool_size, pool_cap, pool) = key;
+	hash_table_set(&pool_map, hash, pool_equal, &key, (void *)(intptr_t)pool_size);
+	return key.label;
+}
+
+void codegen_initializer(struct type *type, struct initializer *init);
+
+static void codegen_image(struct image *image) {
+	asm_label(0, image->label);
+
+	if (!image->data) {
+		codegen_initializer(image->type, &image->init);
+		return;
+	}
+
+	int i = 0;
+	for (; i + 8 <= image->size; i += 8)
+		asm_quad(IMM_ABS(*(uint64_t *)(image->data + i)));
+	for (; i < image->size; i++)
+		asm_byte(IMM_ABS(image->data[i]));
+}
+
 void rodata_codegen(void) {
 	for (int i = 0; i < entries_size; i++) {
 		if (entries[i].type != ENTRY_STR)
@@ -70,6 +180,23 @@ void rodata_codegen(void) {
 
 		asm_string(entries[i].name);
 	}
+
+	if (!images_size && !pool_size)
+		return;
+
+	asm_section(".rodata");
+	for (int i = 0; i < images_size; i++)
+		codegen_image(images + i);
+
+	for (int i = 0; i < pool_size; i++) {
+		asm_label(0, pool[i].label);
+		if (pool[i].size == 8)
+			asm_quad(IMM_ABS(pool[i].value));
+		else
+			for (int j = 0; j < pool[i].size; j++)
+				asm_byte(IMM_ABS((pool[i].value >> (j * 8)) & 0xff));
+	}
+	asm_section(".text");
 }
 
 label_id register_label_name(struct string_view str) {
@@ -3,6 +3,8 @@
 
 #include <string_view.h>
 
+#include <stdint.h>
+
 typedef int label_id;
 
 label_id rodata_register(struct string_view str);
@@ -18,4 +20,12 @@ struct initializer;
 void data_register_static_var(struct string_view label, struct type *type, struct initializer init, int global);
 void data_codegen(void);
 
+// Constant images in .rodata, used for copying into local variables.
+// The initializer may only contain constant expressions.
+label_id rodata_register_initializer(struct type *type, struct initializer init);
+label_id rodata_register_data(const uint8_t *data, int size);
+
+// Scalar constant in the constant pool, equal values share a label.
+label_id rodata_register_constant(uint64_t value, int size);
+
 #endif
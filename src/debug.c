@@ -140,6 +140,12 @@ const char *dbg_instruction(struct instruction ins) {
 		DBG_PRINT("%d = load %d relative to base", ins.result, ins.load_base_relative.offset);
 		break;
 
+	case IR_PHI:
+		DBG_PRINT("%d = phi", ins.result);
+		for (int i = 0; i < ins.phi.size; i++)
+			DBG_PRINT(" [%d, block %d]", ins.phi.vars[i], ins.phi.blocks[i]);
+		break;
+
 	case IR_STORE:
 		DBG_PRINT("store %d into %d", ins.store.value, ins.store.pointer);
 		break;
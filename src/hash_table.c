@@ -0,0 +1,106 @@
+#include "hash_table.h"
+#include "common.h"
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#define INITIAL_CAP 64
+
+// All tables that have been used, for the statistics.
+static struct hash_table *tables;
+
+// The hashes are mixed again, as the low bits of the hashes given by the
+// callers are not always well distributed. Slots store the mixed hash.
+static struct hash_slot *find(struct hash_table *table, uint32_t hash, hash_equal equal, const void *key) {
+	hash = hash32(hash);
+	size_t mask = table->cap - 1, idx = hash & mask;
+	uint64_t probes = 1;
+
+	while (table->slots[idx].value &&
+		   !(table->slots[idx].hash == hash && equal(table->slots[idx].value, key))) {
+		idx = (idx + 1) & mask;
+		probes++;
+	}
+
+	table->lookups++;
+	table->probes += probes;
+	if (probes > table->max_probes)
+		table->max_probes = probes;
+
+	return table->slots + idx;
+}
+
+static void grow(struct hash_table *table) {
+	struct hash_slot *old = table->slots;
+	size_t old_cap = table->cap;
+
+	if (!old) {
+		table->next = tables;
+		tables = table;
+	}
+
+	table->cap = old_cap ? old_cap * 2 : INITIAL_CAP;
+	table->slots = calloc(table->cap, sizeof *table->slots);
+
+	size_t mask = table->cap - 1;
+	for (size_t i = 0; i < old_cap; i++) {
+		if (!old[i].value)
+			continue;
+		size_t idx = old[i].hash & mask;
+		while (table->slots[idx].value)
+			idx = (idx + 1) & mask;
+		table->slots[idx] = old[i];
+	}
+
+	free(old);
+}
+
+void *hash_table_get(struct hash_table *table, uint32_t hash, hash_equal equal, const void *key) {
+	if (!table->cap)
+		return NULL;
+	return find(table, hash, equal, key)->value;
+}
+
+void hash_table_set(struct hash_table *table, uint32_t hash, hash_equal equal, const void *key, void *value) {
+	if ((table->size + 1) * 2 > table->cap)
+		grow(table);
+
+	struct hash_slot *slot = find(table, hash, equal, key);
+	if (!slot->value)
+		table->size++;
+
+	slot->hash = hash32(hash);
+	slot->value = value;
+}
+
+// Slots after the removed one are moved back, such that no
+// probe sequence passes an empty slot.
+void hash_table_remove(struct hash_table *table, uint32_t hash, hash_equal equal, const void *key) {
+	if (!table->cap)
+		return;
+
+	struct hash_slot *slot = find(table, hash, equal, key);
+	if (!slot->value)
+		return;
+
+	size_t mask = table->cap - 1, hole = slot - table->slots;
+	for (size_t idx = (hole + 1) & mask; table->slots[idx].value; idx = (idx + 1) & mask) {
+		size_t home = table->slots[idx].hash & mask;
+		// Move the slot if its home is not cyclically in (hole, idx].
+		if (((idx - home) & mask) >= ((idx - hole) & mask)) {
+			table->slots[hole] = table->slots[idx];
+			hole = idx;
+		}
+	}
+
+	table->slots[hole] = (struct hash_slot) { 0 };
+	table->size--;
+}
+
+void hash_table_print_stats(void) {
+	for (struct hash_table *it = tables; it; it = it->next) {
+		printf("%-10s %8zu entries %8zu slots %10" PRIu64 " lookups %6.2f average probes %6" PRIu64 " max probes\n",
+			   it->name, it->size, it->cap, it->lookups,
+			   it->lookups ? (double)it->probes / it->lookups : 0.0, it->max_probes);
+	}
+}
@@ -0,0 +1,33 @@
+#ifndef HASH_TABLE_H
+#define HASH_TABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Open addressed hash table with linear probing, that grows to keep the
+// load factor at most 1/2. Values are non-NULL pointers, the keys are not
+// stored and are instead compared to the values with a callback.
+struct hash_table {
+	const char *name;
+
+	size_t size, cap;
+	struct hash_slot {
+		uint32_t hash;
+		void *value;
+	} *slots;
+
+	// Statistics, printed with -dhash-stats.
+	uint64_t lookups, probes, max_probes;
+	struct hash_table *next;
+};
+
+typedef int (*hash_equal)(const void *value, const void *key);
+
+void *hash_table_get(struct hash_table *table, uint32_t hash, hash_equal equal, const void *key);
+// Inserts value, or replaces the value equal to key.
+void hash_table_set(struct hash_table *table, uint32_t hash, hash_equal equal, const void *key, void *value);
+void hash_table_remove(struct hash_table *table, uint32_t hash, hash_equal equal, const void *key);
+
+void hash_table_print_stats(void);
+
+#endif
@@ -0,0 +1,364 @@
+#include "dce.h"
+#include "dominators.h"
+
+#include <common.h>
+#include <types.h>
+
+#include <string.h>
+
+static int *var_index = NULL;
+static int var_index_size = 0;
+
+static void index_variables(struct function *func) {
+	if (var_index_size < get_n_vars()) {
+		var_index = realloc(var_index, sizeof *var_index * get_n_vars());
+		for (int i = var_index_size; i < get_n_vars(); i++)
+			var_index[i] = -1;
+		var_index_size = get_n_vars();
+	}
+
+	for (int i = 0; i < func->var_size; i++)
+		var_index[func->vars[i]] = i;
+}
+
+static void clear_variables(struct function *func) {
+	for (int i = 0; i < func->var_size; i++)
+		var_index[func->vars[i]] = -1;
+}
+
+static int get_index(var_id var) {
+	return var < var_index_size ? var_index[var] : -1;
+}
+
+// Remove phi operands from blocks that are no longer predecessors.
+static void update_phis(struct function *func) {
+	struct cfg cfg;
+	cfg_compute(&cfg, func);
+
+	for (int i = 0; i < func->size; i++) {
+		struct block *block = get_block(func->blocks[i]);
+		struct cfg_node *node = cfg.nodes + i;
+		for (int j = 0; j < block->size; j++) {
+			struct instruction *ins = block->instructions + j;
+			if (ins->type != IR_PHI)
+				continue;
+
+			int n = 0;
+			for (int k = 0; k < ins->phi.size; k++) {
+				int pred = cfg_index(&cfg, ins->phi.blocks[k]), is_pred = 0;
+				for (size_t l = 0; pred != -1 && l < node->pred_size; l++)
+					is_pred |= node->preds[l] == pred;
+				if (!is_pred)
+					continue;
+				ins->phi.vars[n] = ins->phi.vars[k];
+				ins->phi.blocks[n] = ins->phi.blocks[k];
+				n++;
+			}
+			ins->phi.size = n;
+		}
+	}
+
+	cfg_free(&cfg);
+}
+
+void remove_unreachable_blocks(struct function *func) {
+	if (!func->size)
+		return;
+
+	struct cfg cfg;
+	cfg_compute(&cfg, func);
+
+	int n = 0;
+	for (int i = 0; i < func->size; i++) {
+		struct block *block = get_block(func->blocks[i]);
+		if (cfg.nodes[i].idom != -1) {
+			func->blocks[n++] = func->blocks[i];
+			continue;
+		}
+
+		// Temporaries might still be referenced by other blocks,
+		// so they have to keep a stack slot.
+		for (int j = 0; j < block->size; j++) {
+			struct instruction *ins = block->instructions + j;
+			if (ins->type == IR_ADD_TEMPORARY)
+				variable_set_stack_bucket(ins->result, 0);
+			else if (ins->type == IR_PHI) {
+				free(ins->phi.vars);
+				free(ins->phi.blocks);
+			}
+		}
+	}
+
+	int removed = n != func->size;
+	func->size = n;
+	cfg_free(&cfg);
+
+	if (removed)
+		update_phis(func);
+}
+
+static int is_pure(struct instruction *ins) {
+	switch (ins->type) {
+	case IR_BINARY_OPERATOR: case IR_NEGATE_INT: case IR_NEGATE_FLOAT:
+	case IR_BINARY_NOT: case IR_ADDRESS_OF: case IR_CONSTANT: case IR_COPY:
+	case IR_BOOL_CAST: case IR_INT_CAST: case IR_FLOAT_CAST:
+	case IR_INT_FLOAT_CAST: case IR_PHI:
+		return 1;
+	case IR_GET_REG:
+		return !ins->get_reg.is_ssa;
+	default:
+		// Loads are kept, as volatile is not visible in the IR.
+		return 0;
+	}
+}
+
+static void count_uses(struct instruction *ins, int *use_count, int change) {
+	var_id *uses[IR_MAX_USES];
+	int n_uses = ir_instruction_uses(ins, uses);
+	for (int i = 0; i < n_uses; i++) {
+		int idx = get_index(*uses[i]);
+		if (idx != -1)
+			use_count[idx] += change;
+	}
+
+	if (ins->type == IR_PHI) {
+		for (int i = 0; i < ins->phi.size; i++) {
+			int idx = get_index(ins->phi.vars[i]);
+			if (idx != -1)
+				use_count[idx] += change;
+		}
+	}
+}
+
+void dead_code_elimination(struct function *func) {
+	index_variables(func);
+
+	int *use_count = calloc(func->var_size + 1, sizeof *use_count);
+	int *is_memory = calloc(func->var_size + 1, sizeof *is_memory);
+
+	for (int i = 0; i < func->size; i++) {
+		struct block *block = get_block(func->blocks[i]);
+		for (int j = 0; j < block->size; j++) {
+			struct instruction *ins = block->instructions + j;
+			count_uses(ins, use_count, 1);
+
+			var_id *memory = ir_instruction_memory_operand(ins);
+			if (memory && get_index(*memory) != -1)
+				is_memory[get_index(*memory)] = 1;
+		}
+
+		var_id *uses[IR_MAX_USES];
+		int n_uses = ir_block_exit_uses(&block->exit, uses);
+		for (int j = 0; j < n_uses; j++) {
+			int idx = get_index(*uses[j]);
+			if (idx != -1)
+				use_count[idx]++;
+		}
+	}
+
+	// Instructions are visited backwards, such that chains of
+	// dead instructions within a block are removed in one sweep.
+	int changed = 1;
+	while (changed) {
+		changed = 0;
+		for (int i = func->size - 1; i >= 0; i--) {
+			struct block *block = get_block(func->blocks[i]);
+			int n = block->size;
+			for (int j = block->size - 1; j >= 0; j--) {
+				struct instruction *ins = block->instructions + j;
+				var_id *def = ir_instruction_def(ins);
+				int idx = def ? get_index(*def) : -1;
+				if (!is_pure(ins) || idx == -1 || use_count[idx] || is_memory[idx])
+					continue;
+
+				count_uses(ins, use_count, -1);
+				if (ins->type == IR_PHI) {
+					free(ins->phi.vars);
+					free(ins->phi.blocks);
+				}
+				ins->type = IR_TYPE_COUNT;
+				n--;
+				changed = 1;
+			}
+
+			if (n == block->size)
+				continue;
+
+			n = 0;
+			for (int j = 0; j < block->size; j++)
+				if (block->instructions[j].type != IR_TYPE_COUNT)
+					block->instructions[n++] = block->instructions[j];
+			block->size = n;
+		}
+	}
+
+	free(use_count);
+	free(is_memory);
+	clear_variables(func);
+}
+
+// Dead store elimination for IR_SET_ZERO. Aggregates that are fully
+// initialized by stores later in the same block do not need to be zeroed.
+
+static struct instruction **definition;
+
+struct address {
+	var_id var;
+	int64_t offset;
+};
+
+static int get_constant(var_id var, int64_t *value) {
+	int idx = get_index(var);
+	struct instruction *def = idx == -1 ? NULL : definition[idx];
+	if (!def || def->type != IR_CONSTANT ||
+		def->constant.constant.type != CONSTANT_TYPE ||
+		!(type_is_integer(def->constant.constant.data_type) ||
+		  type_is_pointer(def->constant.constant.data_type)))
+		return 0;
+	*value = constant_to_u64(def->constant.constant);
+	return 1;
+}
+
+// Find out which variable, and offset into it, that pointer points to.
+static int resolve_address(var_id pointer, struct address *address) {
+	for (int depth = 0; depth < 64; depth++) {
+		int idx = get_index(pointer);
+		struct instruction *def = idx == -1 ? NULL : definition[idx];
+		if (!def)
+			return 0;
+
+		int64_t value;
+		switch (def->type) {
+		case IR_ADDRESS_OF:
+			address->var = def->address_of.variable;
+			return 1;
+		case IR_COPY:
+			pointer = def->copy.source;
+			break;
+		case IR_BINARY_OPERATOR:
+			if (def->binary_operator.type != IBO_ADD)
+				return 0;
+			if (get_constant(def->binary_operator.rhs, &value)) {
+				pointer = def->binary_operator.lhs;
+			} else if (get_constant(def->binary_operator.lhs, &value)) {
+				pointer = def->binary_operator.rhs;
+			} else {
+				return 0;
+			}
+			address->offset += value;
+			break;
+		default:
+			return 0;
+		}
+	}
+	return 0;
+}
+
+#define MAX_ZERO_SIZE 4096
+
+static int is_fully_overwritten(struct block *block, int start, var_id var) {
+	int size = get_variable_size(var);
+	if (size > MAX_ZERO_SIZE)
+		return 0;
+
+	static uint8_t covered[MAX_ZERO_SIZE];
+	memset(covered, 0, size);
+	int n_covered = 0;
+
+	for (int i = start + 1; i < block->size; i++) {
+		struct instruction *ins = block->instructions + i;
+		var_id *uses[IR_MAX_USES];
+		int n_uses = ir_instruction_uses(ins, uses);
+		struct address address = { 0 };
+
+		switch (ins->type) {
+		case IR_STORE: {
+			if (ins->store.value == var)
+				return 0;
+			if (!resolve_address(ins->store.pointer, &address) || address.var != var)
+				break;
+
+			int store_size = get_variable_size(ins->store.value);
+			if (address.offset < 0 || address.offset + store_size > size)
+				return 0;
+
+			for (int j = 0; j < store_size; j++) {
+				if (!covered[address.offset + j]) {
+					covered[address.offset + j] = 1;
+					n_covered++;
+				}
+			}
+
+			if (n_covered == size)
+				return 1;
+		} break;
+
+		case IR_LOAD:
+			// Only loads of other variables are allowed.
+			if (!resolve_address(ins->load.pointer, &address) || address.var == var)
+				return 0;
+			break;
+
+		case IR_ADDRESS_OF: case IR_CONSTANT: case IR_BINARY_OPERATOR:
+		case IR_NEGATE_INT: case IR_NEGATE_FLOAT: case IR_BINARY_NOT:
+		case IR_COPY: case IR_BOOL_CAST: case IR_INT_CAST: case IR_FLOAT_CAST:
+		case IR_INT_FLOAT_CAST: case IR_ADD_TEMPORARY: case IR_CLEAR_STACK_BUCKET:
+			for (int j = 0; j < n_uses; j++)
+				if (*uses[j] == var)
+					return 0;
+			break;
+
+		default:
+			return 0;
+		}
+	}
+
+	return 0;
+}
+
+void remove_dead_zeroing(struct function *func) {
+	index_variables(func);
+
+	definition = calloc(func->var_size + 1, sizeof *definition);
+	int *n_defs = calloc(func->var_size + 1, sizeof *n_defs);
+
+	for (int i = 0; i < func->size; i++) {
+		struct block *block = get_block(func->blocks[i]);
+		for (int j = 0; j < block->size; j++) {
+			var_id *def = ir_instruction_def(block->instructions + j);
+			int idx = def ? get_index(*def) : -1;
+			if (idx == -1)
+				continue;
+			definition[idx] = block->instructions + j;
+			n_defs[idx]++;
+		}
+	}
+
+	// Variables defined more than once can not be followed.
+	for (int i = 0; i < func->var_size; i++)
+		if (n_defs[i] != 1)
+			definition[i] = NULL;
+
+	for (int i = 0; i < func->size; i++) {
+		struct block *block = get_block(func->blocks[i]);
+		for (int j = 0; j < block->size; j++) {
+			struct instruction *ins = block->instructions + j;
+			if (ins->type == IR_SET_ZERO && is_fully_overwritten(block, j, ins->result))
+				ins->type = IR_TYPE_COUNT;
+		}
+	}
+
+	// Removed after all blocks are handled, as definition points into the blocks.
+	for (int i = 0; i < func->size; i++) {
+		struct block *block = get_block(func->blocks[i]);
+		int n = 0;
+		for (int j = 0; j < block->size; j++)
+			if (block->instructions[j].type != IR_TYPE_COUNT)
+				block->instructions[n++] = block->instructions[j];
+		block->size = n;
+	}
+
+	free(definition);
+	free(n_defs);
+	clear_variables(func);
+}
@@ -0,0 +1,17 @@
+#ifndef DCE_H
+#define DCE_H
+
+#include "ir.h"
+
+// Remove blocks that can not be reached from the entry block.
+void remove_unreachable_blocks(struct function *func);
+
+// Remove instructions without side effects whose results are never used.
+// Requires SSA form.
+void dead_code_elimination(struct function *func);
+
+// Remove IR_SET_ZERO of variables that are completely overwritten
+// by stores before being read.
+void remove_dead_zeroing(struct function *func);
+
+#endif
@@ -0,0 +1,219 @@
+#include "dominators.h"
+
+#include <common.h>
+
+#include <string.h>
+
+int cfg_index(struct cfg *cfg, block_id block) {
+	return block < cfg->index_size ? cfg->index[block] : -1;
+}
+
+int cfg_dominates(struct cfg *cfg, int a, int b) {
+	struct cfg_node *na = cfg->nodes + a, *nb = cfg->nodes + b;
+	if (na->idom == -1 || nb->idom == -1)
+		return 0;
+	return na->pre <= nb->pre && nb->post <= na->post;
+}
+
+static void add_edges(struct cfg *cfg, struct function *func) {
+	int max_id = 0;
+	for (int i = 0; i < func->size; i++)
+		max_id = MAX(max_id, func->blocks[i]);
+
+	cfg->index_size = max_id + 1;
+	cfg->index = malloc(sizeof *cfg->index * cfg->index_size);
+	for (int i = 0; i < cfg->index_size; i++)
+		cfg->index[i] = -1;
+	for (int i = 0; i < func->size; i++)
+		cfg->index[func->blocks[i]] = i;
+
+	for (int i = 0; i < func->size; i++) {
+		block_id *successors;
+		int n = ir_block_successors(func, i, &successors);
+		struct cfg_node *node = cfg->nodes + i;
+		for (int j = 0; j < n; j++) {
+			int idx = cfg_index(cfg, successors[j]);
+			if (idx == -1)
+				ICE("Jump to block not in function.");
+
+			int duplicate = 0;
+			for (size_t k = 0; k < node->succ_size; k++)
+				duplicate |= node->succs[k] == idx;
+			if (!duplicate)
+				ADD_ELEMENT(node->succ_size, node->succ_cap, node->succs) = idx;
+		}
+	}
+}
+
+static void compute_order(struct cfg *cfg) {
+	// Iterative depth first search, giving postorder.
+	int *visited = calloc(cfg->size, sizeof *visited);
+	int *stack = malloc(sizeof *stack * cfg->size),
+		*next_child = malloc(sizeof *next_child * cfg->size);
+	int *postorder = malloc(sizeof *postorder * cfg->size);
+	int stack_size = 0, post_size = 0;
+
+	if (cfg->size) {
+		stack[stack_size++] = 0;
+		next_child[0] = 0;
+		visited[0] = 1;
+	}
+
+	while (stack_size) {
+		int top = stack[stack_size - 1];
+		struct cfg_node *node = cfg->nodes + top;
+		if ((size_t)next_child[top] < node->succ_size) {
+			int succ = node->succs[next_child[top]++];
+			if (!visited[succ]) {
+				visited[succ] = 1;
+				next_child[succ] = 0;
+				stack[stack_size++] = succ;
+			}
+		} else {
+			postorder[post_size++] = top;
+			stack_size--;
+		}
+	}
+
+	cfg->order_size = post_size;
+	cfg->order = malloc(sizeof *cfg->order * (post_size + 1));
+	for (int i = 0; i < post_size; i++) {
+		cfg->order[i] = postorder[post_size - 1 - i];
+		cfg->nodes[cfg->order[i]].rpo = i;
+	}
+
+	free(visited);
+	free(stack);
+	free(next_child);
+	free(postorder);
+}
+
+static int intersect(struct cfg *cfg, int a, int b) {
+	while (a != b) {
+		while (cfg->nodes[a].rpo > cfg->nodes[b].rpo)
+			a = cfg->nodes[a].idom;
+		while (cfg->nodes[b].rpo > cfg->nodes[a].rpo)
+			b = cfg->nodes[b].idom;
+	}
+	return a;
+}
+
+// "A Simple, Fast Dominance Algorithm" by Cooper, Harvey and Kennedy.
+static void compute_idom(struct cfg *cfg) {
+	if (!cfg->order_size)
+		return;
+
+	cfg->nodes[0].idom = 0;
+
+	int changed = 1;
+	while (changed) {
+		changed = 0;
+		for (int i = 1; i < cfg->order_size; i++) {
+			struct cfg_node *node = cfg->nodes + cfg->order[i];
+			int new_idom = -1;
+			for (size_t j = 0; j < node->pred_size; j++) {
+				int pred = node->preds[j];
+				if (cfg->nodes[pred].idom == -1)
+					continue;
+				new_idom = new_idom == -1 ? pred : intersect(cfg, pred, new_idom);
+			}
+
+			if (new_idom != node->idom) {
+				node->idom = new_idom;
+				changed = 1;
+			}
+		}
+	}
+}
+
+static void compute_tree(struct cfg *cfg) {
+	for (int i = 1; i < cfg->order_size; i++) {
+		int idx = cfg->order[i];
+		struct cfg_node *parent = cfg->nodes + cfg->nodes[idx].idom;
+		ADD_ELEMENT(parent->child_size, parent->child_cap, parent->children) = idx;
+	}
+
+	if (!cfg->order_size)
+		return;
+
+	int *stack = malloc(sizeof *stack * cfg->order_size),
+		*next_child = malloc(sizeof *next_child * cfg->size);
+	int stack_size = 0, counter = 0;
+
+	stack[stack_size++] = 0;
+	next_child[0] = 0;
+	cfg->nodes[0].pre = counter++;
+
+	while (stack_size) {
+		int top = stack[stack_size - 1];
+		struct cfg_node *node = cfg->nodes + top;
+		if ((size_t)next_child[top] < node->child_size) {
+			int child = node->children[next_child[top]++];
+			next_child[child] = 0;
+			cfg->nodes[child].pre = counter++;
+			stack[stack_size++] = child;
+		} else {
+			node->post = counter++;
+			stack_size--;
+		}
+	}
+
+	free(stack);
+	free(next_child);
+}
+
+static void compute_frontier(struct cfg *cfg) {
+	for (int i = 0; i < cfg->order_size; i++) {
+		int idx = cfg->order[i];
+		struct cfg_node *node = cfg->nodes + idx;
+		if (node->pred_size < 2)
+			continue;
+
+		for (size_t j = 0; j < node->pred_size; j++) {
+			int runner = node->preds[j];
+			while (runner != node->idom) {
+				struct cfg_node *r = cfg->nodes + runner;
+				if (!r->frontier_size || r->frontier[r->frontier_size - 1] != idx)
+					ADD_ELEMENT(r->frontier_size, r->frontier_cap, r->frontier) = idx;
+				runner = r->idom;
+			}
+		}
+	}
+}
+
+void cfg_compute(struct cfg *cfg, struct function *func) {
+	*cfg = (struct cfg) { .size = func->size };
+	cfg->nodes = calloc(func->size + 1, sizeof *cfg->nodes);
+	for (int i = 0; i < func->size; i++)
+		cfg->nodes[i].idom = -1;
+
+	add_edges(cfg, func);
+	compute_order(cfg);
+
+	for (int i = 0; i < cfg->order_size; i++) {
+		int idx = cfg->order[i];
+		struct cfg_node *node = cfg->nodes + idx;
+		for (size_t j = 0; j < node->succ_size; j++) {
+			struct cfg_node *succ = cfg->nodes + node->succs[j];
+			ADD_ELEMENT(succ->pred_size, succ->pred_cap, succ->preds) = idx;
+		}
+	}
+
+	compute_idom(cfg);
+	compute_tree(cfg);
+	compute_frontier(cfg);
+}
+
+void cfg_free(struct cfg *cfg) {
+	for (int i = 0; i < cfg->size; i++) {
+		struct cfg_node *node = cfg->nodes + i;
+		free(node->succs);
+		free(node->preds);
+		free(node->children);
+		free(node->frontier);
+	}
+	free(cfg->nodes);
+	free(cfg->order);
+	free(cfg->index);
+	*cfg = (struct cfg) { 0 };
+}
@@ -0,0 +1,46 @@
+#ifndef DOMINATORS_H
+#define DOMINATORS_H
+
+#include "ir.h"
+
+#include <stddef.h>
+
+// Blocks are referred to by their index in func->blocks.
+struct cfg_node {
+	int idom; // -1 if unreachable, the entry is its own dominator.
+	int rpo; // Position in reverse postorder.
+	int pre, post; // Numbering of the dominator tree.
+
+	size_t succ_size, succ_cap;
+	int *succs;
+
+	// Only reachable predecessors are included.
+	size_t pred_size, pred_cap;
+	int *preds;
+
+	size_t child_size, child_cap;
+	int *children;
+
+	size_t frontier_size, frontier_cap;
+	int *frontier;
+};
+
+struct cfg {
+	int size;
+	struct cfg_node *nodes;
+
+	// Reachable blocks in reverse postorder.
+	int order_size;
+	int *order;
+
+	int index_size;
+	int *index;
+};
+
+void cfg_compute(struct cfg *cfg, struct function *func);
+void cfg_free(struct cfg *cfg);
+
+int cfg_index(struct cfg *cfg, block_id block);
+int cfg_dominates(struct cfg *cfg, int a, int b);
+
+#endif
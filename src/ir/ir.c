@@ -8,6 +8,7 @@
 #include <abi/abi.h>
 
 #include <assert.h>
+#include <string.h>
 
 static size_t block_size, block_cap;
 static struct block *blocks;
@@ -152,6 +153,54 @@ void ir_get_bits(var_id result, var_id field, int offset, int length, int sign_e
 	IR_PUSH_INT_CAST(result, field_large, 0);
 }
 
+static int constant_is_zero_bits(struct constant *c) {
+	if (!c || c->type != CONSTANT_TYPE)
+		return 0;
+
+	int size = calculate_size(c->data_type);
+	uint8_t buffer[size];
+	memset(buffer, 0, size);
+	constant_to_buffer(buffer, *c, 0, -1);
+	for (int i = 0; i < size; i++)
+		if (buffer[i])
+			return 0;
+	return 1;
+}
+
+// Number of non-zero values in init, or -1 if it is not constant.
+static int count_constant_stores(struct initializer *init) {
+	switch (init->type) {
+	case INIT_BRACE: {
+		int count = 0;
+		for (int i = 0; i < init->brace.size; i++) {
+			int child = count_constant_stores(init->brace.entries + i);
+			if (child == -1)
+				return -1;
+			count += child;
+		}
+		return count;
+	}
+
+	case INIT_EXPRESSION: {
+		// CONSTANT_LABEL is the value of a global variable, not a constant.
+		struct constant *c = expression_to_constant(init->expr);
+		if (!c || c->type == CONSTANT_LABEL)
+			return -1;
+		return !constant_is_zero_bits(c);
+	}
+
+	case INIT_STRING: {
+		int count = 0;
+		for (int i = 0; i < init->string.len; i++)
+			count += init->string.str[i] != 0;
+		return count;
+	}
+
+	default:
+		return 0;
+	}
+}
+
 static void ir_init_var_recursive(struct initializer *init, struct type *type, var_id offset,
 								  int bit_offset, int bit_size) {
 	switch (init->type) {
@@ -176,6 +225,10 @@ static void ir_init_var_recursive(struct initializer *init, struct type *type, v
 	} break;
 
 	case INIT_EXPRESSION:
+		// The variable has already been zeroed.
+		if (constant_is_zero_bits(expression_to_constant(init->expr)))
+			break;
+
 		if (bit_size == -1) {
 			IR_PUSH_STORE(expression_to_ir(init->expr), offset);
 		} else {
@@ -193,6 +246,8 @@ static void ir_init_var_recursive(struct initializer *init, struct type *type, v
 		var_id offset_var = new_variable(type_pointer(type_simple(ST_VOID)), 1, 1);
 		var_id char_var = new_variable_sz(1, 1, 1);
 		for (int j = 0; j < init->string.len; j++) {
+			if (!init->string.str[j])
+				continue;
 			IR_PUSH_CONSTANT(constant_simple_unsigned(ST_CHAR, init->string.str[j]), char_var);
 			IR_PUSH_CONSTANT(constant_simple_unsigned(abi_info.size_type, j), offset_var);
 			IR_PUSH_BINARY_OPERATOR(IBO_ADD, offset, offset_var, offset_var);
@@ -205,7 +260,24 @@ static void ir_init_var_recursive(struct initializer *init, struct type *type, v
 	}
 }
 
+// Dense constant initializers are copied from an image in .rodata.
+// Others zero the variable, and store the non-zero values.
+#define IMAGE_MIN_STORES 4
+#define IMAGE_MIN_DENSITY 8 // At least one non-zero value per this many bytes.
+
 void ir_init_var(struct initializer *init, struct type *type, var_id result) {
+	int n_stores = count_constant_stores(init);
+	if (n_stores >= IMAGE_MIN_STORES &&
+		n_stores * IMAGE_MIN_DENSITY >= calculate_size(type)) {
+		struct constant c = {
+			.type = CONSTANT_LABEL,
+			.data_type = type,
+			.label = { rodata_register_initializer(type, *init), 0 }
+		};
+		IR_PUSH_CONSTANT(c, result);
+		return;
+	}
+
 	IR_PUSH_SET_ZERO(result);
 	var_id base_address = new_variable(type_pointer(type_simple(ST_VOID)), 1, 1);
 	IR_PUSH_ADDRESS_OF(base_address, result);
@@ -220,3 +292,108 @@ void ir_call(var_id result, var_id func_var, struct type *function_type, int n_a
 void ir_new_function(struct type *function_type, var_id *args, const char *name, int is_global) {
 	abi_ir_function_new(function_type, args, name, is_global);
 }
+
+int ir_instruction_uses(struct instruction *ins, var_id *uses[IR_MAX_USES]) {
+	int n = 0;
+	switch (ins->type) {
+	case IR_BINARY_OPERATOR:
+		uses[n++] = &ins->binary_operator.lhs;
+		uses[n++] = &ins->binary_operator.rhs;
+		break;
+	case IR_NEGATE_INT: uses[n++] = &ins->negate_int.operand; break;
+	case IR_NEGATE_FLOAT: uses[n++] = &ins->negate_float.operand; break;
+	case IR_BINARY_NOT: uses[n++] = &ins->binary_not.operand; break;
+	case IR_LOAD: uses[n++] = &ins->load.pointer; break;
+	case IR_STORE:
+		uses[n++] = &ins->store.value;
+		uses[n++] = &ins->store.pointer;
+		break;
+	case IR_CALL: uses[n++] = &ins->call.function; break;
+	case IR_COPY: uses[n++] = &ins->copy.source; break;
+	case IR_BOOL_CAST: uses[n++] = &ins->bool_cast.rhs; break;
+	case IR_INT_CAST: uses[n++] = &ins->int_cast.rhs; break;
+	case IR_FLOAT_CAST: uses[n++] = &ins->float_cast.rhs; break;
+	case IR_INT_FLOAT_CAST: uses[n++] = &ins->int_float_cast.rhs; break;
+	case IR_VA_START: uses[n++] = &ins->result; break; // Result is the address of the va_list.
+	case IR_VA_ARG: uses[n++] = &ins->va_arg_.array; break;
+	case IR_STACK_ALLOC:
+		uses[n++] = &ins->stack_alloc.length;
+		uses[n++] = &ins->stack_alloc.slot;
+		break;
+	case IR_SET_REG: uses[n++] = &ins->set_reg.variable; break;
+	case IR_STORE_STACK_RELATIVE: uses[n++] = &ins->store_stack_relative.variable; break;
+	default: break;
+	}
+	return n;
+}
+
+var_id *ir_instruction_def(struct instruction *ins) {
+	switch (ins->type) {
+	case IR_BINARY_OPERATOR: case IR_NEGATE_INT: case IR_NEGATE_FLOAT:
+	case IR_BINARY_NOT: case IR_LOAD: case IR_ADDRESS_OF: case IR_CONSTANT:
+	case IR_COPY: case IR_BOOL_CAST: case IR_INT_CAST: case IR_FLOAT_CAST:
+	case IR_INT_FLOAT_CAST: case IR_SET_ZERO: case IR_VA_ARG: case IR_STACK_ALLOC:
+	case IR_GET_REG: case IR_LOAD_BASE_RELATIVE: case IR_PHI:
+		return &ins->result;
+	default:
+		return NULL;
+	}
+}
+
+int ir_block_exit_uses(struct block_exit *exit, var_id *uses[IR_MAX_USES]) {
+	switch (exit->type) {
+	case BLOCK_EXIT_IF: uses[0] = &exit->if_.condition; return 1;
+	case BLOCK_EXIT_SWITCH: uses[0] = &exit->switch_.condition; return 1;
+	default: return 0;
+	}
+}
+
+var_id *ir_instruction_memory_operand(struct instruction *ins) {
+	switch (ins->type) {
+	case IR_ADDRESS_OF: return &ins->address_of.variable;
+	case IR_SET_ZERO: return &ins->result;
+	case IR_LOAD_BASE_RELATIVE: return &ins->result;
+	case IR_STORE_STACK_RELATIVE: return &ins->store_stack_relative.variable;
+	case IR_VA_ARG: return &ins->result;
+	case IR_STACK_ALLOC: return &ins->stack_alloc.slot;
+	case IR_CONSTANT: {
+		// Labels and aggregates are written directly to the stack.
+		struct constant *c = &ins->constant.constant;
+		if (c->type == CONSTANT_LABEL ||
+			(c->type == CONSTANT_TYPE && c->data_type->type != TY_SIMPLE &&
+			 !type_is_pointer(c->data_type)))
+			return &ins->result;
+		return NULL;
+	}
+	default: return NULL;
+	}
+}
+
+int ir_block_successors(struct function *func, int block_idx, block_id **successors) {
+	static size_t size, cap;
+	static block_id *buffer = NULL;
+	struct block_exit *exit = &get_block(func->blocks[block_idx])->exit;
+	size = 0;
+
+	switch (exit->type) {
+	case BLOCK_EXIT_JUMP:
+		ADD_ELEMENT(size, cap, buffer) = exit->jump;
+		break;
+	case BLOCK_EXIT_IF:
+		ADD_ELEMENT(size, cap, buffer) = exit->if_.block_true;
+		ADD_ELEMENT(size, cap, buffer) = exit->if_.block_false;
+		break;
+	case BLOCK_EXIT_SWITCH:
+		for (int i = 0; i < exit->switch_.labels.size; i++)
+			ADD_ELEMENT(size, cap, buffer) = exit->switch_.labels.labels[i].block;
+		if (exit->switch_.labels.default_)
+			ADD_ELEMENT(size, cap, buffer) = exit->switch_.labels.default_;
+		else if (block_idx + 1 < func->size)
+			ADD_ELEMENT(size, cap, buffer) = func->blocks[block_idx + 1];
+		break;
+	default: break;
+	}
+
+	*successors = buffer;
+	return size;
+}
@@ -72,6 +72,9 @@ struct instruction {
 		IR_STORE_STACK_RELATIVE,
 		IR_LOAD_BASE_RELATIVE,
 
+		// Only present between SSA construction and destruction.
+		IR_PHI,
+
 		IR_TYPE_COUNT
 	} type;
 
@@ -189,6 +192,12 @@ struct instruction {
 			int offset;
 		} load_base_relative;
 #define IR_PUSH_LOAD_BASE_RELATIVE(RESULT, OFFSET) IR_PUSH(.type = IR_LOAD_BASE_RELATIVE, .result = (RESULT), .load_base_relative = {(OFFSET)})
+		struct {
+			// vars[i] is the value when coming from blocks[i].
+			int size;
+			var_id *vars;
+			block_id *blocks;
+		} phi;
 	};
 };
 
@@ -286,4 +295,18 @@ void ir_get_bits(var_id result, var_id field, int offset, int length, int sign_e
 struct function *get_current_function(void);
 struct block *get_current_block(void);
 
+// Operands of instructions and block exits. The pointers point into
+// the instruction, so they can also be used to rename variables.
+// Operands of IR_PHI are not included.
+#define IR_MAX_USES 2
+int ir_instruction_uses(struct instruction *ins, var_id *uses[IR_MAX_USES]);
+var_id *ir_instruction_def(struct instruction *ins);
+int ir_block_exit_uses(struct block_exit *exit, var_id *uses[IR_MAX_USES]);
+// Variable that ins accesses through its stack location, if any.
+// Such variables can not be renamed or kept in registers.
+var_id *ir_instruction_memory_operand(struct instruction *ins);
+
+// Successors of block, switch fallthrough included.
+int ir_block_successors(struct function *func, int block_idx, block_id **successors);
+
 #endif
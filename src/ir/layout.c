@@ -0,0 +1,186 @@
+#include "layout.h"
+#include "dominators.h"
+
+#include <common.h>
+
+#include <string.h>
+
+// Blocks are placed in chains, each block followed by its preferred
+// unplaced successor. When a chain enters a loop from outside, the
+// header is deferred and the body is placed first. The header then
+// follows the latch, so that each iteration only takes the back-edge.
+
+static struct cfg cfg;
+static int *placed, *in_loop;
+
+static int is_loop_header(int h) {
+	struct cfg_node *node = cfg.nodes + h;
+	for (size_t i = 0; i < node->pred_size; i++)
+		if (cfg_dominates(&cfg, h, node->preds[i]))
+			return 1;
+	return 0;
+}
+
+// Mark the natural loop of h with h + 1 in in_loop.
+static void find_loop(int h) {
+	int *stack = malloc(sizeof *stack * cfg.size);
+	int stack_size = 0;
+
+	in_loop[h] = h + 1;
+	struct cfg_node *node = cfg.nodes + h;
+	for (size_t i = 0; i < node->pred_size; i++) {
+		int latch = node->preds[i];
+		if (cfg_dominates(&cfg, h, latch) && in_loop[latch] != h + 1) {
+			in_loop[latch] = h + 1;
+			stack[stack_size++] = latch;
+		}
+	}
+
+	while (stack_size) {
+		struct cfg_node *curr = cfg.nodes + stack[--stack_size];
+		for (size_t i = 0; i < curr->pred_size; i++) {
+			int pred = curr->preds[i];
+			if (in_loop[pred] != h + 1) {
+				in_loop[pred] = h + 1;
+				stack[stack_size++] = pred;
+			}
+		}
+	}
+
+	free(stack);
+}
+
+// Returns the block to place instead of the loop header h when
+// entering from the block from, or -1 if the loop is not rotated.
+static int rotate_loop(struct function *func, int h, int from) {
+	if (h == 0 || cfg.nodes[from].idom == -1 ||
+		cfg_dominates(&cfg, h, from) || !is_loop_header(h))
+		return -1;
+
+	struct block_exit *exit = &get_block(func->blocks[h])->exit;
+	if (exit->type != BLOCK_EXIT_IF)
+		return -1;
+
+	find_loop(h);
+	int block_true = cfg_index(&cfg, exit->if_.block_true),
+		block_false = cfg_index(&cfg, exit->if_.block_false);
+	int true_in_loop = block_true != h && in_loop[block_true] == h + 1,
+		false_in_loop = block_false != h && in_loop[block_false] == h + 1;
+
+	if (true_in_loop == false_in_loop)
+		return -1;
+
+	int body = true_in_loop ? block_true : block_false;
+	return placed[body] ? -1 : body;
+}
+
+static int preferred_successor(struct function *func, int i) {
+	struct block_exit *exit = &get_block(func->blocks[i])->exit;
+	switch (exit->type) {
+	case BLOCK_EXIT_JUMP: {
+		int target = cfg_index(&cfg, exit->jump);
+		return placed[target] ? -1 : target;
+	}
+
+	case BLOCK_EXIT_IF: {
+		int block_true = cfg_index(&cfg, exit->if_.block_true),
+			block_false = cfg_index(&cfg, exit->if_.block_false);
+		if (!placed[block_true])
+			return block_true;
+		return placed[block_false] ? -1 : block_false;
+	}
+
+	case BLOCK_EXIT_SWITCH: {
+		struct cfg_node *node = cfg.nodes + i;
+		for (size_t j = 0; j < node->succ_size; j++)
+			if (!placed[node->succs[j]])
+				return node->succs[j];
+		return -1;
+	}
+
+	default:
+		return -1;
+	}
+}
+
+// Stack slots of temporaries are assigned in block order, and are
+// reused after IR_CLEAR_STACK_BUCKET. Temporaries used in more than
+// one block can no longer rely on that, and get permanent slots.
+static void pin_temporaries(struct function *func) {
+	static int *temp_block = NULL;
+	static int temp_block_size = 0;
+	if (temp_block_size < get_n_vars()) {
+		temp_block = realloc(temp_block, sizeof *temp_block * get_n_vars());
+		for (int i = temp_block_size; i < get_n_vars(); i++)
+			temp_block[i] = -1;
+		temp_block_size = get_n_vars();
+	}
+
+	for (int i = 0; i < func->size; i++) {
+		struct block *block = get_block(func->blocks[i]);
+		for (int j = 0; j < block->size; j++)
+			if (block->instructions[j].type == IR_ADD_TEMPORARY)
+				temp_block[block->instructions[j].result] = i;
+	}
+
+	for (int i = 0; i < func->size; i++) {
+		struct block *block = get_block(func->blocks[i]);
+		for (int j = 0; j <= block->size; j++) {
+			struct instruction *ins = j < block->size ? block->instructions + j : NULL;
+			var_id *vars[IR_MAX_USES + 2];
+			int n = ins ? ir_instruction_uses(ins, vars) : ir_block_exit_uses(&block->exit, vars);
+			if (ins && ir_instruction_def(ins))
+				vars[n++] = ir_instruction_def(ins);
+			if (ins && ir_instruction_memory_operand(ins))
+				vars[n++] = ir_instruction_memory_operand(ins);
+
+			for (int k = 0; k < n; k++) {
+				var_id var = *vars[k];
+				if (var < temp_block_size && temp_block[var] != -1 && temp_block[var] != i) {
+					variable_set_stack_bucket(var, 0);
+					temp_block[var] = -1;
+				}
+			}
+		}
+	}
+
+	for (int i = 0; i < func->var_size; i++)
+		if (func->vars[i] < temp_block_size)
+			temp_block[func->vars[i]] = -1;
+}
+
+void block_layout(struct function *func) {
+	if (func->size <= 1)
+		return;
+
+	cfg_compute(&cfg, func);
+	placed = calloc(func->size, sizeof *placed);
+	in_loop = calloc(func->size, sizeof *in_loop);
+	block_id *order = malloc(sizeof *order * func->size);
+	int order_size = 0;
+
+	for (int start = 0; start < func->size; start++) {
+		for (int i = start; i != -1 && !placed[i];) {
+			placed[i] = 1;
+			order[order_size++] = func->blocks[i];
+
+			int next = preferred_successor(func, i);
+			if (next != -1) {
+				int body = rotate_loop(func, next, i);
+				if (body != -1)
+					next = body;
+			}
+			i = next;
+		}
+	}
+
+	if (memcmp(order, func->blocks, sizeof *order * func->size) != 0) {
+		pin_temporaries(func);
+		memcpy(func->blocks, order, sizeof *order * func->size);
+	}
+
+	free(order);
+	free(placed);
+	free(in_loop);
+	cfg_free(&cfg);
+}
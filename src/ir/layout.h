@@ -0,0 +1,11 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include "ir.h"
+
+// Reorder the blocks of func such that jumps fall through to the
+// next block where possible, and loops are rotated to end in their
+// conditional branch.
+void block_layout(struct function *func);
+
+#endif
@@ -0,0 +1,36 @@
+#include "optimize.h"
+#include "ir.h"
+#include "ssa.h"
+#include "sccp.h"
+#include "dce.h"
+#include "layout.h"
+
+struct optimization_flags optimization_flags = {
+	.level = 0
+};
+
+// Passes are run in order, on each function separately.
+// Passes between SSA construction and destruction can assume that
+// each scalar variable has at most one definition.
+static const struct pass {
+	const char *name;
+	int level;
+	void (*run)(struct function *func);
+} passes[] = {
+	{ "ssa-construct", 1, ssa_construct },
+	{ "sccp", 1, sccp },
+	{ "unreachable-blocks", 1, remove_unreachable_blocks },
+	{ "dead-zeroing", 1, remove_dead_zeroing },
+	{ "dce", 1, dead_code_elimination },
+	{ "ssa-destruct", 1, ssa_destruct },
+	{ "block-layout", 1, block_layout },
+};
+
+void optimize_ir(void) {
+	for (int i = 0; i < ir.size; i++) {
+		for (unsigned j = 0; j < sizeof passes / sizeof *passes; j++) {
+			if (passes[j].level <= optimization_flags.level)
+				passes[j].run(ir.functions + i);
+		}
+	}
+}
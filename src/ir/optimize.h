@@ -0,0 +1,11 @@
+#ifndef OPTIMIZE_H
+#define OPTIMIZE_H
+
+extern struct optimization_flags {
+	int level;
+} optimization_flags;
+
+// Run the passes enabled by the optimization level on all functions.
+void optimize_ir(void);
+
+#endif
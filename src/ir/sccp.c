@@ -0,0 +1,562 @@
+#include "sccp.h"
+#include "dominators.h"
+#include "operators.h"
+
+#include <common.h>
+#include <types.h>
+
+#include <string.h>
+
+// Sparse conditional constant propagation, as described in
+// "Constant Propagation with Conditional Branches" by Wegman and Zadeck.
+
+struct lattice {
+	enum {
+		LAT_TOP,
+		LAT_CONSTANT,
+		LAT_LABEL, // Address of label plus value.
+		LAT_BOTTOM
+	} type;
+
+	uint64_t value;
+	label_id label;
+};
+
+struct site {
+	int block, ins; // ins == block size for the block exit.
+};
+
+static struct lattice *values;
+static int *var_index = NULL;
+static int var_index_size = 0;
+
+static int *use_start;
+static struct site *use_sites;
+
+static int *block_exec, *edge_start, *edge_exec;
+
+static size_t cfg_worklist_size, cfg_worklist_cap;
+static struct edge {
+	int pred, succ;
+} *cfg_worklist;
+
+static size_t ssa_worklist_size, ssa_worklist_cap;
+static int *ssa_worklist;
+
+static uint64_t size_mask(int size) {
+	return size >= 8 ? (uint64_t)-1 : ((uint64_t)1 << (size * 8)) - 1;
+}
+
+static int get_index(var_id var) {
+	return var < var_index_size ? var_index[var] : -1;
+}
+
+static struct lattice value_of(var_id var) {
+	int idx = get_index(var);
+	return idx == -1 ? (struct lattice) { .type = LAT_BOTTOM } : values[idx];
+}
+
+static int lattice_equal(struct lattice a, struct lattice b) {
+	if (a.type != b.type)
+		return 0;
+	if (a.type == LAT_CONSTANT)
+		return a.value == b.value;
+	if (a.type == LAT_LABEL)
+		return a.value == b.value && a.label == b.label;
+	return 1;
+}
+
+static struct lattice meet(struct lattice a, struct lattice b) {
+	if (a.type == LAT_TOP)
+		return b;
+	if (b.type == LAT_TOP)
+		return a;
+	if (lattice_equal(a, b))
+		return a;
+	return (struct lattice) { .type = LAT_BOTTOM };
+}
+
+static enum simple_type type_of_size(int size, int sign) {
+	switch (size) {
+	case 1: return sign ? ST_SCHAR : ST_UCHAR;
+	case 2: return sign ? ST_SHORT : ST_USHORT;
+	case 4: return sign ? ST_INT : ST_UINT;
+	case 8: return sign ? ST_LONG : ST_ULONG;
+	default: ICE("Invalid size %d", size);
+	}
+}
+
+static struct constant to_constant(uint64_t value, int size, int sign) {
+	struct constant c = constant_simple_unsigned(type_of_size(size, 0), value & size_mask(size));
+	if (sign)
+		c = constant_cast(c, type_simple(type_of_size(size, 1)));
+	return c;
+}
+
+static const struct {
+	int valid;
+	enum operator_type op;
+	int sign;
+} ibo_operators[IBO_COUNT] = {
+	[IBO_ADD] = { 1, OP_ADD, 0 }, [IBO_SUB] = { 1, OP_SUB, 0 },
+	[IBO_MUL] = { 1, OP_MUL, 0 }, [IBO_IMUL] = { 1, OP_MUL, 0 }, // Same low bits.
+	[IBO_DIV] = { 1, OP_DIV, 0 }, [IBO_IDIV] = { 1, OP_DIV, 1 },
+	[IBO_MOD] = { 1, OP_MOD, 0 }, [IBO_IMOD] = { 1, OP_MOD, 1 },
+	[IBO_LSHIFT] = { 1, OP_LSHIFT, 0 },
+	[IBO_RSHIFT] = { 1, OP_RSHIFT, 0 }, [IBO_IRSHIFT] = { 1, OP_RSHIFT, 1 },
+	[IBO_BXOR] = { 1, OP_BXOR, 0 }, [IBO_BOR] = { 1, OP_BOR, 0 }, [IBO_BAND] = { 1, OP_BAND, 0 },
+	[IBO_LESS] = { 1, OP_LESS, 0 }, [IBO_ILESS] = { 1, OP_LESS, 1 },
+	[IBO_GREATER] = { 1, OP_GREATER, 0 }, [IBO_IGREATER] = { 1, OP_GREATER, 1 },
+	[IBO_LESS_EQ] = { 1, OP_LESS_EQ, 0 }, [IBO_ILESS_EQ] = { 1, OP_LESS_EQ, 1 },
+	[IBO_GREATER_EQ] = { 1, OP_GREATER_EQ, 0 }, [IBO_IGREATER_EQ] = { 1, OP_GREATER_EQ, 1 },
+	[IBO_EQUAL] = { 1, OP_EQUAL, 0 }, [IBO_NOT_EQUAL] = { 1, OP_NOT_EQUAL, 0 },
+};
+
+static struct lattice fold_binary(struct instruction *ins) {
+	var_id lhs_var = ins->binary_operator.lhs, rhs_var = ins->binary_operator.rhs;
+	struct lattice lhs = value_of(lhs_var), rhs = value_of(rhs_var);
+	struct lattice bottom = { .type = LAT_BOTTOM };
+	enum ir_binary_operator ibo = ins->binary_operator.type;
+	int size = get_variable_size(lhs_var);
+
+	if (lhs.type == LAT_BOTTOM || rhs.type == LAT_BOTTOM)
+		return bottom;
+	if (lhs.type == LAT_TOP || rhs.type == LAT_TOP)
+		return (struct lattice) { .type = LAT_TOP };
+
+	if (get_variable_size(rhs_var) != size || !ibo_operators[ibo].valid ||
+		(size != 4 && size != 8))
+		return bottom;
+
+	// Label offsets.
+	if (lhs.type == LAT_LABEL || rhs.type == LAT_LABEL) {
+		if (size != 8 || get_variable_size(ins->result) != 8)
+			return bottom;
+		if (ibo == IBO_ADD && lhs.type != rhs.type)
+			return (struct lattice) {
+				.type = LAT_LABEL,
+				.label = lhs.type == LAT_LABEL ? lhs.label : rhs.label,
+				.value = lhs.value + rhs.value
+			};
+		if (ibo == IBO_SUB && lhs.type == LAT_LABEL && rhs.type == LAT_CONSTANT)
+			return (struct lattice) { .type = LAT_LABEL, .label = lhs.label, .value = lhs.value - rhs.value };
+		return bottom;
+	}
+
+	int sign = ibo_operators[ibo].sign;
+	enum operator_type op = ibo_operators[ibo].op;
+	struct constant lhs_c = to_constant(lhs.value, size, sign),
+		rhs_c = to_constant(rhs.value, size, sign), res;
+
+	// Avoid trapping, or undefined behaviour, in the compiler itself.
+	if ((op == OP_DIV || op == OP_MOD) &&
+		(rhs.value == 0 || (sign && rhs_c.int_d == -1)))
+		return bottom;
+	if ((op == OP_LSHIFT || op == OP_RSHIFT) && rhs.value >= (uint64_t)size * 8)
+		return bottom;
+
+	if (!operators_constant(op, lhs_c, rhs_c, &res))
+		return bottom;
+
+	return (struct lattice) {
+		.type = LAT_CONSTANT,
+		.value = constant_to_u64(res) & size_mask(get_variable_size(ins->result))
+	};
+}
+
+static struct lattice fold_unary(var_id operand, enum unary_operator_type op, int result_size) {
+	struct lattice a = value_of(operand);
+	if (a.type != LAT_CONSTANT)
+		return a.type == LAT_TOP ? a : (struct lattice) { .type = LAT_BOTTOM };
+
+	struct constant res;
+	if (!operators_constant_unary(op, to_constant(a.value, 8, 0), &res))
+		return (struct lattice) { .type = LAT_BOTTOM };
+
+	return (struct lattice) { .type = LAT_CONSTANT, .value = constant_to_u64(res) & size_mask(result_size) };
+}
+
+static struct lattice fold_int_cast(struct instruction *ins) {
+	struct lattice a = value_of(ins->int_cast.rhs);
+	int from = get_variable_size(ins->int_cast.rhs), to = get_variable_size(ins->result);
+
+	if (a.type == LAT_LABEL)
+		return from == 8 && to == 8 ? a : (struct lattice) { .type = LAT_BOTTOM };
+	if (a.type != LAT_CONSTANT)
+		return a;
+
+	struct constant c = to_constant(a.value, from, ins->int_cast.sign_extend);
+	c = constant_cast(c, type_simple(type_of_size(to, 0)));
+	return (struct lattice) { .type = LAT_CONSTANT, .value = constant_to_u64(c) & size_mask(to) };
+}
+
+static int edge_index(struct cfg *cfg, int pred, int succ) {
+	struct cfg_node *node = cfg->nodes + succ;
+	for (size_t i = 0; i < node->pred_size; i++)
+		if (node->preds[i] == pred)
+			return edge_start[succ] + i;
+	return -1;
+}
+
+static struct lattice evaluate(struct cfg *cfg, int block_idx, struct instruction *ins) {
+	struct lattice bottom = { .type = LAT_BOTTOM };
+	int size = get_variable_size(ins->result);
+
+	switch (ins->type) {
+	case IR_CONSTANT: {
+		struct constant *c = &ins->constant.constant;
+		if (c->type == CONSTANT_LABEL_POINTER)
+			return (struct lattice) { .type = LAT_LABEL, .label = c->label.label, .value = c->label.offset };
+		if (c->type == CONSTANT_TYPE &&
+			(c->data_type->type == TY_SIMPLE || type_is_pointer(c->data_type)) &&
+			calculate_size(c->data_type) == size)
+			return (struct lattice) { .type = LAT_CONSTANT, .value = constant_to_u64(*c) & size_mask(size) };
+		return bottom;
+	}
+
+	case IR_BINARY_OPERATOR:
+		return fold_binary(ins);
+
+	case IR_NEGATE_INT:
+		return fold_unary(ins->negate_int.operand, UOP_NEG, size);
+
+	case IR_BINARY_NOT:
+		return fold_unary(ins->binary_not.operand, UOP_BNOT, size);
+
+	case IR_COPY: {
+		struct lattice a = value_of(ins->copy.source);
+		return get_variable_size(ins->copy.source) == size ? a : bottom;
+	}
+
+	case IR_INT_CAST:
+		return fold_int_cast(ins);
+
+	case IR_BOOL_CAST: {
+		struct lattice a = value_of(ins->bool_cast.rhs);
+		if (a.type != LAT_CONSTANT)
+			return a.type == LAT_TOP ? a : bottom;
+		return (struct lattice) { .type = LAT_CONSTANT, .value = a.value != 0 };
+	}
+
+	case IR_PHI: {
+		struct lattice res = { .type = LAT_TOP };
+		for (int i = 0; i < ins->phi.size; i++) {
+			int pred = cfg_index(cfg, ins->phi.blocks[i]);
+			int edge = pred == -1 ? -1 : edge_index(cfg, pred, block_idx);
+			if (edge == -1 || !edge_exec[edge])
+				continue;
+			res = meet(res, value_of(ins->phi.vars[i]));
+		}
+		return res;
+	}
+
+	default:
+		return bottom;
+	}
+}
+
+static void visit_instruction(struct cfg *cfg, int block_idx, struct instruction *ins) {
+	var_id *def = ir_instruction_def(ins);
+	int idx = def ? get_index(*def) : -1;
+	if (idx == -1 || values[idx].type == LAT_BOTTOM)
+		return;
+
+	struct lattice new_value = meet(values[idx], evaluate(cfg, block_idx, ins));
+	if (!lattice_equal(new_value, values[idx])) {
+		values[idx] = new_value;
+		ADD_ELEMENT(ssa_worklist_size, ssa_worklist_cap, ssa_worklist) = idx;
+	}
+}
+
+static void add_edge(struct cfg *cfg, int pred, block_id succ) {
+	ADD_ELEMENT(cfg_worklist_size, cfg_worklist_cap, cfg_worklist) = (struct edge) {
+		pred, cfg_index(cfg, succ)
+	};
+}
+
+// Returns the block taken by the exit with constant condition, or -1.
+static block_id constant_target(struct block_exit *exit, uint64_t value) {
+	switch (exit->type) {
+	case BLOCK_EXIT_IF:
+		return value ? exit->if_.block_true : exit->if_.block_false;
+	case BLOCK_EXIT_SWITCH:
+		// Cases are compared as 32 bit values by codegen.
+		for (int i = 0; i < exit->switch_.labels.size; i++)
+			if ((uint32_t)exit->switch_.labels.labels[i].value.int_d == (uint32_t)value)
+				return exit->switch_.labels.labels[i].block;
+		return exit->switch_.labels.default_ ? exit->switch_.labels.default_ : -1;
+	default:
+		return -1;
+	}
+}
+
+static void visit_exit(struct function *func, struct cfg *cfg, int block_idx) {
+	struct block_exit *exit = &get_block(func->blocks[block_idx])->exit;
+
+	if (exit->type == BLOCK_EXIT_IF || exit->type == BLOCK_EXIT_SWITCH) {
+		var_id condition = exit->type == BLOCK_EXIT_IF ? exit->if_.condition :
+			exit->switch_.condition;
+		struct lattice c = value_of(condition);
+		if (c.type == LAT_TOP)
+			return;
+
+		block_id target = c.type == LAT_CONSTANT ? constant_target(exit, c.value) : -1;
+		if (target != -1) {
+			add_edge(cfg, block_idx, target);
+			return;
+		}
+	}
+
+	struct cfg_node *node = cfg->nodes + block_idx;
+	for (size_t i = 0; i < node->succ_size; i++)
+		add_edge(cfg, block_idx, func->blocks[node->succs[i]]);
+}
+
+static void find_uses(struct function *func) {
+	int n_vars = func->var_size;
+	use_start = calloc(n_vars + 2, sizeof *use_start);
+
+	// Count, then fill.
+	for (int pass = 0; pass < 2; pass++) {
+		for (int i = 0; i < func->size; i++) {
+			struct block *block = get_block(func->blocks[i]);
+			var_id *uses[IR_MAX_USES];
+
+			for (int j = 0; j <= block->size; j++) {
+				struct instruction *ins = j < block->size ? block->instructions + j : NULL;
+				int n_uses = ins ? ir_instruction_uses(ins, uses) :
+					ir_block_exit_uses(&block->exit, uses);
+
+				for (int k = 0; k < n_uses + (ins && ins->type == IR_PHI ? ins->phi.size : 0); k++) {
+					int idx = get_index(k < n_uses ? *uses[k] : ins->phi.vars[k - n_uses]);
+					if (idx == -1)
+						continue;
+					if (pass == 0)
+						use_start[idx + 2]++;
+					else
+						use_sites[use_start[idx + 1]++] = (struct site) { i, j };
+				}
+			}
+		}
+
+		if (pass == 0) {
+			for (int i = 0; i < n_vars; i++)
+				use_start[i + 2] += use_start[i + 1];
+			use_sites = malloc(sizeof *use_sites * (use_start[n_vars + 1] + 1));
+		}
+	}
+}
+
+static void find_variables(struct function *func) {
+	if (var_index_size < get_n_vars()) {
+		var_index = realloc(var_index, sizeof *var_index * get_n_vars());
+		for (int i = var_index_size; i < get_n_vars(); i++)
+			var_index[i] = -1;
+		var_index_size = get_n_vars();
+	}
+
+	values = malloc(sizeof *values * (func->var_size + 1));
+	int *n_defs = calloc(func->var_size + 1, sizeof *n_defs);
+
+	for (int i = 0; i < func->var_size; i++) {
+		var_index[func->vars[i]] = i;
+		int size = get_variable_size(func->vars[i]);
+		values[i].type = (size == 1 || size == 2 || size == 4 || size == 8) ? LAT_TOP : LAT_BOTTOM;
+	}
+
+	for (int i = 0; i < func->size; i++) {
+		struct block *block = get_block(func->blocks[i]);
+		for (int j = 0; j < block->size; j++) {
+			var_id *var = ir_instruction_memory_operand(block->instructions + j);
+			if (var && get_index(*var) != -1)
+				values[get_index(*var)].type = LAT_BOTTOM;
+
+			var = ir_instruction_def(block->instructions + j);
+			if (var && get_index(*var) != -1)
+				n_defs[get_index(*var)]++;
+		}
+	}
+
+	// Only variables in SSA form can be tracked, variables without
+	// definitions are considered unknown.
+	for (int i = 0; i < func->var_size; i++)
+		if (n_defs[i] != 1)
+			values[i].type = LAT_BOTTOM;
+
+	free(n_defs);
+}
+
+static struct instruction constant_instruction(var_id result, struct lattice value) {
+	struct constant c;
+	if (value.type == LAT_LABEL) {
+		c = (struct constant) {
+			.type = CONSTANT_LABEL_POINTER,
+			.data_type = type_pointer(type_simple(ST_VOID)),
+			.label = { value.label, value.value }
+		};
+	} else {
+		c = constant_simple_unsigned(type_of_size(get_variable_size(result), 0), value.value);
+	}
+
+	return (struct instruction) {
+		.type = IR_CONSTANT,
+		.result = result,
+		.constant = { c }
+	};
+}
+
+static int is_constant(var_id var, uint64_t value) {
+	struct lattice l = value_of(var);
+	return l.type == LAT_CONSTANT && l.value == value;
+}
+
+// x + 0, x * 1 and similar are replaced by copies.
+static void simplify_binary(struct instruction *ins) {
+	var_id lhs = ins->binary_operator.lhs, rhs = ins->binary_operator.rhs;
+	var_id source = VOID_VAR;
+
+	switch (ins->binary_operator.type) {
+	case IBO_ADD: case IBO_BOR: case IBO_BXOR:
+		if (is_constant(rhs, 0))
+			source = lhs;
+		else if (is_constant(lhs, 0))
+			source = rhs;
+		break;
+	case IBO_SUB: case IBO_LSHIFT: case IBO_RSHIFT: case IBO_IRSHIFT:
+		if (is_constant(rhs, 0))
+			source = lhs;
+		break;
+	case IBO_MUL: case IBO_IMUL:
+		if (is_constant(rhs, 1))
+			source = lhs;
+		else if (is_constant(lhs, 1))
+			source = rhs;
+		break;
+	default: break;
+	}
+
+	if (source != VOID_VAR && get_variable_size(source) == get_variable_size(ins->result))
+		*ins = (struct instruction) { .type = IR_COPY, .result = ins->result, .copy = { source } };
+}
+
+static void rewrite(struct function *func, struct cfg *cfg) {
+	for (int i = 0; i < func->size; i++) {
+		if (!block_exec[i])
+			continue;
+
+		struct block *block = get_block(func->blocks[i]);
+		for (int j = 0; j < block->size; j++) {
+			struct instruction *ins = block->instructions + j;
+			var_id *def = ir_instruction_def(ins);
+			struct lattice value = def ? value_of(*def) : (struct lattice) { .type = LAT_BOTTOM };
+
+			if ((value.type == LAT_CONSTANT || value.type == LAT_LABEL) && ins->type != IR_CONSTANT) {
+				if (ins->type == IR_PHI) {
+					free(ins->phi.vars);
+					free(ins->phi.blocks);
+				}
+				*ins = constant_instruction(*def, value);
+			} else if (ins->type == IR_BINARY_OPERATOR) {
+				simplify_binary(ins);
+			} else if (ins->type == IR_PHI) {
+				// Remove operands from edges that are never taken.
+				int n = 0;
+				for (int k = 0; k < ins->phi.size; k++) {
+					int pred = cfg_index(cfg, ins->phi.blocks[k]);
+					int edge = pred == -1 ? -1 : edge_index(cfg, pred, i);
+					if (edge == -1 || !edge_exec[edge])
+						continue;
+					ins->phi.vars[n] = ins->phi.vars[k];
+					ins->phi.blocks[n] = ins->phi.blocks[k];
+					n++;
+				}
+				ins->phi.size = n;
+			}
+		}
+
+		struct block_exit *exit = &block->exit;
+		if (exit->type == BLOCK_EXIT_IF || exit->type == BLOCK_EXIT_SWITCH) {
+			struct lattice c = value_of(exit->type == BLOCK_EXIT_IF ? exit->if_.condition :
+										exit->switch_.condition);
+			block_id target = c.type == LAT_CONSTANT ? constant_target(exit, c.value) : -1;
+			if (target != -1) {
+				exit->type = BLOCK_EXIT_JUMP;
+				exit->jump = target;
+			}
+		}
+	}
+}
+
+void sccp(struct function *func) {
+	if (!func->size)
+		return;
+
+	struct cfg cfg;
+	cfg_compute(&cfg, func);
+
+	find_variables(func);
+	find_uses(func);
+
+	block_exec = calloc(func->size, sizeof *block_exec);
+	edge_start = malloc(sizeof *edge_start * (func->size + 1));
+	int n_edges = 0;
+	for (int i = 0; i < func->size; i++) {
+		edge_start[i] = n_edges;
+		n_edges += cfg.nodes[i].pred_size;
+	}
+	edge_exec = calloc(n_edges + 1, sizeof *edge_exec);
+
+	cfg_worklist_size = ssa_worklist_size = 0;
+	ADD_ELEMENT(cfg_worklist_size, cfg_worklist_cap, cfg_worklist) = (struct edge) { -1, 0 };
+
+	while (cfg_worklist_size || ssa_worklist_size) {
+		if (cfg_worklist_size) {
+			struct edge edge = cfg_worklist[--cfg_worklist_size];
+			if (edge.pred != -1) {
+				int idx = edge_index(&cfg, edge.pred, edge.succ);
+				if (edge_exec[idx])
+					continue;
+				edge_exec[idx] = 1;
+			}
+
+			struct block *block = get_block(func->blocks[edge.succ]);
+			if (block_exec[edge.succ]) {
+				for (int i = 0; i < block->size; i++)
+					if (block->instructions[i].type == IR_PHI)
+						visit_instruction(&cfg, edge.succ, block->instructions + i);
+				continue;
+			}
+
+			block_exec[edge.succ] = 1;
+			for (int i = 0; i < block->size; i++)
+				visit_instruction(&cfg, edge.succ, block->instructions + i);
+			visit_exit(func, &cfg, edge.succ);
+		} else {
+			int idx = ssa_worklist[--ssa_worklist_size];
+			for (int i = use_start[idx]; i < use_start[idx + 1]; i++) {
+				struct site site = use_sites[i];
+				if (!block_exec[site.block])
+					continue;
+
+				struct block *block = get_block(func->blocks[site.block]);
+				if (site.ins == block->size)
+					visit_exit(func, &cfg, site.block);
+				else
+					visit_instruction(&cfg, site.block, block->instructions + site.ins);
+			}
+		}
+	}
+
+	rewrite(func, &cfg);
+
+	for (int i = 0; i < func->var_size; i++)
+		var_index[func->vars[i]] = -1;
+
+	free(values);
+	free(use_start);
+	free(use_sites);
+	free(block_exec);
+	free(edge_start);
+	free(edge_exec);
+	cfg_free(&cfg);
+}
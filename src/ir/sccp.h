@@ -0,0 +1,11 @@
+#ifndef SCCP_H
+#define SCCP_H
+
+#include "ir.h"
+
+// Fold instructions with constant operands, propagate constants
+// through copies and phis, and turn branches on constants into jumps.
+// Requires SSA form.
+void sccp(struct function *func);
+
+#endif
@@ -0,0 +1,481 @@
+#include "ssa.h"
+#include "dominators.h"
+
+#include <common.h>
+
+#include <string.h>
+
+struct ssa_var {
+	var_id var;
+	int n_defs, def_block, def_pos;
+	int global, rename;
+
+	size_t def_blocks_size, def_blocks_cap;
+	int *def_blocks;
+
+	size_t stack_size, stack_cap;
+	var_id *stack;
+};
+
+static size_t ssa_vars_size, ssa_vars_cap;
+static struct ssa_var *ssa_vars;
+
+static int *var_index = NULL;
+static int var_index_size = 0;
+
+static int get_index(var_id var) {
+	return var < var_index_size ? var_index[var] : -1;
+}
+
+static var_id new_version(struct function *func, var_id var) {
+	var_id version = new_variable_sz(get_variable_size(var), 0, 0);
+	ADD_ELEMENT(func->var_size, func->var_cap, func->vars) = version;
+	return version;
+}
+
+static void add_block_first(struct function *func, block_id id) {
+	ADD_ELEMENT(func->size, func->cap, func->blocks) = id;
+	memmove(func->blocks + 1, func->blocks, sizeof *func->blocks * (func->size - 1));
+	func->blocks[0] = id;
+}
+
+// A switch without default falls through to the next block,
+// make that explicit so that blocks can be inserted freely.
+static void explicit_fallthrough(struct function *func) {
+	for (int i = 0; i + 1 < func->size; i++) {
+		struct block *block = get_block(func->blocks[i]);
+		if (block->exit.type == BLOCK_EXIT_SWITCH && !block->exit.switch_.labels.default_)
+			block->exit.switch_.labels.default_ = func->blocks[i + 1];
+	}
+}
+
+static void find_variables(struct function *func) {
+	if (var_index_size < get_n_vars()) {
+		var_index = realloc(var_index, sizeof *var_index * get_n_vars());
+		for (int i = var_index_size; i < get_n_vars(); i++)
+			var_index[i] = -1;
+		var_index_size = get_n_vars();
+	}
+
+	for (int i = 0; i < func->var_size; i++) {
+		var_id var = func->vars[i];
+		int size = get_variable_size(var);
+		var_index[var] = (size == 1 || size == 2 || size == 4 || size == 8) ? 0 : -1;
+	}
+
+	for (int i = 0; i < func->size; i++) {
+		struct block *block = get_block(func->blocks[i]);
+		for (int j = 0; j < block->size; j++) {
+			var_id *var = ir_instruction_memory_operand(block->instructions + j);
+			if (var && *var < var_index_size)
+				var_index[*var] = -1;
+		}
+	}
+
+	ssa_vars_size = 0;
+	for (int i = 0; i < func->var_size; i++) {
+		var_id var = func->vars[i];
+		if (var_index[var] == -1)
+			continue;
+		var_index[var] = ssa_vars_size;
+		ADD_ELEMENT(ssa_vars_size, ssa_vars_cap, ssa_vars) = (struct ssa_var) {
+			.var = var
+		};
+	}
+}
+
+// Count definitions, and find variables that are live into some block.
+static void find_definitions(struct function *func) {
+	int *defined_in = malloc(sizeof *defined_in * (ssa_vars_size + 1));
+	for (size_t i = 0; i < ssa_vars_size; i++)
+		defined_in[i] = -1;
+
+	for (int i = 0; i < func->size; i++) {
+		struct block *block = get_block(func->blocks[i]);
+		var_id *uses[IR_MAX_USES];
+
+		for (int j = 0; j <= block->size; j++) {
+			struct instruction *ins = j < block->size ? block->instructions + j : NULL;
+			int n_uses = ins ? ir_instruction_uses(ins, uses) :
+				ir_block_exit_uses(&block->exit, uses);
+
+			for (int k = 0; k < n_uses; k++) {
+				int idx = get_index(*uses[k]);
+				if (idx != -1 && defined_in[idx] != i)
+					ssa_vars[idx].global = 1;
+			}
+
+			var_id *def = ins ? ir_instruction_def(ins) : NULL;
+			int idx = def ? get_index(*def) : -1;
+			if (idx == -1)
+				continue;
+
+			struct ssa_var *v = ssa_vars + idx;
+			v->n_defs++;
+			v->def_block = i;
+			v->def_pos = j;
+			defined_in[idx] = i;
+			if (!v->def_blocks_size || v->def_blocks[v->def_blocks_size - 1] != i)
+				ADD_ELEMENT(v->def_blocks_size, v->def_blocks_cap, v->def_blocks) = i;
+		}
+	}
+
+	free(defined_in);
+}
+
+// Variables with one definition only need renaming if the
+// definition does not dominate all uses.
+static void find_renamed(struct function *func, struct cfg *cfg) {
+	for (size_t i = 0; i < ssa_vars_size; i++)
+		ssa_vars[i].rename = ssa_vars[i].n_defs >= 2;
+
+	for (int i = 0; i < func->size; i++) {
+		if (cfg->nodes[i].idom == -1)
+			continue;
+
+		struct block *block = get_block(func->blocks[i]);
+		var_id *uses[IR_MAX_USES];
+
+		for (int j = 0; j <= block->size; j++) {
+			struct instruction *ins = j < block->size ? block->instructions + j : NULL;
+			int n_uses = ins ? ir_instruction_uses(ins, uses) :
+				ir_block_exit_uses(&block->exit, uses);
+
+			for (int k = 0; k < n_uses; k++) {
+				int idx = get_index(*uses[k]);
+				if (idx == -1)
+					continue;
+
+				struct ssa_var *v = ssa_vars + idx;
+				if (v->n_defs != 1)
+					continue;
+
+				if (v->def_block == i ? v->def_pos >= j : !cfg_dominates(cfg, v->def_block, i))
+					v->rename = 1;
+			}
+		}
+	}
+}
+
+struct phi_list {
+	size_t size, cap;
+	struct instruction *phis;
+};
+
+static void insert_phis(struct function *func, struct cfg *cfg) {
+	struct phi_list *lists = calloc(func->size + 1, sizeof *lists);
+	int *has_phi = malloc(sizeof *has_phi * (func->size + 1)),
+		*in_worklist = malloc(sizeof *in_worklist * (func->size + 1));
+	for (int i = 0; i < func->size; i++)
+		has_phi[i] = in_worklist[i] = -1;
+
+	size_t worklist_size = 0, worklist_cap = 0;
+	int *worklist = NULL;
+
+	for (size_t i = 0; i < ssa_vars_size; i++) {
+		struct ssa_var *v = ssa_vars + i;
+		if (!v->rename || !v->global)
+			continue;
+
+		worklist_size = 0;
+		for (size_t j = 0; j < v->def_blocks_size; j++) {
+			int b = v->def_blocks[j];
+			if (cfg->nodes[b].idom == -1)
+				continue;
+			in_worklist[b] = i;
+			ADD_ELEMENT(worklist_size, worklist_cap, worklist) = b;
+		}
+
+		while (worklist_size) {
+			struct cfg_node *node = cfg->nodes + worklist[--worklist_size];
+			for (size_t j = 0; j < node->frontier_size; j++) {
+				int f = node->frontier[j];
+				if (has_phi[f] == (int)i)
+					continue;
+				has_phi[f] = i;
+
+				struct cfg_node *f_node = cfg->nodes + f;
+				struct instruction phi = {
+					.type = IR_PHI,
+					.result = v->var,
+					.phi = {
+						.size = f_node->pred_size,
+						.vars = malloc(sizeof (var_id) * f_node->pred_size),
+						.blocks = malloc(sizeof (block_id) * f_node->pred_size)
+					}
+				};
+
+				for (size_t k = 0; k < f_node->pred_size; k++) {
+					phi.phi.vars[k] = v->var;
+					phi.phi.blocks[k] = func->blocks[f_node->preds[k]];
+				}
+
+				ADD_ELEMENT(lists[f].size, lists[f].cap, lists[f].phis) = phi;
+
+				if (in_worklist[f] != (int)i) {
+					in_worklist[f] = i;
+					ADD_ELEMENT(worklist_size, worklist_cap, worklist) = f;
+				}
+			}
+		}
+	}
+
+	for (int i = 0; i < func->size; i++) {
+		if (!lists[i].size)
+			continue;
+
+		struct block *block = get_block(func->blocks[i]);
+		struct instruction *space = ADD_ELEMENTS(block->size, block->cap, block->instructions, (int)lists[i].size);
+		memmove(block->instructions + lists[i].size, block->instructions,
+				sizeof *block->instructions * (space - block->instructions));
+		memcpy(block->instructions, lists[i].phis, sizeof *block->instructions * lists[i].size);
+		free(lists[i].phis);
+	}
+
+	free(lists);
+	free(has_phi);
+	free(in_worklist);
+	free(worklist);
+}
+
+static size_t def_log_size, def_log_cap;
+static int *def_log = NULL;
+
+static void rename_use(var_id *var) {
+	int idx = get_index(*var);
+	if (idx == -1 || !ssa_vars[idx].rename)
+		return;
+
+	struct ssa_var *v = ssa_vars + idx;
+	if (v->stack_size)
+		*var = v->stack[v->stack_size - 1];
+}
+
+static void rename_block(struct function *func, struct cfg *cfg, int idx) {
+	struct block *block = get_block(func->blocks[idx]);
+	var_id *uses[IR_MAX_USES];
+
+	for (int i = 0; i < block->size; i++) {
+		struct instruction *ins = block->instructions + i;
+		if (ins->type != IR_PHI) {
+			int n_uses = ir_instruction_uses(ins, uses);
+			for (int j = 0; j < n_uses; j++)
+				rename_use(uses[j]);
+		}
+
+		var_id *def = ir_instruction_def(ins);
+		int v_idx = def ? get_index(*def) : -1;
+		if (v_idx == -1 || !ssa_vars[v_idx].rename)
+			continue;
+
+		struct ssa_var *v = ssa_vars + v_idx;
+		*def = new_version(func, v->var);
+		ADD_ELEMENT(v->stack_size, v->stack_cap, v->stack) = *def;
+		ADD_ELEMENT(def_log_size, def_log_cap, def_log) = v_idx;
+	}
+
+	int n_uses = ir_block_exit_uses(&block->exit, uses);
+	for (int j = 0; j < n_uses; j++)
+		rename_use(uses[j]);
+
+	struct cfg_node *node = cfg->nodes + idx;
+	for (size_t i = 0; i < node->succ_size; i++) {
+		struct block *succ = get_block(func->blocks[node->succs[i]]);
+		for (int j = 0; j < succ->size && succ->instructions[j].type == IR_PHI; j++) {
+			struct instruction *phi = succ->instructions + j;
+			for (int k = 0; k < phi->phi.size; k++) {
+				// Operands are still the original variable when not yet visited.
+				if (phi->phi.blocks[k] == block->id)
+					rename_use(phi->phi.vars + k);
+			}
+		}
+	}
+}
+
+static void pop_log(size_t mark) {
+	while (def_log_size > mark)
+		ssa_vars[def_log[--def_log_size]].stack_size--;
+}
+
+static void rename_variables(struct function *func, struct cfg *cfg) {
+	if (!cfg->order_size)
+		return;
+
+	struct frame {
+		int block;
+		size_t next_child, log_mark;
+	} *stack = malloc(sizeof *stack * cfg->order_size);
+	int stack_size = 0;
+
+	def_log_size = 0;
+	stack[stack_size++] = (struct frame) { .block = 0, .log_mark = def_log_size };
+	rename_block(func, cfg, 0);
+
+	while (stack_size) {
+		struct frame *top = stack + stack_size - 1;
+		struct cfg_node *node = cfg->nodes + top->block;
+		if (top->next_child < node->child_size) {
+			int child = node->children[top->next_child++];
+			stack[stack_size++] = (struct frame) { .block = child, .log_mark = def_log_size };
+			rename_block(func, cfg, child);
+		} else {
+			pop_log(top->log_mark);
+			stack_size--;
+		}
+	}
+
+	// Definitions in unreachable blocks are also renamed,
+	// such that no definitions of the original variables remain.
+	for (int i = 0; i < func->size; i++) {
+		if (cfg->nodes[i].idom != -1)
+			continue;
+		rename_block(func, cfg, i);
+		pop_log(0);
+	}
+
+	free(stack);
+}
+
+void ssa_construct(struct function *func) {
+	if (!func->size)
+		return;
+
+	explicit_fallthrough(func);
+
+	struct cfg cfg;
+	cfg_compute(&cfg, func);
+
+	// The entry block can not have phi nodes, as there is
+	// no predecessor to take the values from.
+	if (cfg.nodes[0].pred_size) {
+		block_id entry = new_block();
+		get_block(entry)->exit = (struct block_exit) {
+			.type = BLOCK_EXIT_JUMP,
+			.jump = func->blocks[0]
+		};
+		add_block_first(func, entry);
+		cfg_free(&cfg);
+		cfg_compute(&cfg, func);
+	}
+
+	find_variables(func);
+	find_definitions(func);
+	find_renamed(func, &cfg);
+	insert_phis(func, &cfg);
+	rename_variables(func, &cfg);
+
+	for (size_t i = 0; i < ssa_vars_size; i++) {
+		var_index[ssa_vars[i].var] = -1;
+		free(ssa_vars[i].def_blocks);
+		free(ssa_vars[i].stack);
+	}
+	for (int i = 0; i < func->var_size; i++) {
+		if (func->vars[i] < var_index_size)
+			var_index[func->vars[i]] = -1;
+	}
+
+	cfg_free(&cfg);
+}
+
+static void retarget(struct block_exit *exit, block_id from, block_id to) {
+	switch (exit->type) {
+	case BLOCK_EXIT_JUMP:
+		if (exit->jump == from)
+			exit->jump = to;
+		break;
+	case BLOCK_EXIT_IF:
+		if (exit->if_.block_true == from)
+			exit->if_.block_true = to;
+		if (exit->if_.block_false == from)
+			exit->if_.block_false = to;
+		break;
+	case BLOCK_EXIT_SWITCH:
+		for (int i = 0; i < exit->switch_.labels.size; i++)
+			if (exit->switch_.labels.labels[i].block == from)
+				exit->switch_.labels.labels[i].block = to;
+		if (exit->switch_.labels.default_ == from)
+			exit->switch_.labels.default_ = to;
+		break;
+	default: break;
+	}
+}
+
+void ssa_destruct(struct function *func) {
+	struct cfg cfg;
+	cfg_compute(&cfg, func);
+
+	size_t targets_size = 0, targets_cap = 0;
+	struct edge_target {
+		block_id pred, target;
+	} *targets = NULL;
+
+	int n_blocks = func->size;
+	for (int i = 0; i < n_blocks; i++) {
+		block_id id = func->blocks[i];
+		int has_phi = 0;
+		for (int j = 0; j < get_block(id)->size; j++)
+			has_phi |= get_block(id)->instructions[j].type == IR_PHI;
+		if (!has_phi)
+			continue;
+
+		// Copies are put at the end of the predecessors. If the predecessor
+		// has other successors, the edge is split by inserting a new block.
+		targets_size = 0;
+		for (size_t j = 0; j < cfg.nodes[i].pred_size; j++) {
+			int pred = cfg.nodes[i].preds[j];
+			block_id pred_id = func->blocks[pred], target = pred_id;
+			if (cfg.nodes[pred].succ_size > 1) {
+				target = new_block();
+				get_block(target)->exit = (struct block_exit) {
+					.type = BLOCK_EXIT_JUMP,
+					.jump = id
+				};
+				retarget(&get_block(pred_id)->exit, id, target);
+				ADD_ELEMENT(func->size, func->cap, func->blocks) = target;
+			}
+			ADD_ELEMENT(targets_size, targets_cap, targets) = (struct edge_target) {
+				pred_id, target
+			};
+		}
+
+		// Passes might have replaced some phis, so they are not
+		// necessarily all at the start of the block.
+		int n_instructions = get_block(id)->size;
+		for (int j = 0; j < n_instructions; j++) {
+			if (get_block(id)->instructions[j].type != IR_PHI)
+				continue;
+
+			// The block might be its own predecessor, so the
+			// instructions can be reallocated while adding copies.
+			struct instruction phi = get_block(id)->instructions[j];
+			var_id tmp = new_version(func, phi.result);
+
+			for (int k = 0; k < phi.phi.size; k++) {
+				block_id target = phi.phi.blocks[k];
+				for (size_t l = 0; l < targets_size; l++)
+					if (targets[l].pred == target)
+						target = targets[l].target;
+
+				struct block *target_block = get_block(target);
+				ADD_ELEMENT(target_block->size, target_block->cap, target_block->instructions) =
+					(struct instruction) {
+					.type = IR_COPY,
+					.result = tmp,
+					.copy = { phi.phi.vars[k] }
+				};
+			}
+
+			free(phi.phi.vars);
+			free(phi.phi.blocks);
+
+			get_block(id)->instructions[j] = (struct instruction) {
+				.type = IR_COPY,
+				.result = phi.result,
+				.copy = { tmp }
+			};
+		}
+	}
+
+	free(targets);
+	cfg_free(&cfg);
+}
@@ -0,0 +1,15 @@
+#ifndef SSA_H
+#define SSA_H
+
+#include "ir.h"
+
+// Rename all scalar variables that are defined more than once, or whose
+// definition does not dominate all uses, and insert IR_PHI where needed.
+// Afterwards each such variable has at most one definition.
+// Variables accessed through their stack location are left untouched.
+void ssa_construct(struct function *func);
+
+// Replace all IR_PHI with copies, splitting critical edges.
+void ssa_destruct(struct function *func);
+
+#endif
@@ -3,9 +3,13 @@
 #include "codegen/codegen.h"
 #include "common.h"
 #include "preprocessor/macro_expander.h"
+#include "preprocessor/tokenizer.h"
 #include "assembler/assembler.h"
 #include "parser/symbols.h"
 #include "abi/abi.h"
+#include "ir/optimize.h"
+#include "pch.h"
+#include "hash_table.h"
 
 #include <time.h>
 #include <stdio.h>
@@ -14,6 +18,11 @@
 struct arguments {
 	const char *input;
 	const char *output;
+	int bench_tokenizer;
+	int hash_stats;
+
+	int emit_pch;
+	const char *include_pch;
 };
 
 struct arguments parse_arguments(int argc, char **argv) {
@@ -31,12 +40,20 @@ struct arguments parse_arguments(int argc, char **argv) {
 	} abi = ABI_SYSV;
 
 	for (int i = 1; i < argc; i++) {
-		if (argv[i][0] == '-' &&
+		if (strcmp(argv[i], "--emit-pch") == 0) {
+			args.emit_pch = 1;
+		} else if (strcmp(argv[i], "-include-pch") == 0) {
+			if (i + 1 >= argc)
+				ARG_ERROR(i, "Expected path to precompiled header.");
+			args.include_pch = argv[++i];
+		} else if (argv[i][0] == '-' &&
 			argv[i][1] == 'I') {
 
 			input_add_include_path(argv[i] + 2);
+			pch_add_flag(argv[i]);
 		} else if (argv[i][0] == '-' &&
 				   argv[i][1] == 'D') {
+			pch_add_flag(strdup(argv[i]));
 			char *name = argv[i] + 2, *value = NULL;
 			for (unsigned j = 2; argv[i][j]; j++) {
 				if (argv[i][j] == '=') {
@@ -64,15 +81,29 @@ struct arguments parse_arguments(int argc, char **argv) {
 				abi = ABI_SYSV;
 			} else if (strcmp(argv[i] + 2, "mingw-workarounds") == 0) {
 				abi_init_mingw_workarounds();
+				pch_add_flag(argv[i]);
 			} else {
 				ARG_ERROR(i, "Invalid flag.");
 			}
+		} else if (argv[i][0] == '-' &&
+				   argv[i][1] == 'O') {
+			if (argv[i][2] == '\0') {
+				optimization_flags.level = 1;
+			} else if (argv[i][2] >= '0' && argv[i][2] <= '2' && argv[i][3] == '\0') {
+				optimization_flags.level = argv[i][2] - '0';
+			} else {
+				ARG_ERROR(i, "Invalid optimization level.");
+			}
 		} else if (argv[i][0] == '-' &&
 				   argv[i][1] == 'd') {
 			if (strcmp(argv[i] + 2, "half-assemble") == 0) {
 				assembler_flags.half_assemble = 1;
 			} else if (strcmp(argv[i] + 2, "elf") == 0) {
 				assembler_flags.elf = 1;
+			} else if (strcmp(argv[i] + 2, "bench-tokenizer") == 0) {
+				args.bench_tokenizer = 1;
+			} else if (strcmp(argv[i] + 2, "hash-stats") == 0) {
+				args.hash_stats = 1;
 			}
 		} else {
 			switch (state) {
@@ -97,15 +128,15 @@ struct arguments parse_arguments(int argc, char **argv) {
 	}
 
 	switch (abi) {
-	case ABI_SYSV: abi_init_sysv(); break;
-	case ABI_MICROSOFT: abi_init_microsoft(); break;
+	case ABI_SYSV: abi_init_sysv(); pch_add_flag("-fabi=sysv"); break;
+	case ABI_MICROSOFT: abi_init_microsoft(); pch_add_flag("-fabi=ms"); break;
 	}
 
 	return args;
 }
 
-void add_implementation_defs(void) {
-	define_string("NULL", "(void*)0");
+// Also called after loading a precompiled header, which was created at another time.
+void add_time_defs(void) {
 	static const char months[][4] = {
 		"Jan", "Feb", "Mar", "Apr", "May", "Jun",
 		"Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
@@ -117,6 +148,11 @@ void add_implementation_defs(void) {
 				  allocate_printf("\"%s %2d %04d\"", months[tm.tm_mon], tm.tm_mday, 1900 + tm.tm_year));
 
 	define_string("__TIME__", allocate_printf("\"%02d:%02d:%02d\"", tm.tm_hour, tm.tm_min, tm.tm_sec));
+}
+
+void add_implementation_defs(void) {
+	define_string("NULL", "(void*)0");
+	add_time_defs();
 	define_string("__STDC__", "1");
 	define_string("__FUNCTION__", "__func__");
 	define_string("__STDC_HOSTED__", "0");
@@ -125,17 +161,38 @@ void add_implementation_defs(void) {
 }
 
 int main(int argc, char **argv) {
-	symbols_init();
-
 	struct arguments arguments = parse_arguments(argc, argv);
 
 	init_source_character_set();
 
 	add_implementation_defs();
 
+	if (arguments.bench_tokenizer) {
+		tokenizer_benchmark(arguments.input);
+		return 0;
+	}
+
+	int first_symbol = symbols_size();
+	parser_flags.record_definitions = arguments.emit_pch;
+
+	if (arguments.include_pch) {
+		pch_load(arguments.include_pch);
+		add_time_defs();
+	}
+
 	preprocessor_init(arguments.input);
 	parse_into_ir();
+
+	if (arguments.emit_pch) {
+		pch_emit(arguments.output, first_symbol);
+		return 0;
+	}
+
+	optimize_ir();
 	codegen(arguments.output);
 
+	if (arguments.hash_stats)
+		hash_table_print_stats();
+
 	return 0;
 }
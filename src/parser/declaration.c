@@ -268,7 +268,7 @@ int parse_enum(struct type_specifiers *ts) {
 		TNEXT();
 	} else {
 		static int anonymous_counter = 0;
-		name = sv_from_str(allocate_printf("<enum-%d>", anonymous_counter++));
+		name = sv_intern_str(allocate_printf("<enum-%d>", anonymous_counter++));
 	}
 
 	if (TACCEPT(T_LBRACE)) {
@@ -341,7 +341,7 @@ int parse_struct(struct type_specifiers *ts) {
 		TNEXT();
 	} else {
 		static int anonymous_counter = 0;
-		name = sv_from_str(allocate_printf("<%d>", anonymous_counter++));
+		name = sv_intern_str(allocate_printf("<%d>", anonymous_counter++));
 	}
 
 	if (TACCEPT(T_LBRACE)) {
@@ -523,7 +523,7 @@ void ast_get_parameters(struct type_ast *ast,
 }
 
 struct type_ast *type_ast_new(struct type_ast ast) {
-	struct type_ast *ret = malloc(sizeof (struct type_ast));
+	struct type_ast *ret = arena_alloc(parser_arena, sizeof (struct type_ast));
 	*ret = ast;
 	return ret;
 }
@@ -648,6 +648,9 @@ struct type *ast_to_type(const struct type_specifiers *ts, const struct type_qua
 					};
 					type = type_create(&params, &type);
 				} else {
+					// Types are compared by the address of the length expression,
+					// so it can not be reused after the declaration is released.
+					length_expr = (struct expr *)arena_copy(&static_ast_arena, length_expr, sizeof *length_expr);
 					struct type params = {
 						.type = TY_VARIABLE_LENGTH_ARRAY,
 						.variable_length_array.length_expr = length_expr,
@@ -1296,6 +1299,9 @@ int parse_init_declarator(struct specifiers s, int external, int *was_func) {
 		}
 	}
 
+	if (external && (has_definition || is_tentative) && parser_flags.record_definitions)
+		ERROR(T0->pos, "Definition of %.*s is not allowed in precompiled header.", name.len, name.str);
+
 	if (!prev_definition) {
 		symbol->is_tentative = is_tentative;
 		symbol->is_global = is_global;
@@ -1319,9 +1325,13 @@ int parse_init_declarator(struct specifiers s, int external, int *was_func) {
 			symbol->label.name = name;
 			symbol->label.type = type;
 
+			// The initializer is used when generating the data, after the
+			// declaration is released.
 			struct initializer init = { 0 };
 			if (has_init) {
+				parser_arena = &static_ast_arena;
 				init = parse_initializer(&type);
+				parser_arena = &ast_arena;
 				symbol->label.type = type;
 			}
 
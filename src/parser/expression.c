@@ -446,7 +446,7 @@ struct expr *expr_new(struct expr expr) {
 
 	check_const_correctness(&expr);
 
-	struct expr *ret = malloc(sizeof *ret);
+	struct expr *ret = arena_alloc(parser_arena, sizeof *ret);
 	*ret = expr;
 
 	return ret;
@@ -944,8 +944,7 @@ void parse_call_parameters(struct expr ***args, int *n_args) {
 
 	*args = NULL;
 	if (pos) {
-		*args = malloc(sizeof **args * pos);
-		memcpy(*args, buffer, sizeof **args * pos);
+		*args = (struct expr **)arena_copy(parser_arena, buffer, sizeof **args * pos);
 	}
 
 	*n_args = pos;
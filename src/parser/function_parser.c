@@ -52,7 +52,7 @@ int parse_labeled_statement(struct jump_blocks jump_blocks) {
 		block_id goto_block = 0;
 
 		for (int i = 0; i < function_scope.size; i++) {
-			if (sv_cmp(label, function_scope.labels[i].label)) {
+			if (label.str == function_scope.labels[i].label.str) {
 				if (function_scope.labels[i].used)
 					ERROR(T0->pos, "Label declared more than once %.*s", label.len, label.str);
 
@@ -382,7 +382,7 @@ int parse_jump_statement(struct jump_blocks jump_blocks) {
 		TNEXT();
 		TEXPECT(T_SEMI_COLON);
 		for (int i = 0; i < function_scope.size; i++) {
-			if (sv_cmp(label, function_scope.labels[i].label)) {
+			if (label.str == function_scope.labels[i].label.str) {
 				ir_goto(function_scope.labels[i].id);
 				ir_block_start(new_block());
 				return 1;
@@ -453,6 +453,7 @@ void parse_function(struct string_view name, struct type *type, int arg_n, var_i
 	symbol->type = IDENT_LABEL;
 	symbol->label.type = type;
 	symbol->label.name = name;
+	symbol->has_definition = 1;
 
 	assert(type->type == TY_FUNCTION);
 
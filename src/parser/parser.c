@@ -4,15 +4,40 @@
 
 #include <common.h>
 #include <preprocessor/preprocessor.h>
+#include <preprocessor/token_list.h>
 
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 
+struct parser_flags parser_flags;
+struct token_list parser_definitions;
+
+struct arena ast_arena, static_ast_arena;
+struct arena *parser_arena = &ast_arena;
+
 void parse_into_ir() {
 	init_variables();
 
-	while (parse_declaration(1) || TACCEPT(T_SEMI_COLON));
+	for (;;) {
+		struct token_list tokens = { 0 };
+		int n_functions = ir.size;
+		if (parser_flags.record_definitions)
+			t_record(&tokens);
+
+		int found = parse_declaration(1) || TACCEPT(T_SEMI_COLON);
+		t_record(NULL);
+
+		if (ir.size != n_functions) {
+			for (int i = 0; i < tokens.size; i++)
+				token_list_add(&parser_definitions, tokens.list[i]);
+		}
+		token_list_free(&tokens);
+		arena_reset(&ast_arena);
+
+		if (!found)
+			break;
+	}
 
 	TEXPECT(T_EOI);
 
@@ -2,11 +2,23 @@
 #define PARSER_H
 
 #include <ir/ir.h>
+#include <arena.h>
 
 enum ir_binary_operator ibo_from_type_and_op(struct type *type, enum operator_type op);
 
 void parse_into_ir(void);
 
-extern struct parser_flags parser_flags;
+extern struct parser_flags {
+	// Keep the tokens of function definitions, used for precompiled headers.
+	int record_definitions;
+} parser_flags;
+
+extern struct token_list parser_definitions;
+
+// Expressions and declarator ASTs are allocated in parser_arena. This is
+// ast_arena, which is released after each top level declaration, except
+// for ASTs that are kept until code generation, such as static initializers.
+extern struct arena ast_arena, static_ast_arena;
+extern struct arena *parser_arena;
 
 #endif
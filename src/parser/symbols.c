@@ -1,6 +1,9 @@
 #include "symbols.h"
 
 #include <common.h>
+#include <pch.h>
+#include <hash_table.h>
+#include <arena.h>
 
 #include <string.h>
 
@@ -27,121 +30,135 @@ struct table_entry {
 		struct symbol_typedef typedef_data;
 	};
 
-	int block, link;
+	int block;
+	// Entry with the same id that this one shadows.
+	struct table_entry *link;
 };
 
-static struct hash_table {
-	int size;
-	int *entries;
-} hash_table;
+// Entries are never moved, they are allocated from an arena and entries
+// of popped scopes are reused through a free list.
+static struct arena entry_arena;
+static struct table_entry *free_entries;
 
-static struct table {
-	int size, cap;
-	struct table_entry *entries;
-} table;
+// Undo log of each scope, the entries added to it in order. The log of
+// the file scope is also the order in which entries are written to
+// precompiled headers.
+static struct scope {
+	size_t size, cap;
+	struct table_entry **entries;
+} *scopes;
+static size_t scopes_cap;
 
 static int current_block = 0;
 
+// Names are interned, so they are hashed and compared by pointer.
 uint32_t hash_entry(struct entry_id id) {
-	return hash32(id.type) ^ sv_hash(id.name);
+	return hash32(id.type) ^ sv_intern_hash(id.name);
 }
 
 int compare_entry(struct entry_id a, struct entry_id b) {
-	return a.type == b.type && sv_cmp(a.name, b.name);
+	return a.type == b.type && a.name.str == b.name.str;
 }
 
-void symbols_push_scope(void) {
-	current_block++;
-}
+// Maps each id to its innermost entry. Shadowed entries with the
+// same id are reached through link, from inner to outer scopes.
+static struct hash_table heads = { .name = "symbols" };
 
-void symbols_pop_scope(void) {
-	current_block--;
-	for (int i = table.size - 1; i >= 0; i--) {
-		struct table_entry *entry = table.entries + i;
-		if (entry->block <= current_block)
-			break;
+static int entry_equal(const void *value, const void *key) {
+	return compare_entry(((const struct table_entry *)value)->id, *(const struct entry_id *)key);
+}
 
-		uint32_t hash = hash_entry(entry->id) % hash_table.size;
+static struct table_entry *get_head(struct entry_id id) {
+	return hash_table_get(&heads, hash_entry(id), entry_equal, &id);
+}
 
-		hash_table.entries[hash] = entry->link;
-		table.size = i;
-	}
+static void set_head(struct entry_id id, struct table_entry *entry) {
+	if (entry)
+		hash_table_set(&heads, hash_entry(id), entry_equal, &id, entry);
+	else
+		hash_table_remove(&heads, hash_entry(id), entry_equal, &id);
 }
 
-struct table_entry *get_entry(struct entry_id id, int global) {
-	uint32_t hash = hash_entry(id) % hash_table.size;
-	int current_idx = hash_table.entries[hash];
-
-	while (current_idx >= 0) {
-		struct table_entry *entry = table.entries + current_idx;
-		if (compare_entry(entry->id, id) &&
-			!(global && entry->block != 0)) {
-			return entry;
-		}
-		current_idx = entry->link;
+static struct scope *get_scope(int block) {
+	if ((size_t)block >= scopes_cap) {
+		size_t old_cap = scopes_cap;
+		while ((size_t)block >= scopes_cap)
+			scopes_cap = MAX(scopes_cap * 2, 16);
+		scopes = realloc(scopes, sizeof *scopes * scopes_cap);
+		memset(scopes + old_cap, 0, sizeof *scopes * (scopes_cap - old_cap));
 	}
-
-	return NULL;
+	return scopes + block;
 }
 
-struct table_entry *add_entry_with_block(struct entry_id id, int block) {
-	// Move entire table one step down for entry->block > block.
-	(void)ADD_ELEMENT(table.size, table.cap, table.entries);
+void symbols_push_scope(void) {
+	current_block++;
+}
 
-	int i;
-	for (i = table.size - 2; i >= 0; i--) {
-		struct table_entry *entry = table.entries + i;
-		if (entry->block > block) {
-			uint32_t hash = hash_entry(entry->id) % hash_table.size;
+// Entries of the innermost scope are always at the front of their chains.
+void symbols_pop_scope(void) {
+	struct scope *scope = get_scope(current_block);
+	for (size_t i = scope->size; i-- > 0;) {
+		struct table_entry *entry = scope->entries[i];
+		set_head(entry->id, entry->link);
+		entry->link = free_entries;
+		free_entries = entry;
+	}
+	scope->size = 0;
+	current_block--;
+}
 
-			if (hash_table.entries[hash] == i)
-				hash_table.entries[hash]++;
+struct table_entry *get_entry(struct entry_id id, int global) {
+	struct table_entry *entry = get_head(id);
 
-			if (entry->link >= 0 && table.entries[entry->link].block > block) {
-				entry->link++;
-			}
+	while (entry && global && entry->block != 0)
+		entry = entry->link;
 
-			table.entries[i + 1] = *entry;
-		} else {
-			break;
-		}
-	}
-	i++;
+	return entry;
+}
 
-	uint32_t hash = hash_entry(id) % hash_table.size;
-	int *link = &hash_table.entries[hash];
-	while (*link >= 0 && *link > i) {
-		struct table_entry *entry = table.entries + *link;
-		link = &entry->link;
-	}
+static struct table_entry *new_entry(struct entry_id id, int block) {
+	struct table_entry *entry = free_entries;
+	if (entry)
+		free_entries = entry->link;
+	else
+		entry = arena_alloc(&entry_arena, sizeof *entry);
 
-	table.entries[i] = (struct table_entry) {
-		.id.name = id.name,
-		.id.type = id.type,
+	*entry = (struct table_entry) {
+		.id = id,
 		.block = block,
-		.link = *link,
 	};
 
-	*link = i;
-
-	return table.entries + i;
+	struct scope *scope = get_scope(block);
+	ADD_ELEMENT(scope->size, scope->cap, scope->entries) = entry;
+	return entry;
 }
 
-struct table_entry *add_entry(struct entry_id id) {
-	uint32_t hash = hash_entry(id) % hash_table.size;
+// The entry is placed behind the entries of deeper scopes with the same id,
+// so only those are visited.
+struct table_entry *add_entry_with_block(struct entry_id id, int block) {
+	struct table_entry *entry = new_entry(id, block);
 
-	struct table_entry *new_entry = &ADD_ELEMENT(table.size, table.cap, table.entries);
+	struct table_entry *head = get_head(id);
+	if (!head || head->block <= block) {
+		entry->link = head;
+		set_head(id, entry);
+		return entry;
+	}
 
-	*new_entry = (struct table_entry) {
-		.id.name = id.name,
-		.id.type = id.type,
-		.block = current_block,
-		.link = hash_table.entries[hash],
-	};
+	struct table_entry *prev = head;
+	while (prev->link && prev->link->block > block)
+		prev = prev->link;
 
-	hash_table.entries[hash] = table.size - 1;
+	entry->link = prev->link;
+	prev->link = entry;
+	return entry;
+}
 
-	return new_entry;
+struct table_entry *add_entry(struct entry_id id) {
+	struct table_entry *entry = new_entry(id, current_block);
+	entry->link = get_head(id);
+	set_head(id, entry);
+	return entry;
 }
 
 // table_entry querying.
@@ -234,10 +251,153 @@ struct symbol_typedef *symbols_get_typedef(struct string_view name) {
 	return entry ? &entry->typedef_data : NULL;
 }
 
-// Init everything. Called from main.
-void symbols_init(void) {
-	hash_table.size = 1024;
-	hash_table.entries = malloc(sizeof *hash_table.entries * hash_table.size);
-	for (int i = 0; i < hash_table.size; i++)
-		hash_table.entries[i] = -1;
+int symbols_size(void) {
+	return get_scope(0)->size;
+}
+
+static void seed_entry(struct table_entry *entry) {
+	switch (entry->id.type) {
+	case ENTRY_TYPEDEF:
+		pch_seed_type(entry->typedef_data.data_type);
+		break;
+	case ENTRY_STRUCT:
+		if (entry->struct_data.struct_data)
+			pch_seed_type(type_struct(entry->struct_data.struct_data));
+		break;
+	case ENTRY_IDENTIFIER:
+		pch_seed_type(symbols_get_identifier_type(&entry->identifier_data));
+		break;
+	}
+}
+
+static void write_identifier(struct string_view name, struct symbol_identifier *symbol) {
+	pch_write_int(symbol->type);
+	pch_write_int(symbol->is_global);
+	pch_write_int(symbol->is_register);
+
+	switch (symbol->type) {
+	case IDENT_LABEL:
+		pch_write_type(symbol->label.type);
+		pch_write_sv(symbol->label.name);
+		break;
+
+	case IDENT_CONSTANT:
+		if (symbol->constant.type != CONSTANT_TYPE)
+			NOTIMP();
+		pch_write_type(symbol->constant.data_type);
+		pch_write_u64(symbol->constant.uint_d);
+		break;
+
+	default:
+		ICE("Global variable %.*s can't be precompiled", name.len, name.str);
+	}
+}
+
+static void read_identifier(struct symbol_identifier *symbol) {
+	symbol->type = pch_read_int();
+	symbol->is_global = pch_read_int();
+	symbol->is_register = pch_read_int();
+
+	switch (symbol->type) {
+	case IDENT_LABEL:
+		symbol->label.type = pch_read_type();
+		symbol->label.name = pch_read_sv();
+		break;
+
+	case IDENT_CONSTANT:
+		symbol->constant.type = CONSTANT_TYPE;
+		symbol->constant.data_type = pch_read_type();
+		symbol->constant.uint_d = pch_read_u64();
+		break;
+
+	default:
+		ICE("Invalid identifier in precompiled header");
+	}
+}
+
+// Defined functions are added again when their definitions are parsed, and
+// anonymous structs get new names, reachable only through their types.
+static int is_skipped(struct table_entry *entry) {
+	if (entry->id.type == ENTRY_STRUCT)
+		return entry->id.name.len && entry->id.name.str[0] == '<';
+	return entry->id.type == ENTRY_IDENTIFIER && entry->identifier_data.has_definition;
+}
+
+// Only the file scope is written, which is all that is left after parsing.
+void symbols_write_pch(int first) {
+	struct scope *file_scope = get_scope(0);
+	pch_write_int(first);
+	for (int i = 0; i < first; i++)
+		seed_entry(file_scope->entries[i]);
+
+	int n = 0;
+	for (size_t i = first; i < file_scope->size; i++)
+		n += !is_skipped(file_scope->entries[i]);
+
+	pch_write_int(n);
+	for (size_t i = first; i < file_scope->size; i++) {
+		struct table_entry *entry = file_scope->entries[i];
+		if (is_skipped(entry))
+			continue;
+
+		pch_write_int(entry->id.type);
+		pch_write_sv(entry->id.name);
+
+		switch (entry->id.type) {
+		case ENTRY_TYPEDEF:
+			pch_write_type(entry->typedef_data.data_type);
+			break;
+
+		case ENTRY_STRUCT:
+			pch_write_int(entry->struct_data.type);
+			pch_write_struct(entry->struct_data.struct_data);
+			pch_write_int(entry->struct_data.enum_data != NULL);
+			if (entry->struct_data.enum_data) {
+				pch_write_sv(entry->struct_data.enum_data->name);
+				pch_write_int(entry->struct_data.enum_data->is_complete);
+			}
+			break;
+
+		case ENTRY_IDENTIFIER:
+			write_identifier(entry->id.name, &entry->identifier_data);
+			break;
+		}
+	}
+}
+
+void symbols_read_pch(void) {
+	struct scope *file_scope = get_scope(0);
+	int first = pch_read_int();
+	if ((size_t)first != file_scope->size)
+		ICE("Precompiled header was created with a different ABI");
+	for (int i = 0; i < first; i++)
+		seed_entry(file_scope->entries[i]);
+
+	int n = pch_read_int();
+	for (int i = 0; i < n; i++) {
+		struct entry_id id = { .type = pch_read_int() };
+		id.name = sv_intern(pch_read_sv());
+		struct table_entry *entry = add_entry(id);
+
+		switch (id.type) {
+		case ENTRY_TYPEDEF:
+			entry->typedef_data.data_type = pch_read_type();
+			break;
+
+		case ENTRY_STRUCT:
+			entry->struct_data.type = pch_read_int();
+			entry->struct_data.struct_data = pch_read_struct();
+			if (pch_read_int()) {
+				struct enum_data *data = register_enum();
+				data->name = pch_read_sv();
+				data->is_complete = pch_read_int();
+				entry->struct_data.enum_data = data;
+			}
+			break;
+
+		case ENTRY_IDENTIFIER:
+			read_identifier(&entry->identifier_data);
+			break;
+		}
+	}
 }
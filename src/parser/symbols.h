@@ -14,7 +14,6 @@
 
 void symbols_push_scope(void);
 void symbols_pop_scope(void);
-void symbols_init(void);
 
 struct symbol_identifier {
 	enum {
@@ -75,4 +74,9 @@ struct symbol_typedef {
 struct symbol_typedef *symbols_add_typedef(struct string_view name);
 struct symbol_typedef *symbols_get_typedef(struct string_view name);
 
+// Serialization of the file scope for precompiled headers.
+int symbols_size(void);
+void symbols_write_pch(int first);
+void symbols_read_pch(void);
+
 #endif
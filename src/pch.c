@@ -0,0 +1,409 @@
+#include "pch.h"
+#include "common.h"
+
+#include <parser/symbols.h>
+#include <preprocessor/macro_expander.h>
+#include <preprocessor/preprocessor.h>
+#include <parser/parser.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#define PCH_MAGIC "CCPCH2\n"
+
+#define REF_NULL -1
+#define REF_NEW -2
+
+// Maps pointers to their index in the file, open addressing.
+struct pointer_map {
+	int size, cap;
+	struct pointer_entry {
+		const void *key;
+		int value;
+	} *entries;
+};
+
+static uint32_t pointer_hash(const void *key) {
+	uint64_t k = (uint64_t)key;
+	return hash32(k ^ (k >> 32));
+}
+
+static void pointer_map_set(struct pointer_map *map, const void *key, int value);
+
+static void pointer_map_grow(struct pointer_map *map) {
+	struct pointer_map old = *map;
+	map->cap = old.cap ? old.cap * 2 : 256;
+	map->size = 0;
+	map->entries = calloc(map->cap, sizeof *map->entries);
+
+	for (int i = 0; i < old.cap; i++)
+		if (old.entries[i].key)
+			pointer_map_set(map, old.entries[i].key, old.entries[i].value);
+	free(old.entries);
+}
+
+static struct pointer_entry *pointer_map_find(struct pointer_map *map, const void *key) {
+	uint32_t idx = pointer_hash(key) & (map->cap - 1);
+	while (map->entries[idx].key && map->entries[idx].key != key)
+		idx = (idx + 1) & (map->cap - 1);
+	return map->entries + idx;
+}
+
+static void pointer_map_set(struct pointer_map *map, const void *key, int value) {
+	if ((map->size + 1) * 2 > map->cap)
+		pointer_map_grow(map);
+
+	struct pointer_entry *entry = pointer_map_find(map, key);
+	if (!entry->key)
+		map->size++;
+	entry->key = key;
+	entry->value = value;
+}
+
+static int pointer_map_get(struct pointer_map *map, const void *key) {
+	if (!map->cap)
+		return -1;
+	struct pointer_entry *entry = pointer_map_find(map, key);
+	return entry->key ? entry->value : -1;
+}
+
+// Objects in the order they were written or read, the index in
+// these arrays is used to refer back to them.
+static struct pointer_map type_map, struct_map, string_map;
+
+static size_t types_size, types_cap;
+static struct type **types;
+static size_t structs_size, structs_cap;
+static struct struct_data **structs;
+static size_t strings_size, strings_cap;
+static const char **strings;
+
+static void add_type(struct type *type) {
+	pointer_map_set(&type_map, type, types_size);
+	ADD_ELEMENT(types_size, types_cap, types) = type;
+}
+
+static void add_struct(struct struct_data *data) {
+	pointer_map_set(&struct_map, data, structs_size);
+	ADD_ELEMENT(structs_size, structs_cap, structs) = data;
+}
+
+static void add_string(const char *str) {
+	pointer_map_set(&string_map, str, strings_size);
+	ADD_ELEMENT(strings_size, strings_cap, strings) = str;
+}
+
+static size_t flags_size, flags_cap;
+static const char **flags;
+
+void pch_add_flag(const char *flag) {
+	ADD_ELEMENT(flags_size, flags_cap, flags) = flag;
+}
+
+static char *data;
+static size_t data_size, data_cap, data_pos;
+
+static void write_bytes(const void *bytes, size_t size) {
+	if (data_size + size > data_cap) {
+		while (data_size + size > data_cap)
+			data_cap = data_cap ? data_cap * 2 : 4096;
+		data = realloc(data, data_cap);
+	}
+	memcpy(data + data_size, bytes, size);
+	data_size += size;
+}
+
+static const char *read_bytes(size_t size) {
+	if (data_pos + size > data_size)
+		ICE("Precompiled header is truncated");
+	const char *bytes = data + data_pos;
+	data_pos += size;
+	return bytes;
+}
+
+void pch_write_int(int value) {
+	write_bytes(&value, sizeof value);
+}
+
+int pch_read_int(void) {
+	int value;
+	memcpy(&value, read_bytes(sizeof value), sizeof value);
+	return value;
+}
+
+void pch_write_u64(uint64_t value) {
+	write_bytes(&value, sizeof value);
+}
+
+uint64_t pch_read_u64(void) {
+	uint64_t value;
+	memcpy(&value, read_bytes(sizeof value), sizeof value);
+	return value;
+}
+
+// Strings are null terminated in the file, and are used in place when read.
+void pch_write_sv(struct string_view sv) {
+	pch_write_int(sv.len);
+	write_bytes(sv.str, sv.len);
+	write_bytes("", 1);
+}
+
+struct string_view pch_read_sv(void) {
+	struct string_view sv = { .len = pch_read_int() };
+	sv.str = (char *)read_bytes(sv.len + 1);
+	return sv;
+}
+
+void pch_write_string(const char *str) {
+	int idx = str ? pointer_map_get(&string_map, str) : REF_NULL;
+	if (!str || idx != -1) {
+		pch_write_int(idx);
+		return;
+	}
+
+	pch_write_int(REF_NEW);
+	pch_write_sv(sv_from_str((char *)str));
+	add_string(str);
+}
+
+const char *pch_read_string(void) {
+	int idx = pch_read_int();
+	if (idx == REF_NULL)
+		return NULL;
+	if (idx != REF_NEW)
+		return strings[idx];
+
+	const char *str = pch_read_sv().str;
+	add_string(str);
+	return str;
+}
+
+void pch_write_struct(struct struct_data *data) {
+	int idx = data ? pointer_map_get(&struct_map, data) : REF_NULL;
+	if (!data || idx != -1) {
+		pch_write_int(idx);
+		return;
+	}
+
+	// Registered before the fields, since they can refer back to the struct.
+	pch_write_int(REF_NEW);
+	add_struct(data);
+
+	pch_write_sv(data->name);
+	pch_write_int(data->is_complete);
+	pch_write_int(data->is_union);
+	pch_write_int(data->is_packed);
+	pch_write_int(data->alignment);
+	pch_write_int(data->size);
+	pch_write_int(data->flexible);
+	pch_write_int(data->n);
+	for (int i = 0; i < data->n; i++) {
+		struct field *field = data->fields + i;
+		pch_write_sv(field->name);
+		pch_write_type(field->type);
+		pch_write_int(field->bitfield);
+		pch_write_int(field->offset);
+		pch_write_int(field->bit_offset);
+	}
+}
+
+struct struct_data *pch_read_struct(void) {
+	int idx = pch_read_int();
+	if (idx == REF_NULL)
+		return NULL;
+	if (idx != REF_NEW)
+		return structs[idx];
+
+	struct struct_data *data = register_struct();
+	add_struct(data);
+
+	*data = (struct struct_data) { .name = pch_read_sv() };
+	data->is_complete = pch_read_int();
+	data->is_union = pch_read_int();
+	data->is_packed = pch_read_int();
+	data->alignment = pch_read_int();
+	data->size = pch_read_int();
+	data->flexible = pch_read_int();
+	data->n = pch_read_int();
+	data->fields = malloc(sizeof *data->fields * data->n);
+	for (int i = 0; i < data->n; i++) {
+		struct field *field = data->fields + i;
+		field->name = sv_intern(pch_read_sv());
+		field->type = pch_read_type();
+		field->bitfield = pch_read_int();
+		field->offset = pch_read_int();
+		field->bit_offset = pch_read_int();
+	}
+
+	return data;
+}
+
+void pch_write_tokens(struct token_list *list) {
+	pch_write_int(list->size);
+	for (int i = 0; i < list->size; i++) {
+		struct token *t = list->list + i;
+		pch_write_int(t->type);
+		pch_write_sv(t->str);
+		pch_write_int(t->first_of_line);
+		pch_write_int(t->whitespace);
+		pch_write_string(t->pos.path);
+		pch_write_int(t->pos.line);
+		pch_write_int(t->pos.column);
+	}
+}
+
+void pch_read_tokens(struct token_list *list) {
+	int size = pch_read_int();
+	for (int i = 0; i < size; i++) {
+		struct token t = { .type = pch_read_int() };
+		t.str = pch_read_sv();
+		if (t.type == T_IDENT)
+			t.str = sv_intern(t.str);
+		t.first_of_line = pch_read_int();
+		t.whitespace = pch_read_int();
+		t.pos.path = pch_read_string();
+		t.pos.line = pch_read_int();
+		t.pos.column = pch_read_int();
+		token_list_add(list, t);
+	}
+}
+
+// Children are written before the type is registered, the same order
+// is used when reading, since the type can only be created after them.
+void pch_write_type(struct type *type) {
+	int idx = type ? pointer_map_get(&type_map, type) : REF_NULL;
+	if (!type || idx != -1) {
+		pch_write_int(idx);
+		return;
+	}
+
+	pch_write_int(REF_NEW);
+	pch_write_int(type->type);
+	pch_write_int(type->is_const);
+	pch_write_int(type->n);
+
+	switch (type->type) {
+	case TY_SIMPLE: pch_write_int(type->simple); break;
+	case TY_ARRAY: pch_write_u64(type->array.length); break;
+	case TY_FUNCTION: pch_write_int(type->function.is_variadic); break;
+	case TY_STRUCT: pch_write_struct(type->struct_data); break;
+	case TY_POINTER: case TY_INCOMPLETE_ARRAY: break;
+	default: ICE("Type %s can't be precompiled", dbg_type(type));
+	}
+
+	for (int i = 0; i < type->n; i++)
+		pch_write_type(type->children[i]);
+
+	add_type(type);
+}
+
+struct type *pch_read_type(void) {
+	int idx = pch_read_int();
+	if (idx == REF_NULL)
+		return NULL;
+	if (idx != REF_NEW)
+		return types[idx];
+
+	struct type params = { .type = pch_read_int() };
+	params.is_const = pch_read_int();
+	params.n = pch_read_int();
+
+	switch (params.type) {
+	case TY_SIMPLE: params.simple = pch_read_int(); break;
+	case TY_ARRAY: params.array.length = pch_read_u64(); break;
+	case TY_FUNCTION: params.function.is_variadic = pch_read_int(); break;
+	case TY_STRUCT: params.struct_data = pch_read_struct(); break;
+	case TY_POINTER: case TY_INCOMPLETE_ARRAY: break;
+	default: ICE("Invalid type in precompiled header");
+	}
+
+	struct type **children = malloc(sizeof *children * params.n);
+	for (int i = 0; i < params.n; i++)
+		children[i] = pch_read_type();
+
+	struct type *type = type_create(&params, children);
+	free(children);
+
+	add_type(type);
+	return type;
+}
+
+static void seed_struct(struct struct_data *data) {
+	if (!data || pointer_map_get(&struct_map, data) != -1)
+		return;
+
+	add_struct(data);
+	for (int i = 0; i < data->n; i++)
+		pch_seed_type(data->fields[i].type);
+}
+
+void pch_seed_type(struct type *type) {
+	if (!type || pointer_map_get(&type_map, type) != -1)
+		return;
+
+	for (int i = 0; i < type->n; i++)
+		pch_seed_type(type->children[i]);
+
+	if (type->type == TY_STRUCT)
+		seed_struct(type->struct_data);
+
+	add_type(type);
+}
+
+void pch_emit(const char *path, int first_symbol) {
+	write_bytes(PCH_MAGIC, sizeof PCH_MAGIC - 1);
+
+	pch_write_int(flags_size);
+	for (size_t i = 0; i < flags_size; i++)
+		pch_write_string(flags[i]);
+
+	input_write_pch();
+	define_map_write_pch();
+	symbols_write_pch(first_symbol);
+	pch_write_tokens(&parser_definitions);
+
+	FILE *fp = fopen(path, "wb");
+	if (!fp || fwrite(data, 1, data_size, fp) != data_size || fclose(fp))
+		ICE("Could not write precompiled header %s", path);
+}
+
+void pch_load(const char *path) {
+	FILE *fp = fopen(path, "rb");
+	if (!fp)
+		ICE("Could not open precompiled header %s", path);
+
+	fseek(fp, 0, SEEK_END);
+	data_size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	// The contents are kept, since strings are used in place.
+	data = malloc(data_size);
+	if (fread(data, 1, data_size, fp) != data_size)
+		ICE("Could not read precompiled header %s", path);
+	fclose(fp);
+
+	if (strncmp(read_bytes(sizeof PCH_MAGIC - 1), PCH_MAGIC, sizeof PCH_MAGIC - 1) != 0)
+		ICE("%s is not a precompiled header", path);
+
+	struct position pos = { .path = path };
+	int n_flags = pch_read_int();
+	for (int i = 0; i < n_flags || i < (int)flags_size; i++) {
+		const char *flag = i < n_flags ? pch_read_string() : NULL;
+		const char *current = i < (int)flags_size ? flags[i] : NULL;
+		if (!flag || !current || strcmp(flag, current) != 0)
+			ERROR(pos, "Precompiled header was created with flag %s, but is used with %s.",
+				  flag ? flag : "(none)", current ? current : "(none)");
+	}
+
+	input_read_pch();
+	define_map_read_pch();
+	symbols_read_pch();
+
+	// Function definitions are parsed again as part of the translation unit.
+	struct token_list definitions = { 0 };
+	pch_read_tokens(&definitions);
+	t_replay(definitions);
+
+	if (data_pos != data_size)
+		ICE("Precompiled header %s has trailing data", path);
+}
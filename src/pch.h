@@ -0,0 +1,51 @@
+#ifndef PCH_H
+#define PCH_H
+
+#include <types.h>
+#include <string_view.h>
+#include <preprocessor/token_list.h>
+
+#include <stdint.h>
+
+// Precompiled headers. A header is preprocessed and parsed once, and the
+// resulting macros, symbols and types are written to a file. Loading the
+// file is equivalent to including the header.
+// Function definitions are kept as tokens and parsed again when loading,
+// other definitions in the header are an error.
+
+// first_symbol is the number of symbols that existed before the header
+// was parsed, these are created by the ABI and are not written.
+void pch_emit(const char *path, int first_symbol);
+void pch_load(const char *path);
+
+// Command line flags that change how the header is parsed. Loading fails
+// unless the same flags were given in the same order when it was created.
+void pch_add_flag(const char *flag);
+
+// Serialization used by the modules that own the state.
+void pch_write_int(int value);
+int pch_read_int(void);
+void pch_write_u64(uint64_t value);
+uint64_t pch_read_u64(void);
+
+void pch_write_sv(struct string_view sv);
+struct string_view pch_read_sv(void);
+
+// Strings are written once, later writes of the same pointer refer back to it.
+void pch_write_string(const char *str);
+const char *pch_read_string(void);
+
+void pch_write_tokens(struct token_list *list);
+void pch_read_tokens(struct token_list *list);
+
+// Types and structs are written once, and types are interned again on load.
+void pch_write_type(struct type *type);
+struct type *pch_read_type(void);
+void pch_write_struct(struct struct_data *data);
+struct struct_data *pch_read_struct(void);
+
+// Types that exist before the header is parsed are not written, but are
+// registered in the same order by both the writer and the reader.
+void pch_seed_type(struct type *type);
+
+#endif
@@ -0,0 +1,156 @@
+#include "hide_set.h"
+
+#include <common.h>
+#include <arena.h>
+#include <hash_table.h>
+
+#include <string.h>
+
+static struct arena hide_set_arena;
+static struct hash_table hide_sets = { .name = "hide sets" };
+static uint32_t hide_set_count;
+
+struct set_key {
+	int size;
+	const uint32_t *names;
+};
+
+static uint32_t set_hash(struct set_key key) {
+	uint32_t hash = key.size;
+	for (int i = 0; i < key.size; i++)
+		hash = hash32(hash ^ key.names[i]);
+	return hash;
+}
+
+static int set_equal(const void *value, const void *key) {
+	const struct hide_set *set = value;
+	const struct set_key *k = key;
+	return set->size == k->size && memcmp(set->names, k->names, sizeof *k->names * k->size) == 0;
+}
+
+static const struct hide_set *set_get(struct set_key key) {
+	if (!key.size)
+		return NULL;
+
+	uint32_t hash = set_hash(key);
+	struct hide_set *set = hash_table_get(&hide_sets, hash, set_equal, &key);
+	if (set)
+		return set;
+
+	set = arena_alloc(&hide_set_arena, sizeof *set + sizeof *set->names * key.size);
+	set->id = hide_set_count++;
+	set->size = key.size;
+	memcpy(set->names, key.names, sizeof *key.names * key.size);
+	hash_table_set(&hide_sets, hash, set_equal, &key, set);
+	return set;
+}
+
+// Results of operations on two sets, keyed by the ids of the operands.
+enum set_op {
+	OP_UNION,
+	OP_INTERSECTION,
+};
+
+struct op_result {
+	enum set_op op;
+	uint32_t a, b;
+	const struct hide_set *result;
+};
+
+static struct hash_table op_results = { .name = "hide set operations" };
+
+static int op_equal(const void *value, const void *key) {
+	const struct op_result *r = value, *k = key;
+	return r->op == k->op && r->a == k->a && r->b == k->b;
+}
+
+static size_t scratch_size, scratch_cap;
+static uint32_t *scratch;
+
+static const struct hide_set *compute(enum set_op op, const struct hide_set *a, const struct hide_set *b) {
+	scratch_size = 0;
+	int i = 0, j = 0;
+	while (i < a->size && j < b->size) {
+		if (a->names[i] == b->names[j]) {
+			ADD_ELEMENT(scratch_size, scratch_cap, scratch) = a->names[i];
+			i++;
+			j++;
+		} else if (a->names[i] < b->names[j]) {
+			if (op == OP_UNION)
+				ADD_ELEMENT(scratch_size, scratch_cap, scratch) = a->names[i];
+			i++;
+		} else {
+			if (op == OP_UNION)
+				ADD_ELEMENT(scratch_size, scratch_cap, scratch) = b->names[j];
+			j++;
+		}
+	}
+
+	if (op == OP_UNION) {
+		for (; i < a->size; i++)
+			ADD_ELEMENT(scratch_size, scratch_cap, scratch) = a->names[i];
+		for (; j < b->size; j++)
+			ADD_ELEMENT(scratch_size, scratch_cap, scratch) = b->names[j];
+	}
+
+	return set_get((struct set_key) { .size = scratch_size, .names = scratch });
+}
+
+static const struct hide_set *operation(enum set_op op, const struct hide_set *a, const struct hide_set *b) {
+	// Both operations are commutative.
+	if (a->id > b->id) {
+		const struct hide_set *tmp = a;
+		a = b;
+		b = tmp;
+	}
+
+	struct op_result key = { .op = op, .a = a->id, .b = b->id };
+	uint32_t hash = hash32(hash32(key.a ^ ((uint32_t)op << 31)) ^ key.b);
+	struct op_result *r = hash_table_get(&op_results, hash, op_equal, &key);
+	if (r)
+		return r->result;
+
+	key.result = compute(op, a, b);
+	r = arena_alloc(&hide_set_arena, sizeof *r);
+	*r = key;
+	hash_table_set(&op_results, hash, op_equal, &key, r);
+	return r->result;
+}
+
+const struct hide_set *hide_set_union(const struct hide_set *a, const struct hide_set *b) {
+	if (!a || a == b)
+		return b;
+	if (!b)
+		return a;
+	return operation(OP_UNION, a, b);
+}
+
+const struct hide_set *hide_set_intersection(const struct hide_set *a, const struct hide_set *b) {
+	if (!a || !b)
+		return NULL;
+	if (a == b)
+		return a;
+	return operation(OP_INTERSECTION, a, b);
+}
+
+const struct hide_set *hide_set_insert(const struct hide_set *a, uint32_t name) {
+	const struct hide_set *single = set_get((struct set_key) { .size = 1, .names = &name });
+	return hide_set_union(a, single);
+}
+
+int hide_set_contains(const struct hide_set *a, uint32_t name) {
+	if (!a)
+		return 0;
+
+	int low = 0, high = a->size;
+	while (low < high) {
+		int mid = (low + high) / 2;
+		if (a->names[mid] == name)
+			return 1;
+		else if (a->names[mid] < name)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return 0;
+}
@@ -0,0 +1,21 @@
+#ifndef HIDE_SET_H
+#define HIDE_SET_H
+
+#include <stdint.h>
+
+// Sets of macro names, identified by the id of the interned name.
+// Sets are immutable and hash-consed, so equal sets are the same pointer,
+// and results of union and intersection are memoized.
+// NULL is the empty set.
+struct hide_set {
+	uint32_t id;
+	int size;
+	uint32_t names[];
+};
+
+const struct hide_set *hide_set_union(const struct hide_set *a, const struct hide_set *b);
+const struct hide_set *hide_set_intersection(const struct hide_set *a, const struct hide_set *b);
+const struct hide_set *hide_set_insert(const struct hide_set *a, uint32_t name);
+int hide_set_contains(const struct hide_set *a, uint32_t name);
+
+#endif
@@ -1,101 +1,215 @@
 #include "input.h"
+#include "macro_expander.h"
 
 #include <common.h>
+#include <pch.h>
 
 #include <errno.h>
 #include <assert.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Regular files are mapped into memory. Other files, such as pipes,
+// and files that can not be mapped are read into a buffer. Pseudo files
+// in /proc and similar report a size of 0, and are read until the end.
+// The contents are always followed by a null byte. For mapped files
+// this is the zero filled remainder of the last page.
+static void read_contents(struct input *input, int fd, struct stat st) {
+	int is_regular = S_ISREG(st.st_mode);
+
+	if (is_regular && st.st_size > 0 && st.st_size % sysconf(_SC_PAGESIZE) != 0) {
+		void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map != MAP_FAILED) {
+			input->contents = map;
+			input->contents_size = st.st_size;
+			input->is_mapped = 1;
+			return;
+		}
+	}
 
-void read_contents(struct input *input, FILE *fp) {
-	int c;
-	while ((c = fgetc(fp)) != EOF) {
-		ADD_ELEMENT(input->contents_size, input->contents_cap, input->contents) = c;
+	size_t size = 0, cap = is_regular && st.st_size > 0 ? st.st_size : 4096;
+	char *buffer = malloc(cap + 1);
+	for (;;) {
+		ssize_t n = read(fd, buffer + size, cap - size);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n < 0)
+			ICE("Error reading file %s, %s", input->filename, strerror(errno));
+		if (n == 0)
+			break;
+
+		size += n;
+		if (size == cap) {
+			if (is_regular && st.st_size > 0)
+				break;
+			cap *= 2;
+			buffer = realloc(buffer, cap + 1);
+		}
 	}
-	ADD_ELEMENT(input->contents_size, input->contents_cap, input->contents) = '\0';
+
+	buffer[size] = '\0';
+	input->contents = buffer;
+	input->contents_size = size;
 }
 
-struct input input_create(const char *filename, FILE *fp) {
+static void free_contents(struct input *input) {
+	if (input->is_mapped)
+		munmap((char *)input->contents, input->contents_size);
+	else
+		free((char *)input->contents);
+}
+
+// Line splices are removed before tokenization, their offsets
+// are kept to be able to calculate line numbers.
+static void remove_line_splices(struct input *input) {
+	const char *src = input->contents;
+	size_t size = input->contents_size;
+
+	const char *splice = memchr(src, '\\', size);
+	while (splice && !(splice + 1 < src + size && splice[1] == '\n'))
+		splice = memchr(splice + 1, '\\', src + size - splice - 1);
+
+	if (!splice)
+		return;
+
+	char *dest = malloc(size + 1);
+	size_t dest_size = 0;
+	for (size_t i = 0; i < size;) {
+		if (src[i] == '\\' && i + 1 < size && src[i + 1] == '\n') {
+			ADD_ELEMENT(input->splices_size, input->splices_cap, input->splices) = dest_size;
+			i += 2;
+			continue;
+		}
+
+		const char *next = memchr(src + i + 1, '\\', size - i - 1);
+		size_t len = (next ? (size_t)(next - src) : size) - i;
+		memcpy(dest + dest_size, src + i, len);
+		dest_size += len;
+		i += len;
+	}
+	dest[dest_size] = '\0';
+
+	free_contents(input);
+	input->contents = dest;
+	input->contents_size = dest_size;
+	input->is_mapped = 0;
+}
+
+static struct input input_create(const char *filename, int fd, struct stat st,
+								  struct file_identity *identity) {
 	struct input input = {
 		.filename = filename,
-		.iline = 1, .icol = 1,
+		.identity = identity,
+		.line = 1
 	};
 
-	read_contents(&input, fp);
+	read_contents(&input, fd, st);
+	remove_line_splices(&input);
 
 	// Read, and ignore, BOM (byte order mark).
 	// BOM signifies that the text file is utf-8.
 	// It has the form: 0xef 0xbb 0xbf.
-	if ((unsigned char)input.contents[0] == 0xef &&
+	if (input.contents_size >= 3 &&
+		(unsigned char)input.contents[0] == 0xef &&
 		(unsigned char)input.contents[1] == 0xbb &&
-		(unsigned char)input.contents[2] == 0xbf) {
-		for (int i = 0; i < 3; i++)
-			input_next(&input);
-	}
-
-	// Buffer should be initialized at the start.
-	for (int i = 0; i < N_BUFF - 1; i++)
-		input_next(&input);
-	input.c[0] = '\n'; // Needs to start with newline.
+		(unsigned char)input.contents[2] == 0xbf)
+		input.c_ptr = 3;
 
 	return input;
 }
 
 struct input input_open_string(char *str) {
-	size_t len = strlen(str);
-	struct input input = {
+	return (struct input) {
 		.filename = "<string>",
-		.iline = 1, .icol = 1,
-		.contents_cap = len,
-		.contents_size = len,
+		.line = 1,
+		.contents_size = strlen(str),
 		.contents = str
 	};
+}
 
-	// Buffer should be initialized at the start.
-	for (int i = 0; i < N_BUFF - 1; i++)
-		input_next(&input);
-	input.c[0] = '\n'; // Needs to start with newline.
+struct position input_position(struct input *input, size_t offset) {
+	if (offset < input->pos_offset) {
+		input->pos_offset = input->line_start = input->splice_idx = 0;
+		input->line = 1;
+	}
 
-	return input;
+	// Both newlines and splices start a new line, a newline at n
+	// starts it at n + 1. Splices are at the offset of the next line.
+	size_t scan = input->pos_offset;
+	for (;;) {
+		const char *newline = memchr(input->contents + scan, '\n', offset - scan);
+		size_t newline_break = newline ? (size_t)(newline - input->contents) + 1 : SIZE_MAX;
+		size_t splice_break = input->splice_idx < input->splices_size &&
+			input->splices[input->splice_idx] <= offset ?
+			input->splices[input->splice_idx] : SIZE_MAX;
+
+		if (newline_break == SIZE_MAX && splice_break == SIZE_MAX)
+			break;
+
+		input->line++;
+		if (newline_break <= splice_break) {
+			input->line_start = scan = newline_break;
+		} else {
+			input->line_start = scan = splice_break;
+			input->splice_idx++;
+		}
+	}
+
+	input->pos_offset = offset;
+	return (struct position) {
+		input->filename, input->line, (int)(offset - input->line_start) + 1
+	};
 }
 
-static char next_char(struct input *input) {
-	while (input->c_ptr < input->contents_size - 1 &&
-		input->contents[input->c_ptr] == '\\' &&
-		input->contents[input->c_ptr + 1] == '\n') {
-		input->c_ptr += 2;
-		input->iline++;
-		input->icol = 0;
-	}
+static size_t paths_size = 0, paths_cap;
+static const char **paths = NULL;
 
-	if (input->c_ptr >= input->contents_size)
-		return '\0';
+// Files are identified by device and inode, such that different
+// spellings of the same path are treated as the same file.
+struct file_identity {
+	dev_t dev;
+	ino_t ino;
 
-	if (input->contents[input->c_ptr] == '\n') {
-		input->iline++;
-		input->icol = 0;
-	}
+	// Set by #pragma once.
+	int once;
+	// Interned macro of an include guard covering the whole file, if any.
+	struct string_view guard;
 
-	input->icol++;
+	// Path, modification time and size when first opened. NULL for files
+	// only known from a precompiled header.
+	const char *path;
+	time_t mtime;
+	off_t size;
 
-	return input->contents[input->c_ptr++];
-}
+	struct file_identity *next;
+};
+
+#define IDENTITY_MAP_SIZE 256
+static struct file_identity *identity_map[IDENTITY_MAP_SIZE];
+
+static struct file_identity *get_identity(dev_t dev, ino_t ino) {
+	uint32_t hash_idx = hash32(ino ^ dev) % IDENTITY_MAP_SIZE;
+
+	struct file_identity **it = &identity_map[hash_idx];
+	while (*it && !((*it)->dev == dev && (*it)->ino == ino))
+		it = &(*it)->next;
 
-void input_next(struct input *input) {
-	for (int i = 0; i < N_BUFF - 1; i++) {
-		input->c[i] = input->c[i + 1];
-		input->pos[i] = input->pos[i + 1];
+	if (!*it) {
+		*it = malloc(sizeof **it);
+		**it = (struct file_identity) { .dev = dev, .ino = ino };
 	}
 
-	input->c[N_BUFF - 1] = next_char(input);
-	input->pos[N_BUFF - 1] = (struct position) {
-		input->filename, input->iline, input->icol
-	};
+	return *it;
 }
 
-static size_t paths_size = 0, paths_cap;
-static const char **paths = NULL;
-
-// Used for #pragma once.
-static struct string_set disabled_headers;
+// Files are skipped if they were marked with #pragma once, or if
+// they are include guarded and the guard macro is still defined.
+static int is_disabled(struct file_identity *identity) {
+	return identity->once ||
+		(identity->guard.str && define_map_get(identity->guard));
+}
 
 void input_add_include_path(const char *path) {
 	ADD_ELEMENT(paths_size, paths_cap, paths) = path;
@@ -110,18 +224,18 @@ static int last_slash_pos(const char *str) {
 	return slash_pos;
 }
 
-static FILE *try_open_file(const char *path) {
-	FILE *fp = fopen(path, "r");
-	if (!fp && errno != ENOENT) {
+static int try_open_file(const char *path) {
+	int fd = open(path, O_RDONLY);
+	if (fd == -1 && errno != ENOENT) {
 		char *str = strerror(errno);
 		ICE("Error opening file %s, %s", path, str);
 	}
-	return fp;
+	return fd;
 }
 
 #define BUFFER_SIZE 256
 
-FILE *try_open_local_path(struct input *input, const char *path, char *path_buffer) {
+int try_open_local_path(struct input *input, const char *path, char *path_buffer) {
 	int last_slash = last_slash_pos(input->filename);
 	if (last_slash && path[0] != '/')
 		assert(snprintf(path_buffer, BUFFER_SIZE, "%.*s/%s", last_slash, input->filename, path) < BUFFER_SIZE);
@@ -131,50 +245,133 @@ FILE *try_open_local_path(struct input *input, const char *path, char *path_buff
 }
 
 void input_open(struct input **input, const char *path, int system) {
-	FILE *fp = NULL;
+	int fd = -1;
 
 	char path_buffer[BUFFER_SIZE]; // TODO: Remove arbitrary limit.
 
 	if (*input) {
 		if (!system)
-			fp = try_open_local_path(*input, path, path_buffer);
+			fd = try_open_local_path(*input, path, path_buffer);
 
-		for (unsigned i = 0; !fp && i < paths_size; i++) {
+		for (unsigned i = 0; fd == -1 && i < paths_size; i++) {
 			assert(snprintf(path_buffer, BUFFER_SIZE, "%s/%s", paths[i], path) < BUFFER_SIZE);
-			fp = try_open_file(path_buffer);
+			fd = try_open_file(path_buffer);
 		}
 
-		if (!fp && system)
-			fp = try_open_local_path(*input, path, path_buffer);
+		if (fd == -1 && system)
+			fd = try_open_local_path(*input, path, path_buffer);
 	} else {
 		assert(snprintf(path_buffer, BUFFER_SIZE, "%s", path) < BUFFER_SIZE);
-		fp = try_open_file(path_buffer);
+		fd = try_open_file(path_buffer);
 	}
 
-	if (!fp) {
+	if (fd == -1) {
 		ICE("\"%s\" not found in search path, with origin %s", path, *input ? (*input)->filename : (const char *)".");
 	}
 
-	if (string_set_contains(disabled_headers, sv_from_str(path_buffer))) {
-		fclose(fp);
+	struct stat st;
+	if (fstat(fd, &st) == -1)
+		ICE("Error reading file %s, %s", path_buffer, strerror(errno));
+
+	struct file_identity *identity = get_identity(st.st_dev, st.st_ino);
+	if (!identity->path) {
+		identity->path = strdup(path_buffer);
+		identity->mtime = st.st_mtime;
+		identity->size = st.st_size;
+	}
+
+	if (is_disabled(identity)) {
+		close(fd);
 		return;
 	}
 
 	struct input *n_top = malloc(sizeof *n_top);
-	*n_top = input_create(strdup(path_buffer), fp);
+	*n_top = input_create(strdup(path_buffer), fd, st, identity);
 	n_top->next = *input;
 	*input = n_top;
 
-	fclose(fp);
+	close(fd);
 }
 
 void input_close(struct input **input) {
 	struct input *prev = *input;
 	*input = prev->next;
-	free(prev->contents);
+
+	free_contents(prev);
+	free(prev->splices);
 	free(prev);
 }
 
-void input_disable_path(const char *filename) {
-	string_set_insert(&disabled_headers, strdup(filename));
+void input_end(struct input *input) {
+	if (input->identity && input->guard_state == GUARD_END) {
+		input->identity->guard = input->guard;
+	}
+}
+
+void input_disable(struct input *input) {
+	input->identity->once = 1;
+}
+
+// Files read by a precompiled header are recorded, and loading it fails
+// if any of them has changed since. Files included by the header are
+// skipped in the same way when included again after loading it.
+void input_write_pch(void) {
+	int n = 0, n_files = 0;
+	for (int i = 0; i < IDENTITY_MAP_SIZE; i++) {
+		for (struct file_identity *it = identity_map[i]; it; it = it->next) {
+			n += it->once || it->guard.str;
+			n_files += it->path != NULL;
+		}
+	}
+
+	pch_write_int(n_files);
+	for (int i = 0; i < IDENTITY_MAP_SIZE; i++) {
+		for (struct file_identity *it = identity_map[i]; it; it = it->next) {
+			if (!it->path)
+				continue;
+			pch_write_string(it->path);
+			pch_write_u64(it->dev);
+			pch_write_u64(it->ino);
+			pch_write_u64(it->mtime);
+			pch_write_u64(it->size);
+		}
+	}
+
+	pch_write_int(n);
+	for (int i = 0; i < IDENTITY_MAP_SIZE; i++) {
+		for (struct file_identity *it = identity_map[i]; it; it = it->next) {
+			if (!it->once && !it->guard.str)
+				continue;
+			pch_write_u64(it->dev);
+			pch_write_u64(it->ino);
+			pch_write_int(it->once);
+			pch_write_string(it->guard.str);
+		}
+	}
+}
+
+void input_read_pch(void) {
+	int n_files = pch_read_int();
+	for (int i = 0; i < n_files; i++) {
+		struct position pos = { .path = pch_read_string() };
+		dev_t dev = pch_read_u64();
+		ino_t ino = pch_read_u64();
+		time_t mtime = pch_read_u64();
+		off_t size = pch_read_u64();
+
+		struct stat st;
+		if (stat(pos.path, &st) == -1 || st.st_dev != dev || st.st_ino != ino ||
+			st.st_mtime != mtime || st.st_size != size)
+			ERROR(pos, "File has changed since the precompiled header was created.");
+	}
+
+	int n = pch_read_int();
+	for (int i = 0; i < n; i++) {
+		dev_t dev = pch_read_u64();
+		ino_t ino = pch_read_u64();
+		struct file_identity *identity = get_identity(dev, ino);
+		identity->once = pch_read_int();
+		const char *guard = pch_read_string();
+		identity->guard = guard ? sv_intern_str(guard) : (struct string_view) { 0 };
+	}
 }
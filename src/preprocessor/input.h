@@ -1,9 +1,9 @@
 #ifndef INPUT_H
 #define INPUT_H
 
-#include <stdlib.h>
+#include <string_view.h>
 
-#define N_BUFF 3
+#include <stdlib.h>
 
 struct position {
 	const char *path;
@@ -12,25 +12,62 @@ struct position {
 
 #define PRINT_POS(POS) do { printf("%s:%d:%d", POS.path, POS.line, POS.column); } while(0)
 
+// State of include guard detection, see update_guard in tokenizer.c.
+enum guard_state {
+	GUARD_START,
+	GUARD_IFNDEF,
+	GUARD_NAME,
+	GUARD_OPEN,
+	GUARD_DIRECTIVE,
+	GUARD_END,
+	GUARD_NONE
+};
+
+struct file_identity;
+
 struct input {
 	const char *filename;
 
-	size_t c_ptr, contents_size, contents_cap;
-	char *contents;
+	// Contents with line splices removed, followed by a null byte.
+	// If is_mapped they are mapped directly from the file, otherwise allocated.
+	const char *contents;
+	size_t contents_size;
+	int is_mapped;
+
+	// Offsets in contents where line splices were removed.
+	size_t *splices, splices_size, splices_cap;
+
+	// Offset of the tokenizer while the input is not on top.
+	size_t c_ptr;
 	struct input *next;
 
-	struct position pos[N_BUFF];
-	char c[N_BUFF];
+	// Line of pos_offset, advanced by input_position.
+	size_t pos_offset, line_start, splice_idx;
+	int line;
 
-	int iline, icol;
+	// NULL for strings.
+	struct file_identity *identity;
+	enum guard_state guard_state;
+	int guard_depth;
+	struct string_view guard;
 };
 
-void input_next(struct input *input);
+// Position of the character at offset in contents. This is fast
+// when offset is not smaller than in the previous call.
+struct position input_position(struct input *input, size_t offset);
 
 void input_add_include_path(const char *path);
 void input_open(struct input **input, const char *path, int system);
 void input_close(struct input **input);
-void input_disable_path(const char *filename);
+// Called when the end of the input is reached, records its include guard.
+void input_end(struct input *input);
+
+// Used for #pragma once.
+void input_disable(struct input *input);
+
+// Serialization for precompiled headers.
+void input_write_pch(void);
+void input_read_pch(void);
 
 struct input input_open_string(char *str);
 
@@ -4,6 +4,8 @@
 #include "tokenizer.h"
 
 #include <common.h>
+#include <pch.h>
+#include <hash_table.h>
 
 #include <assert.h>
 
@@ -11,64 +13,81 @@ void expand_buffer(int input, int return_output, struct token *t);
 
 #define NEXT() directiver_next();
 
-#define MAP_SIZE 1024
-struct define_map {
-	struct define **entries;
-};
-
-static struct define_map *define_map = NULL;
-
-void define_map_init(void) {
-	define_map = malloc(sizeof *define_map);
-
-	define_map->entries = malloc(sizeof *define_map->entries * MAP_SIZE);
-	for (size_t i = 0; i < MAP_SIZE; i++) {
-		define_map->entries[i] = NULL;
-	}
-}
-
-struct define **define_map_find(struct string_view name) {
-	if (!define_map)
-		define_map_init();
-
-	uint32_t hash_idx = sv_hash(name) % MAP_SIZE;
-
-	struct define **it = &define_map->entries[hash_idx];
-
-	while (*it && !sv_cmp((*it)->name, name)) {
-		it = &(*it)->next;
-	}
+static struct hash_table define_map = { .name = "macros" };
 
-	return it;
+// Names are interned, so they are hashed and compared by pointer.
+static int define_equal(const void *value, const void *key) {
+	return ((const struct define *)value)->name.str == ((const struct string_view *)key)->str;
 }
 
 void define_map_add(struct define define) {
-	struct define **elem = define_map_find(define.name);
+	uint32_t hash = sv_intern_hash(define.name);
+	struct define *elem = hash_table_get(&define_map, hash, define_equal, &define.name);
 
-	if (*elem) {
-		define.next = (*elem)->next;
-		**elem = define;
+	if (elem) {
+		*elem = define;
 	} else {
-		define.next = NULL;
-		*elem = malloc(sizeof define);
-		**elem = define;
+		elem = malloc(sizeof define);
+		*elem = define;
+		hash_table_set(&define_map, hash, define_equal, &define.name, elem);
 	}
 }
 
 struct define *define_map_get(struct string_view str) {
-	return *define_map_find(str);
+	return hash_table_get(&define_map, sv_intern_hash(str), define_equal, &str);
 }
 
 void define_map_remove(struct string_view str) {
-	struct define **elem = define_map_find(str);
-	if (*elem) {
-		struct define *next = (*elem)->next;
-		free(*elem);
-		*elem = next;
+	struct define *elem = define_map_get(str);
+	if (elem) {
+		hash_table_remove(&define_map, sv_intern_hash(str), define_equal, &str);
+		free(elem);
 		// TODO: Free contents of elem as well.
 	}
 }
 
+void define_map_write_pch(void) {
+	pch_write_int(define_map.size);
+	for (size_t i = 0; i < define_map.cap; i++) {
+		struct define *it = define_map.slots[i].value;
+		if (it) {
+			pch_write_sv(it->name);
+			pch_write_int(it->func);
+			pch_write_int(it->vararg);
+			pch_write_tokens(&it->def);
+			pch_write_tokens(&it->par);
+		}
+	}
+}
+
+// The precompiled macros are all macros defined after the header,
+// including those from the command line, which were checked to be the
+// same. They replace the current macros, such that redefinitions and
+// #undef in the header take effect.
+void define_map_read_pch(void) {
+	size_t n_current = 0;
+	struct string_view *current = malloc(sizeof *current * (define_map.size + 1));
+	for (size_t i = 0; i < define_map.cap; i++) {
+		struct define *it = define_map.slots[i].value;
+		if (it)
+			current[n_current++] = it->name;
+	}
+
+	for (size_t i = 0; i < n_current; i++)
+		define_map_remove(current[i]);
+	free(current);
+
+	int n = pch_read_int();
+	for (int i = 0; i < n; i++) {
+		struct define def = define_init(sv_intern(pch_read_sv()));
+		def.func = pch_read_int();
+		def.vararg = pch_read_int();
+		pch_read_tokens(&def.def);
+		pch_read_tokens(&def.par);
+		define_map_add(def);
+	}
+}
+
 struct define define_init(struct string_view name) {
 	return (struct define) {
 		.name = name,
@@ -98,7 +117,7 @@ int get_param(struct define *def, struct token tok) {
 }
 
 void define_string(char *name, char *value) {
-	struct define def = define_init(sv_from_str(name));
+	struct define def = define_init(sv_intern_str(name));
 	struct input input = input_open_string(value);
 	def.def = tokenizer_whole(&input);
 	define_map_add(def);
@@ -148,7 +167,9 @@ struct token glue(struct token a, struct token b) {
 		ERROR(a.pos, "Invalid paste of %.*s and %.*s", b.str.len, b.str.str, a.str.len, a.str.str);
 
 	ret.str = sv_from_str(allocate_printf("%s%s", sv_to_str(b.str), sv_to_str(a.str))); // TODO: This can be done better.
-	ret.hs = string_set_intersection(a.hs, b.hs);
+	if (ret.type == T_IDENT)
+		ret.str = sv_intern(ret.str);
+	ret.hs = hide_set_intersection(a.hs, b.hs);
 	ret.pos = a.pos;
 
 	return ret;
@@ -166,8 +187,7 @@ static struct string_view stringify_end() {
 	ADD_ELEMENT(stringify_size, stringify_cap, stringify_buffer) = '\"';
 	
 	struct string_view ret = { .len = stringify_size };
-	ret.str = malloc(stringify_size);
-	memcpy(ret.str, stringify_buffer, stringify_size);
+	ret.str = arena_copy(&token_arena, stringify_buffer, stringify_size);
 	return ret;
 }
 
@@ -212,9 +232,7 @@ static struct {
 } output_buffer;
 
 void input_buffer_push(struct token *t) {
-	struct token n_token = *t;
-	n_token.hs = string_set_dup(n_token.hs);
-	ADD_ELEMENT(input_buffer.size, input_buffer.cap, input_buffer.tokens) = n_token;
+	ADD_ELEMENT(input_buffer.size, input_buffer.cap, input_buffer.tokens) = *t;
 }
 
 struct token input_buffer_take(int input) {
@@ -301,7 +319,7 @@ void expand_argument(struct token_list tl, int *concat_with_prev, int concat, in
 	}
 }
 
-void subs_buffer(struct define *def, struct string_set *hs, struct position new_pos, int input) {
+void subs_buffer(struct define *def, const struct hide_set *hs, struct position new_pos, int input) {
 	int n_args = def->par.size;
 	struct token_list *arguments = malloc(sizeof *arguments * n_args);
 
@@ -332,10 +350,10 @@ void subs_buffer(struct define *def, struct string_set *hs, struct position new_
 		EXPECT(&rpar, T_RPAR);
 		finished = 1;
 
-		*hs = string_set_intersection(*hs, rpar.hs);
+		hs = hide_set_intersection(hs, rpar.hs);
 	}
 
-	string_set_insert(hs, sv_to_str(def->name));
+	hs = hide_set_insert(hs, sv_intern_id(def->name));
 
 	size_t input_start = input_buffer.size;
 	int concat_with_prev = 0;
@@ -412,7 +430,7 @@ void subs_buffer(struct define *def, struct string_set *hs, struct position new_
 
 	for(unsigned i = input_start; i < input_buffer.size; i++) {
 		struct token *tok = input_buffer.tokens + i;
-		tok->hs = string_set_union(*hs, tok->hs);
+		tok->hs = hide_set_union(hs, tok->hs);
 	}
 
 	free(arguments);
@@ -426,7 +444,7 @@ void expand_buffer(int input, int return_output, struct token *t) {
 			break;
 
 		struct define *def = NULL;
-		if (top.type != T_IDENT || string_set_contains(top.hs, top.str) ||
+		if (top.type != T_IDENT || hide_set_contains(top.hs, sv_intern_id(top.str)) ||
 			builtin_macros(&top) || !(def = define_map_get(top.str))) {
 			if (return_output) {
 				*t = top;
@@ -441,7 +459,7 @@ void expand_buffer(int input, int return_output, struct token *t) {
 
 		if ((def->func && (input || input_buffer.size) && input_buffer_top(input)->type == T_LPAR) ||
 			!def->func) {
-			subs_buffer(def, &top.hs, top.pos, input);
+			subs_buffer(def, top.hs, top.pos, input);
 		} else {
 			if (return_output) {
 				*t = top;
@@ -5,7 +5,6 @@
 #include "token_list.h"
 
 struct define {
-	struct define *next;
 	struct string_view name;
 	int func;
 	int vararg;
@@ -22,6 +21,10 @@ void define_map_add(struct define def);
 struct define *define_map_get(struct string_view str);
 void define_map_remove(struct string_view name);
 
+// Serialization for precompiled headers.
+void define_map_write_pch(void);
+void define_map_read_pch(void);
+
 struct token expander_next(void);
 
 void expand_token_list(struct token_list *ts);
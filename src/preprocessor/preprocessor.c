@@ -1,24 +1,50 @@
 #include "preprocessor.h"
 #include "tokenizer.h"
 #include "string_concat.h"
+#include "token_list.h"
 
 #include <common.h>
 #include <assert.h>
 
+struct arena token_arena;
+
 struct token_stream {
 	struct token buffer[3], pushed;
 } ts;
 
+static struct token_list *recording, replay;
+static int replay_pos;
+
+void t_record(struct token_list *list) {
+	recording = list;
+}
+
+void t_replay(struct token_list list) {
+	replay = list;
+	replay_pos = 0;
+}
+
+static struct token next_token(void) {
+	if (replay_pos < replay.size)
+		return replay.list[replay_pos++];
+	return string_concat_next();
+}
+
 void t_next() {
+	if (recording)
+		token_list_add(recording, ts.buffer[0]);
+
 	ts.buffer[0] = ts.buffer[1];
 	ts.buffer[1] = ts.buffer[2];
-	ts.buffer[2] = ts.pushed.type ? ts.pushed : string_concat_next();
+	ts.buffer[2] = ts.pushed.type ? ts.pushed : next_token();
 	ts.pushed = (struct token) {0};
 }
 
 void t_push(struct token t) {
 	if (ts.pushed.type != T_NONE)
 		ICE("Pushed buffer overfull.");
+	if (recording)
+		token_list_pop(recording);
 	ts.pushed = ts.buffer[2];
 	ts.buffer[2] = ts.buffer[1];
 	ts.buffer[1] = ts.buffer[0];
@@ -2,9 +2,10 @@
 #define PREPROCESSOR_H
 
 #include "input.h"
-#include "string_set.h"
+#include "hide_set.h"
 
 #include <string_view.h>
+#include <arena.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -31,7 +32,7 @@ struct token {
 
 	struct position pos;
 
-    struct string_set hs; // Hide set. Only unsed internally.
+    const struct hide_set *hs; // Hide set. Only used internally.
 };
 
 #define EXPECT(T0, ETYPE) do {											\
@@ -50,8 +51,17 @@ struct token {
 
 void t_next(void);
 void t_push(struct token t);
+
+// Tokens consumed by the parser are added to list, stop with NULL.
+struct token_list;
+void t_record(struct token_list *list);
+// Tokens of list are returned before the tokens of the input.
+void t_replay(struct token_list list);
 struct token *t_peek(int n);
 
 void preprocessor_init(const char *path);
 
+// Spellings of tokens, kept for the whole translation unit.
+extern struct arena token_arena;
+
 #endif
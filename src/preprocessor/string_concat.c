@@ -5,15 +5,54 @@
 #include <common.h>
 
 #include <assert.h>
+#include <string.h>
 
-static enum ttype get_ident(struct string_view str) {
+// Keywords are looked up in a perfect hash table built from tokens.h,
+// such that identifiers are classified with a single comparison.
+#define KEYWORD_TABLE_SIZE 128
+#define KEYWORD_MAX_LEN 32
+
+static int keyword_hash(const char *str, int len) {
+	return (len + str[0] + 9 * str[1] + 12 * str[len - 1]) & (KEYWORD_TABLE_SIZE - 1);
+}
+
+static struct keyword {
+	const char *str;
+	int len;
+	enum ttype type;
+} keyword_table[KEYWORD_TABLE_SIZE];
+
+static void keyword_add(const char *str, enum ttype type) {
+	int len = strlen(str);
+	struct keyword *keyword = keyword_table + keyword_hash(str, len);
+	if (len < 2 || len > KEYWORD_MAX_LEN || keyword->str)
+		ICE("Keyword %s does not fit in the keyword table, keyword_hash has to be changed.", str);
+	*keyword = (struct keyword) { str, len, type };
+}
+
+static void keyword_table_init(void) {
 #define X(A, B)
 #define SYM(A, B)
-#define KEY(A, B) if(sv_string_cmp(str, B)) { return A; }
+#define KEY(A, B) keyword_add(B, A);
 #include "tokens.h"
 #undef KEY
 #undef X
 #undef SYM
+}
+
+static enum ttype get_ident(struct string_view str) {
+	static int initialized = 0;
+	if (!initialized) {
+		keyword_table_init();
+		initialized = 1;
+	}
+
+	if (str.len < 2 || str.len > KEYWORD_MAX_LEN)
+		return T_IDENT;
+
+	struct keyword *keyword = keyword_table + keyword_hash(str.str, str.len);
+	if (keyword->len == str.len && memcmp(keyword->str, str.str, str.len) == 0)
+		return keyword->type;
 	return T_IDENT;
 }
 
@@ -36,8 +75,7 @@ static void buffer_write(char c) {
 
 static struct string_view buffer_get() {
 	struct string_view ret = { .len = buffer_size };
-	ret.str = malloc(buffer_size);
-	memcpy(ret.str, buffer, buffer_size);
+	ret.str = arena_copy(&token_arena, buffer, buffer_size);
 	return ret;
 }
 
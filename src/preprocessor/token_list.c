@@ -14,9 +14,10 @@ void token_list_pop(struct token_list *list) {
 	list->size--;
 }
 
+// Only used for identifiers, which are interned.
 int token_list_index_of(struct token_list *list, struct token t) {
 	for (int i = 0; i < list->size; i++) {
-		if (sv_cmp(list->list[i].str, t.str)) return i;
+		if (list->list[i].str.str == t.str.str) return i;
 	}
 	return -1;
 }
@@ -5,13 +5,19 @@
 
 #include <string.h>
 #include <limits.h>
+#include <time.h>
 
 static struct input *input;
 
-#define C0 (input->c[0])
-#define C1 (input->c[1])
-#define C2 (input->c[2])
-#define CNEXT() input_next(input)
+// Scanning position in the contents of the top input. The contents
+// are null terminated, so looking ahead never reads past the end.
+static const char *cur, *limit;
+static int start_of_input;
+
+#define C0 (cur[0])
+#define C1 (cur[1])
+#define C2 (cur[2])
+#define CNEXT() (cur++)
 
 enum {
 	C_DIGIT = 0x1,
@@ -37,33 +43,102 @@ static const unsigned char char_props[UCHAR_MAX] = {
 
 #define HAS_PROP(C, PROP) (char_props[(unsigned char)(C)] & (PROP))
 
+static void save_input(void) {
+	if (input)
+		input->c_ptr = cur - input->contents;
+}
+
+static void load_input(void) {
+	cur = input->contents + input->c_ptr;
+	limit = input->contents + input->contents_size;
+}
+
+static struct position current_position(void) {
+	return input_position(input, cur - input->contents);
+}
+
 void tokenizer_push_input(const char *path, int system) {
+	struct input *prev = input;
+	save_input();
 	input_open(&input, path, system); // <- TODO: System.
+	if (input != prev) {
+		load_input();
+		start_of_input = 1;
+	}
 }
 
 void tokenizer_disable_current_path(void) {
-	input_disable_path(input->filename);
+	input_disable(input);
+}
+
+// Whitespace and comments are skipped a word at a time. Runs of spaces,
+// tabs and newlines are checked 8 bytes at once, and the ends of comments
+// are found with memchr. The scalar versions are kept for comparison.
+static int scalar_skip;
+
+#define ONES 0x0101010101010101ull
+#define LOW7 0x7f7f7f7f7f7f7f7full
+#define HIGH 0x8080808080808080ull
+
+// Sets the high bit of each byte in word that is equal to c.
+static uint64_t match_bytes(uint64_t word, unsigned char c) {
+	uint64_t x = word ^ (ONES * c);
+	return ~(((x & LOW7) + LOW7) | x | LOW7);
+}
+
+static const char *skip_spaces(const char *p, int *newline) {
+	for (; !scalar_skip && limit - p >= 8; p += 8) {
+		uint64_t word;
+		memcpy(&word, p, sizeof word);
+		uint64_t newlines = match_bytes(word, '\n');
+		if ((match_bytes(word, ' ') | match_bytes(word, '\t') | newlines) != HIGH)
+			break;
+		if (newlines)
+			*newline = 1;
+	}
+
+	for (; HAS_PROP(*p, C_SPACE); p++)
+		if (*p == '\n')
+			*newline = 1;
+	return p;
+}
+
+static const char *find_newline(const char *p) {
+	if (!scalar_skip) {
+		const char *end = memchr(p, '\n', limit - p);
+		return end ? end : limit;
+	}
+
+	while (p < limit && *p != '\n')
+		p++;
+	return p;
+}
+
+// Returns pointer to the "*/" ending the comment, or NULL.
+static const char *find_comment_end(const char *p) {
+	if (!scalar_skip) {
+		while ((p = memchr(p, '*', limit - p)) && p[1] != '/')
+			p++;
+		return p;
+	}
+
+	for (; p < limit; p++)
+		if (p[0] == '*' && p[1] == '/')
+			return p;
+	return NULL;
 }
 
 static void flush_whitespace(int *whitespace, int *first_of_line) {
 	for (;;) {
 		if (HAS_PROP(C0, C_SPACE)) {
-			if(C0 == '\n')
-				*first_of_line = 1;
-
-			CNEXT();
+			cur = skip_spaces(cur, first_of_line);
 		} else if (C0 == '/' && C1 == '*') {
-			while (!(C0 == '*' && C1 == '/')) {
-				CNEXT();
-
-				if (C0 == '\0')
-					ERROR(input->pos[0], "Comment reached end of file");
-			}
-			CNEXT();
-			CNEXT();
+			const char *end = find_comment_end(cur + 2);
+			if (!end)
+				ERROR(current_position(), "Comment reached end of file");
+			cur = end + 2;
 		} else if (C0 == '/' && C1 == '/') {
-			while (C0 != '\n' && C0 != '\0')
-				CNEXT();
+			cur = find_newline(cur);
 		} else {
 			break;
 		}
@@ -71,22 +146,21 @@ static void flush_whitespace(int *whitespace, int *first_of_line) {
 	}
 }
 
-static char *buffer = NULL;
-static size_t buffer_size = 0, buffer_cap = 0;
+// Tokens are copied out of the contents, since these are released
+// when the input is closed.
+static const char *token_start;
 
 static void buffer_start(void) {
-	buffer_size = 0;
+	token_start = cur;
 }
 
 static void buffer_eat() {
-	ADD_ELEMENT(buffer_size, buffer_cap, buffer) = C0;
 	CNEXT();
 }
 
 static struct string_view buffer_get(void) {
-	struct string_view ret = { .len = buffer_size };
-	ret.str = malloc(buffer_size);
-	memcpy(ret.str, buffer, buffer_size);
+	struct string_view ret = { .len = cur - token_start };
+	ret.str = arena_copy(&token_arena, token_start, ret.len);
 	return ret;
 }
 
@@ -96,11 +170,11 @@ static int parse_identifier(struct token *next) {
 
 	buffer_start();
 
-	while(HAS_PROP(C0, C_IDENTIFIER_NONDIGIT | C_DIGIT))
-		buffer_eat();
+	while (HAS_PROP(C0, C_IDENTIFIER_NONDIGIT | C_DIGIT))
+		CNEXT();
 
 	next->type = T_IDENT;
-	next->str = buffer_get();
+	next->str = sv_intern((struct string_view) { .len = cur - token_start, .str = (char *)token_start });
 	return 1;
 }
 
@@ -192,7 +266,7 @@ int parse_escape_sequence(struct string_view *string, uint32_t *character, struc
 }
 
 static int eat_cs_char(char end_char) {
-	if (C0 == '\n' || C0 == end_char)
+	if (C0 == '\n' || C0 == '\0' || C0 == end_char)
 		return 0;
 
 	if (C0 == '\\')
@@ -212,8 +286,8 @@ struct string_view eat_string_like() {
 	if (C0 != end_char) {
 		char output[5];
 		character_to_escape_sequence(C0, output, 1);
-		ERROR(input->pos[0], "Expected '%c', got '%s', while parsing \"%.*s\"", end_char, output,
-			  (int)buffer_size, buffer);
+		ERROR(current_position(), "Expected '%c', got '%s', while parsing \"%.*s\"", end_char, output,
+			  (int)(cur - token_start), token_start);
 	}
 
 	buffer_eat();
@@ -303,9 +377,76 @@ static int parse_punctuator(struct token *next) {
 
 static int is_header, is_directive;
 
+// Detect include guards of the form
+//   #ifndef X
+//   ...
+//   #endif
+// with only whitespace and comments outside. The guard is recorded
+// when the end of the input is reached, and the file is then skipped by later
+// includes as long as X is defined.
+static void update_guard(struct token *t) {
+	switch (input->guard_state) {
+	case GUARD_START:
+		input->guard_state = t->type == PP_DIRECTIVE ? GUARD_IFNDEF : GUARD_NONE;
+		break;
+
+	case GUARD_IFNDEF:
+		input->guard_state = sv_string_cmp(t->str, "ifndef") && !t->first_of_line ?
+			GUARD_NAME : GUARD_NONE;
+		break;
+
+	case GUARD_NAME:
+		if (t->type != T_IDENT || t->first_of_line) {
+			input->guard_state = GUARD_NONE;
+			break;
+		}
+		input->guard = t->str;
+		input->guard_depth = 1;
+		input->guard_state = GUARD_OPEN;
+		break;
+
+	case GUARD_OPEN:
+		if (t->type == PP_DIRECTIVE)
+			input->guard_state = GUARD_DIRECTIVE;
+		break;
+
+	case GUARD_DIRECTIVE:
+		if (t->type == PP_DIRECTIVE)
+			break;
+
+		input->guard_state = GUARD_OPEN;
+		if (t->first_of_line || t->type != T_IDENT)
+			break;
+
+		if (sv_string_cmp(t->str, "if") || sv_string_cmp(t->str, "ifdef") ||
+			sv_string_cmp(t->str, "ifndef")) {
+			input->guard_depth++;
+		} else if (sv_string_cmp(t->str, "endif")) {
+			if (--input->guard_depth == 0)
+				input->guard_state = GUARD_END;
+		} else if (input->guard_depth == 1 &&
+				   (sv_string_cmp(t->str, "else") || sv_string_cmp(t->str, "elif"))) {
+			input->guard_state = GUARD_NONE;
+		}
+		break;
+
+	case GUARD_END:
+		input->guard_state = GUARD_NONE;
+		break;
+
+	case GUARD_NONE:
+		break;
+	}
+}
+
 struct token tokenizer_next(void) {
 	struct token next = { 0 };
 
+	// The first token of an input behaves as if preceded by a newline.
+	if (start_of_input) {
+		next.whitespace = next.first_of_line = 1;
+		start_of_input = 0;
+	}
 
 	flush_whitespace(&next.whitespace,
 					 &next.first_of_line);
@@ -318,7 +459,7 @@ struct token tokenizer_next(void) {
 		(next.type = TOK, next.str = sv_from_str(S),		\
 		 CNEXT(), (sizeof(S) == 3) && (CNEXT(), 1), 1)		\
 
-	next.pos = input->pos[0];
+	next.pos = current_position();
 
 	if(IFSTR("##", PP_HHASH)) {
 	} else if(next.first_of_line && IFSTR("#", PP_DIRECTIVE)) {
@@ -334,10 +475,12 @@ struct token tokenizer_next(void) {
 		}
 	} else if(parse_pp_number(&next)) {
 	} else if(parse_punctuator(&next)) {
-	} else if(C0 == '\0') {
+	} else if(C0 == '\0' && cur == input->contents + input->contents_size) {
+		input_end(input);
 		if (input->next) {
 			// Retry on popped source.
 			input_close(&input);
+			load_input();
 			return tokenizer_next();
 		}
 
@@ -348,12 +491,18 @@ struct token tokenizer_next(void) {
 	}
 #undef IFSTR
 
+	if (next.type != T_EOI && input->identity)
+		update_guard(&next);
+
 	return next;
 }
 
 struct token_list tokenizer_whole(struct input *new_input) {
 	struct input *prev_input = input;
+	save_input();
 	input = new_input;
+	load_input();
+	start_of_input = 1;
 
 	struct token_list tl = { 0 };
 
@@ -364,6 +513,55 @@ struct token_list tokenizer_whole(struct input *new_input) {
 	}
 
 	input = prev_input;
+	if (input)
+		load_input();
 
 	return tl;
 }
+
+// Skips whitespace and comments, and everything up to the next
+// possible start of whitespace or comment.
+static void benchmark_skip(void) {
+	int whitespace = 0, first_of_line = 0;
+	while (cur < limit) {
+		flush_whitespace(&whitespace, &first_of_line);
+		do
+			cur++;
+		while (cur < limit && !HAS_PROP(C0, C_SPACE) && C0 != '/');
+	}
+}
+
+static void benchmark_tokenize(void) {
+	while (tokenizer_next().type != T_EOI);
+	arena_reset(&token_arena);
+}
+
+// Fastest of several runs, in milliseconds.
+static double benchmark_time(void (*run)(void), int scalar) {
+	double best = 0;
+	scalar_skip = scalar;
+	for (int i = 0; i < 10; i++) {
+		input->c_ptr = 0;
+		load_input();
+		start_of_input = 1;
+
+		clock_t start = clock();
+		run();
+		double time = (double)(clock() - start) * 1000 / CLOCKS_PER_SEC;
+		if (i == 0 || time < best)
+			best = time;
+	}
+	scalar_skip = 0;
+	return best;
+}
+
+void tokenizer_benchmark(const char *path) {
+	input_open(&input, path, 0);
+
+	printf("%s: %zu bytes\n", path, input->contents_size);
+	printf("             skip only   tokenize\n");
+	printf("word skip:   %7.2f ms %7.2f ms\n",
+		   benchmark_time(benchmark_skip, 0), benchmark_time(benchmark_tokenize, 0));
+	printf("scalar skip: %7.2f ms %7.2f ms\n",
+		   benchmark_time(benchmark_skip, 1), benchmark_time(benchmark_tokenize, 1));
+}
@@ -16,4 +16,7 @@ struct token_list tokenizer_whole(struct input *new_input);
 
 int parse_escape_sequence(struct string_view *string, uint32_t *character, struct position pos);
 
+// Times tokenization of path with word at a time and scalar skipping of whitespace.
+void tokenizer_benchmark(const char *path);
+
 #endif
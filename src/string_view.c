@@ -1,7 +1,10 @@
 #include "string_view.h"
+#include "common.h"
+#include "hash_table.h"
 
 #include <string.h>
 #include <stdlib.h>
+#include <stddef.h>
 
 int sv_string_cmp(struct string_view view, const char *string) {
 	if ((unsigned)view.len != strlen(string))
@@ -55,3 +58,69 @@ void sv_tail(struct string_view *sv, int n) {
 	sv->len -= n;
 	sv->str += n;
 }
+
+// Interned strings are allocated from large blocks, as they are never freed.
+// Each one has a header with its id, which is used as the hash.
+struct interned {
+	uint32_t id;
+	int len;
+	char str[];
+};
+
+static struct hash_table intern_table = { .name = "identifiers" };
+static uint32_t intern_count;
+
+static char *intern_block;
+static size_t intern_block_left;
+
+#define INTERN_BLOCK_SIZE (64 * 1024)
+
+static struct interned *intern_allocate(struct string_view sv) {
+	size_t size = (sizeof (struct interned) + sv.len + 1 + 7) & ~(size_t)7;
+	if (size > intern_block_left) {
+		size_t block_size = MAX(size, INTERN_BLOCK_SIZE);
+		intern_block = malloc(block_size);
+		intern_block_left = block_size;
+	}
+
+	struct interned *ret = (struct interned *)intern_block;
+	intern_block += size;
+	intern_block_left -= size;
+
+	ret->id = intern_count++;
+	ret->len = sv.len;
+	memcpy(ret->str, sv.str, sv.len);
+	ret->str[sv.len] = '\0';
+	return ret;
+}
+
+static int intern_equal(const void *value, const void *key) {
+	const struct interned *interned = value;
+	const struct string_view *sv = key;
+	return interned->len == sv->len && memcmp(interned->str, sv->str, sv->len) == 0;
+}
+
+struct string_view sv_intern(struct string_view sv) {
+	uint32_t hash = sv_hash(sv);
+	struct interned *interned = hash_table_get(&intern_table, hash, intern_equal, &sv);
+
+	if (!interned) {
+		interned = intern_allocate(sv);
+		hash_table_set(&intern_table, hash, intern_equal, &sv, interned);
+	}
+
+	return (struct string_view) { .len = interned->len, .str = interned->str };
+}
+
+struct string_view sv_intern_str(const char *str) {
+	return sv_intern(sv_from_str((char *)str));
+}
+
+uint32_t sv_intern_id(struct string_view sv) {
+	struct interned *interned = (struct interned *)(sv.str - offsetof(struct interned, str));
+	return interned->id;
+}
+
+uint32_t sv_intern_hash(struct string_view sv) {
+	return hash32(sv_intern_id(sv));
+}
@@ -18,4 +18,13 @@ void sv_tail(struct string_view *sv, int n);
 
 uint32_t sv_hash(struct string_view sv);
 
+// Interned strings are stored once for each distinct spelling, and are null
+// terminated. Two interned strings are equal if and only if their pointers are.
+// sv_intern_id and sv_intern_hash only work on interned strings, and are the
+// same in every run. Ids are given out sequentially from 0.
+struct string_view sv_intern(struct string_view sv);
+struct string_view sv_intern_str(const char *str);
+uint32_t sv_intern_id(struct string_view sv);
+uint32_t sv_intern_hash(struct string_view sv);
+
 #endif
@@ -7,9 +7,14 @@
 
 #include "types.h"
 #include "common.h"
+#include "arena.h"
+#include "hash_table.h"
 #include "parser/expression.h"
 #include <abi/abi.h>
 
+// Types, structs and enums live for the whole translation unit.
+static struct arena type_arena;
+
 static int compare_types(struct type *a, struct type **a_children,
 						 struct type *b) {
 	if (a->type != b->type)
@@ -60,8 +65,9 @@ static int compare_types(struct type *a, struct type **a_children,
 		break;
 	}
 
+	// Children are already interned, so they are compared by pointer.
 	for (int i = 0; i < a->n; i++) {
-		if (!compare_types(a_children[i], a_children[i]->children, b->children[i]))
+		if (a_children[i] != b->children[i])
 			return 0;
 	}
 
@@ -98,43 +104,40 @@ static uint32_t type_hash(struct type *type, struct type **children) {
 	}
 
 	for (int i = 0; i < type->n; i++) {
-		hash ^= type_hash(children[i], children[i]->children);
+		uint64_t address = (uint64_t)children[i];
+		hash = hash * 31 + hash32(address ^ (address >> 32));
 	}
 
 	return hash;
 }
 
-struct type *type_create(struct type *params, struct type **children) {
-	static struct type **hashtable = NULL;
-	static int hashtable_size = 0;
-
-	if (hashtable_size == 0) {
-		hashtable_size = 1024;
-		hashtable = malloc(hashtable_size * sizeof(*hashtable));
-		for (int i = 0; i < hashtable_size; i++) {
-			hashtable[i] = NULL;
-		}
-	}
+struct type_key {
+	struct type *params, **children;
+};
 
-	uint32_t hash_idx = type_hash(params, children) % hashtable_size;
-	struct type *first = hashtable[hash_idx];
-	struct type *ffirst = first;
+static int type_equal(const void *value, const void *key) {
+	const struct type_key *k = key;
+	return compare_types(k->params, k->children, (struct type *)value);
+}
+
+struct type *type_create(struct type *params, struct type **children) {
+	static struct hash_table types = { .name = "types" };
 
-	while(first && !compare_types(params, children, first))
-		first = first->next;
+	struct type_key key = { params, children };
+	uint32_t hash = type_hash(params, children);
+	struct type *type = hash_table_get(&types, hash, type_equal, &key);
 
-	if (first)
-		return first;
+	if (type)
+		return type;
 
-	struct type *new = malloc(sizeof(*params) + sizeof(*children) * params->n);
-	*new = *params;
+	type = arena_alloc(&type_arena, sizeof(*params) + sizeof(*children) * params->n);
+	*type = *params;
 	if (params->n)
-		memcpy(new->children, children, sizeof(*children) * params->n);
+		memcpy(type->children, children, sizeof(*children) * params->n);
 
-	new->next = ffirst;
-	hashtable[hash_idx] = new;
+	hash_table_set(&types, hash, type_equal, &key, type);
 
-	return new;
+	return type;
 }
 
 struct type *type_simple(enum simple_type type) {
@@ -175,11 +178,11 @@ struct type *type_remove_qualifications(struct type *type) {
 
 // TODO: make this better.
 struct struct_data *register_struct(void) {
-	return malloc(sizeof (struct struct_data));
+	return arena_alloc(&type_arena, sizeof (struct struct_data));
 }
 
 struct enum_data *register_enum(void) {
-	return malloc(sizeof (struct enum_data));
+	return arena_alloc(&type_arena, sizeof (struct enum_data));
 }
 
 int type_search_member(struct type *type, struct string_view name,
@@ -195,7 +198,7 @@ int type_search_member(struct type *type, struct string_view name,
 		ICE("Member access on incomplete type not allowed");
 
 	for (int i = 0; i < data->n; i++) {
-		if (sv_cmp(data->fields[i].name, name)) {
+		if (data->fields[i].name.str == name.str) {
 			ADD_ELEMENT(*n, stack_cap, stack) = i;
 		} else if (data->fields[i].name.len == 0 &&
 				   type_search_member(data->fields[i].type, name,
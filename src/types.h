@@ -91,8 +91,6 @@ struct type {
 
 	int is_const;
 
-	struct type *next; // Used in hash-map.
-
 	int n;
 	struct type *children[];
 };
@@ -0,0 +1,60 @@
+#include <assert.h>
+
+int twice(int x) {
+	return 2 * x;
+}
+
+int nested(int n) {
+	int sum = 0;
+	for (int i = 0; i < n; i++) {
+		if (i == 7)
+			continue;
+		for (int j = i; j > 0; j--) {
+			if (j == 3)
+				break;
+			sum += j;
+		}
+	}
+	return sum;
+}
+
+int do_while(int n) {
+	int steps = 0;
+	do {
+		steps++;
+		n /= 2;
+	} while (n);
+	return steps;
+}
+
+int with_goto(int n) {
+	int r = 0;
+again:
+	r += n;
+	if (--n > 0)
+		goto again;
+	return r;
+}
+
+// Temporaries that live across the blocks of a conditional expression.
+int conditional(int a, int b) {
+	int total = 0;
+	for (int i = 0; i < 4; i++)
+		total += (i & 1 ? twice(a) + (b ? twice(b) : 1) : a - b) + (a > b && b > i);
+	return total;
+}
+
+int main() {
+	assert(nested(10) == 101);
+	assert(do_while(0) == 1 && do_while(1) == 1 && do_while(8) == 4);
+	assert(with_goto(4) == 10);
+	assert(conditional(3, 2) == 24);
+	assert(conditional(5, 0) == 32);
+
+	int i = 0;
+	while (1) {
+		if (++i == 5)
+			break;
+	}
+	assert(i == 5);
+}
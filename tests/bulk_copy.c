@@ -0,0 +1,51 @@
+#include <assert.h>
+#include <string.h>
+
+#define SIZES(X) X(16) X(24) X(63) X(64) X(65) X(100) X(255) X(256) X(257) X(1000) X(4099)
+
+#define DEFINE(N)								\
+	struct s##N { char data[N]; };				\
+	struct s##N global##N;						\
+	struct s##N copy##N(struct s##N s) {		\
+		return s;								\
+	}											\
+	void test##N(void) {						\
+		struct s##N a, b;						\
+		for (int i = 0; i < N; i++)				\
+			a.data[i] = i * 7 + 1;				\
+		b = a;									\
+		assert(memcmp(a.data, b.data, N) == 0);	\
+		global##N = copy##N(b);					\
+		assert(memcmp(a.data, global##N.data, N) == 0);	\
+		struct s##N *p = &global##N;			\
+		struct s##N c = *p;						\
+		assert(memcmp(a.data, c.data, N) == 0);	\
+		char guard1 = 'x';						\
+		struct s##N z = { 0 };					\
+		char guard2 = 'y';						\
+		for (int i = 0; i < N; i++)				\
+			assert(z.data[i] == 0);				\
+		assert(guard1 == 'x' && guard2 == 'y');	\
+	}
+
+SIZES(DEFINE)
+
+#define CALL(N) test##N();
+
+struct mixed {
+	long first;
+	int values[100];
+	char last;
+};
+
+int main() {
+	SIZES(CALL)
+
+	struct mixed m = { 1, { 2, 3 }, 'z' };
+	assert(m.first == 1 && m.values[0] == 2 && m.values[1] == 3 && m.last == 'z');
+	for (int i = 2; i < 100; i++)
+		assert(m.values[i] == 0);
+
+	struct mixed n = m;
+	assert(memcmp(&m, &n, sizeof m) == 0);
+}
@@ -0,0 +1,50 @@
+#include <assert.h>
+
+#define CHECK(T, a, b)							\
+	do {										\
+		T x = (a), y = (b);						\
+		int r = 0;								\
+		if (x < y) r |= 1;						\
+		if (x <= y) r |= 2;						\
+		if (x > y) r |= 4;						\
+		if (x >= y) r |= 8;						\
+		if (x == y) r |= 16;					\
+		if (x != y) r |= 32;					\
+		int e = ((x < y) << 0) | ((x <= y) << 1) | ((x > y) << 2) |	\
+			((x >= y) << 3) | ((x == y) << 4) | ((x != y) << 5);	\
+		assert(r == e);							\
+	} while (0)
+
+int count_down(long n) {
+	int steps = 0;
+	while (n > 0) {
+		n -= 3;
+		steps++;
+	}
+	return steps;
+}
+
+int main() {
+	int values[] = { -2147483647 - 1, -5, -1, 0, 1, 5, 2147483647 };
+	int n = sizeof values / sizeof *values;
+	for (int i = 0; i < n; i++) {
+		for (int j = 0; j < n; j++) {
+			CHECK(int, values[i], values[j]);
+			CHECK(unsigned, values[i], values[j]);
+			CHECK(long, values[i], values[j]);
+			CHECK(unsigned long, values[i], values[j]);
+		}
+	}
+
+	assert(-1 < 1);
+	assert(!((unsigned)-1 < 1u));
+	assert((unsigned long)-1 > 1ul);
+
+	assert(count_down(10) == 4);
+	assert(count_down(-1) == 0);
+
+	int sum = 0;
+	for (unsigned i = 10; i-- > 0;)
+		sum += i;
+	assert(sum == 45);
+}
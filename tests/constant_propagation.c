@@ -0,0 +1,63 @@
+#include <assert.h>
+
+struct inner {
+	char c;
+	int values[4];
+};
+
+struct outer {
+	long a;
+	struct inner in;
+	unsigned short bits : 5, more : 7;
+} global = { 1, { 'x', { 10, 20, 30, 40 } }, 3, 100 };
+
+int table[3][3] = { { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 } };
+
+int identity(int x) {
+	return x;
+}
+
+int select(int x) {
+	switch (3) {
+	case 1: return -1;
+	case 3: break;
+	default: return -2;
+	}
+
+	int r = 0 ? identity(x) : x + 0;
+	if (1)
+		r = r * 1;
+	else
+		r = identity(100);
+	return r;
+}
+
+int main() {
+	assert(global.in.values[2] == 30);
+	assert(global.in.c == 'x');
+	assert(&global.in.values[3] - &global.in.values[0] == 3);
+	assert(global.bits == 3 && global.more == 100);
+	assert(table[2][1] == 8);
+
+	assert((unsigned char)(200 + 100) == 44);
+	assert((signed char)200 == -56);
+	assert(-7 / 2 == -3 && -7 % 2 == -1);
+	assert(7u / 2 == 3 && 7u % 2 == 1);
+	assert(-16 >> 2 == -4);
+	assert((unsigned)-16 >> 28 == 15);
+	assert((1u << 31) == 2147483648u);
+	assert(-1 < 0);
+	assert(!(-1 < 0u));
+	assert((long)-1 == -1L);
+	assert((unsigned long)(unsigned)-1 == 4294967295ul);
+	assert(~0u == 4294967295u && -(1L << 40) == -1099511627776L);
+
+	assert(select(5) == 5);
+
+	int sum = 0;
+	for (int i = 0; i < 10; i++) {
+		int step = 1 ? 2 : 3;
+		sum += step;
+	}
+	assert(sum == 20);
+}
@@ -0,0 +1,59 @@
+#include <assert.h>
+#include <string.h>
+
+struct point {
+	int x, y, z;
+};
+
+struct flags {
+	unsigned a : 3, b : 5;
+	char c;
+};
+
+int unused(int x) {
+	int a = x * 3 + 1;
+	int b = a << 2;
+	(void)b;
+	return x;
+}
+
+int after_return(int x) {
+	return x + 1;
+	x = 100;
+	return x;
+}
+
+int skipped_loop(void) {
+	int n = 0;
+	while (0)
+		n++;
+	return n;
+}
+
+int main() {
+	struct point full = { 1, 2, 3 };
+	assert(full.x == 1 && full.y == 2 && full.z == 3);
+
+	struct point partial = { 4 };
+	assert(partial.x == 4 && partial.y == 0 && partial.z == 0);
+
+	int array[4] = { 5, 6, 7, 8 };
+	assert(array[0] == 5 && array[3] == 8);
+
+	int tail[8] = { 1, 2 };
+	for (int i = 2; i < 8; i++)
+		assert(tail[i] == 0);
+
+	struct flags f = { 5, 17, 'q' };
+	assert(f.a == 5 && f.b == 17 && f.c == 'q');
+
+	struct flags g = { .b = 3 };
+	assert(g.a == 0 && g.b == 3 && g.c == 0);
+
+	char str[6] = "abc";
+	assert(memcmp(str, "abc\0\0\0", 6) == 0);
+
+	assert(unused(7) == 7);
+	assert(after_return(1) == 2);
+	assert(skipped_loop() == 0);
+}
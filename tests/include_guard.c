@@ -0,0 +1,32 @@
+#include "include_guard1.h"
+#include "./include_guard1.h"
+#include "../tests/include_guard1.h"
+
+#ifdef INCLUDE_GUARD1_AGAIN
+#error "Guarded header was included twice"
+#endif
+
+// Guard is no longer defined, so the header must be read again.
+#undef INCLUDE_GUARD1
+#include "include_guard1.h"
+
+#ifndef INCLUDE_GUARD1_AGAIN
+#error "Header was not included after the guard was undefined"
+#endif
+
+#include "include_guard2.h"
+#include "include_guard2.h"
+
+#ifndef INCLUDE_GUARD2_AGAIN
+#error "Content after #endif was skipped"
+#endif
+
+#include "include_guard3.h"
+#include "include_guard3.h"
+
+#ifndef INCLUDE_GUARD3_AGAIN
+#error "#else of guard was skipped"
+#endif
+
+int main() {
+}
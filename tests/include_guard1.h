@@ -0,0 +1,10 @@
+#ifndef INCLUDE_GUARD1
+#define INCLUDE_GUARD1
+
+#ifndef INCLUDE_GUARD1_FIRST
+#define INCLUDE_GUARD1_FIRST
+#else
+#define INCLUDE_GUARD1_AGAIN
+#endif
+
+#endif /* INCLUDE_GUARD1 */
@@ -0,0 +1,9 @@
+#ifndef INCLUDE_GUARD2
+#define INCLUDE_GUARD2
+#endif
+
+// Not covered by the guard.
+#ifdef INCLUDE_GUARD2_FIRST
+#define INCLUDE_GUARD2_AGAIN
+#endif
+#define INCLUDE_GUARD2_FIRST
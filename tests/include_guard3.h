@@ -0,0 +1,5 @@
+#ifndef INCLUDE_GUARD3
+#define INCLUDE_GUARD3
+#else
+#define INCLUDE_GUARD3_AGAIN
+#endif
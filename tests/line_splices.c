@@ -0,0 +1,26 @@
+#include <assert.h>
+#include <string.h>
+
+/* A comment
+   over two lines */ int after_comment = __LINE__;
+#define SUM(a, b) \
+	((a) + \
+	 (b))
+int after_macro = __LINE__;
+int spl\
+iced = 5;
+const char *string = "ab\
+cd";
+int after_splices = __LINE__;
+/*/ still a comment */
+int after_short_comment = __LINE__;
+
+int main() {
+	assert(after_comment == 5);
+	assert(after_macro == 9);
+	assert(after_splices == 14);
+	assert(after_short_comment == 16);
+	assert(spliced == 5 && SUM(1, 2) == 3);
+	assert(strcmp(string, "abcd") == 0);
+	return 0;
+}
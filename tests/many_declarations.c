@@ -0,0 +1,56 @@
+#include <assert.h>
+
+// Many declarations at file scope and in nested blocks, checking that
+// shadowed names resolve to the right scope. Each function definition
+// below adds its name at file scope while its 101 parameters are in
+// scope, one of which has the same name as the function.
+
+#define D1(P) P##0, P##1, P##2, P##3, P##4, P##5, P##6, P##7, P##8, P##9
+#define D2(P) D1(P##0), D1(P##1), D1(P##2), D1(P##3), D1(P##4), D1(P##5), D1(P##6), D1(P##7), D1(P##8), D1(P##9)
+#define D3(P) D2(P##0), D2(P##1), D2(P##2), D2(P##3), D2(P##4), D2(P##5), D2(P##6), D2(P##7), D2(P##8), D2(P##9)
+#define D4(P) D3(P##0), D3(P##1), D3(P##2), D3(P##3), D3(P##4), D3(P##5), D3(P##6), D3(P##7), D3(P##8), D3(P##9)
+
+extern int D4(g0), D4(g1), D4(g2), D4(g3), D4(g4);
+
+int g12345 = 5, g45678 = 7;
+
+#define P1(P) int P##0, int P##1, int P##2, int P##3, int P##4, int P##5, int P##6, int P##7, int P##8, int P##9
+#define P2(P) P1(P##0), P1(P##1), P1(P##2), P1(P##3), P1(P##4), P1(P##5), P1(P##6), P1(P##7), P1(P##8), P1(P##9)
+#define F(N) int N(int N, P2(N##_)) { return N + N##_00 + N##_99; }
+#define F1(P) F(P##0) F(P##1) F(P##2) F(P##3) F(P##4) F(P##5) F(P##6) F(P##7) F(P##8) F(P##9)
+#define F2(P) F1(P##0) F1(P##1) F1(P##2) F1(P##3) F1(P##4) F1(P##5) F1(P##6) F1(P##7) F1(P##8) F1(P##9)
+#define F3(P) F2(P##0) F2(P##1) F2(P##2) F2(P##3) F2(P##4) F2(P##5) F2(P##6) F2(P##7) F2(P##8) F2(P##9)
+
+F3(f)
+
+#define A1 1, 1, 1, 1, 1, 1, 1, 1, 1, 1
+#define A2 A1, A1, A1, A1, A1, A1, A1, A1, A1, A1
+
+int add(int a, int b) {
+	return a + b;
+}
+
+int main() {
+	int total = 0;
+	{
+		typedef int D4(t0), D4(t1);
+		{
+			typedef int D4(t2), D4(t3);
+			{
+				int g12345 = 1;
+				typedef int D4(t4);
+				t49999 x = add(g12345, g45678);
+				total += x;
+			}
+			t39999 y = g12345;
+			total += y;
+		}
+	}
+
+	int t00000 = 3;
+	assert(total == 8 + 5);
+	assert(add(t00000, g12345) == 8);
+	assert(f000(2, A2) == 4);
+	assert(f999(t00000, A2) == 5);
+	return 0;
+}
@@ -0,0 +1,32 @@
+// Also compiled with tests/precompiled.h as a precompiled header.
+#include "precompiled.h"
+
+int counter = 2;
+
+int sum(int n, ...) {
+	va_list ap;
+	va_start(ap, n);
+	int total = 0;
+	for (int i = 0; i < n; i++)
+		total += va_arg(ap, int);
+	va_end(ap);
+	return total;
+}
+
+int main() {
+	struct point a = { 1, 2, NULL }, b = { 3, 4, &a };
+	assert(b.next->y == 2 && SQUARE(b.x) == 9);
+
+	record r = { "abc", { 5 }, 9 };
+	assert(sizeof r.name == 8 && r.value.i == 5 && r.flags == 9);
+	assert(strlen(r.name) == 3);
+
+	assert(HIGH == 8 && FIELD_COUNT == 3);
+	assert(clamp(10, LOW, MEDIUM) == 4 && clamp(-1, LOW, MEDIUM) == 1);
+	assert(sum(3, 1, 2, counter) == 5);
+
+	char buffer[16];
+	snprintf(buffer, sizeof buffer, "%d-%s", SQUARE(4), r.name);
+	assert(strcmp(buffer, "16-abc") == 0);
+	return 0;
+}
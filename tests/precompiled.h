@@ -0,0 +1,32 @@
+#ifndef PRECOMPILED_H
+#define PRECOMPILED_H
+
+#include <assert.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SQUARE(x) ((x) * (x))
+#define FIELD_COUNT 3
+
+struct point {
+	int x, y;
+	struct point *next;
+};
+
+typedef struct {
+	char name[8];
+	union { int i; float f; } value;
+	unsigned flags : 4;
+} record;
+
+enum level { LOW = 1, MEDIUM = 4, HIGH = MEDIUM * 2 };
+
+extern int counter;
+int sum(int n, ...);
+
+static inline int clamp(int x, int low, int high) {
+	return x < low ? low : x > high ? high : x;
+}
+
+#endif
@@ -33,6 +33,18 @@ int main() {
 
 	assert(CAT(0x, ff) == 0xff);
 
+	// Macros are not expanded again within their own expansion.
+	int SELF = 1, PING = 2, PONG = 3;
+#define SELF (SELF + 1)
+#define PING PONG
+#define PONG (PING * 2)
+#define TWICE(X) (X + X)
+#define APPLY(F, X) F(X)
+	assert(SELF == 2);
+	assert(PING == 4 && PONG == 6);
+	assert(TWICE(TWICE(SELF)) == 8);
+	assert(APPLY(TWICE, APPLY(TWICE, 3)) == 12);
+
 	const char *include = NULL;
 
 	int CAT3(HELLO) = 10;
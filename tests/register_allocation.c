@@ -0,0 +1,41 @@
+#include <assert.h>
+
+int add(int a, int b) {
+	return a + b;
+}
+
+// More live values than registers, some of them live across calls.
+int pressure(int n) {
+	int a = n, b = n + 1, c = n + 2, d = n + 3, e = n + 4,
+		f = n + 5, g = n + 6, h = n + 7, i = n + 8;
+
+	int s = add(a, b);
+	s = add(s, c) + d;
+	s += add(e, f) * g;
+	return s + h - i;
+}
+
+unsigned char narrow(unsigned char c, short s) {
+	unsigned char r = c + 200;
+	short t = s * 2;
+	return r + (t < 0);
+}
+
+int main() {
+	assert(pressure(1) == 1 + 2 + 3 + 4 + (5 + 6) * 7 + 8 - 9);
+
+	assert(narrow(100, -5) == (unsigned char)(300 + 1));
+	assert(narrow(10, 5) == 210);
+
+	long sum = 0;
+	for (int i = 0; i < 1000; i++) {
+		int j = i;
+		while (j > 0)
+			j -= 7;
+		sum += j;
+	}
+	long expected = 0;
+	for (int i = 0; i < 1000; i++)
+		expected += i % 7 ? i % 7 - 7 : 0;
+	assert(sum == expected);
+}
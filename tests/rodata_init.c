@@ -0,0 +1,64 @@
+#include <assert.h>
+#include <string.h>
+
+struct entry {
+	const char *name;
+	int (*func)(int);
+	unsigned flags : 3, kind : 5;
+	double weight;
+};
+
+int inc(int x) {
+	return x + 1;
+}
+
+int dec(int x) {
+	return x - 1;
+}
+
+int main() {
+	for (int round = 0; round < 2; round++) {
+		char text[] = "The quick brown fox jumps over the lazy dog, "
+			"and then the lazy dog gets up and chases the quick brown fox.";
+		assert(strlen(text) == sizeof text - 1);
+		assert(text[4] == 'q' && text[sizeof text - 2] == '.');
+		text[0] = 't';
+
+		int primes[10] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29 };
+		int sum = 0;
+		for (int i = 0; i < 10; i++)
+			sum += primes[i];
+		assert(sum == 129);
+		primes[0] = 100;
+
+		struct entry table[] = {
+			{ "inc", inc, 5, 17, 1.5 },
+			{ "dec", dec, 2, 31, -0.0 },
+			{ "none", 0, 0, 0, 0.25 },
+		};
+		assert(table[0].func(1) == 2 && table[1].func(1) == 0 && !table[2].func);
+		assert(strcmp(table[1].name, "dec") == 0);
+		assert(table[0].flags == 5 && table[0].kind == 17);
+		assert(table[1].flags == 2 && table[1].kind == 31);
+		assert(table[2].weight == 0.25);
+		unsigned char zero_bits[sizeof(double)];
+		double negative_zero = -0.0;
+		memcpy(zero_bits, &table[1].weight, sizeof zero_bits);
+		assert(memcmp(zero_bits, &negative_zero, sizeof zero_bits) == 0);
+		volatile double positive_zero = 0.0;
+		negative_zero = -positive_zero;
+		assert(memcmp(zero_bits, &negative_zero, sizeof zero_bits) == 0);
+		table[0].flags = 0;
+
+		int sparse[1000] = { [10] = 1, [500] = 2 };
+		for (int i = 0; i < 1000; i++)
+			assert(sparse[i] == (i == 10 ? 1 : i == 500 ? 2 : 0));
+		sparse[0] = 5;
+
+		char padded[64] = "abc";
+		assert(strcmp(padded, "abc") == 0 && padded[63] == 0);
+
+		long matrix[3][3] = { { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 } };
+		assert(matrix[1][1] == 5 && matrix[2][2] == 9);
+	}
+}
@@ -0,0 +1,99 @@
+#include <assert.h>
+#include <string.h>
+
+struct vec2 {
+	float x, y;
+};
+
+double scale(double x) {
+	return x * 3.0;
+}
+
+float length2(struct vec2 v) {
+	return v.x * v.x + v.y * v.y;
+}
+
+struct vec2 step(struct vec2 p, struct vec2 v, float dt) {
+	struct vec2 r = { p.x + v.x * dt, p.y + v.y * dt };
+	return r;
+}
+
+// More live values than there are SSE registers available.
+double many(double a, double b) {
+	double c = a + b, d = a - b, e = a * b, f = a / b;
+	double g = c + 1, h = d + 2, i = e + 3, j = f + 4, k = c * d, l = e * f;
+	return a + b + c + d + e + f + g + h + i + j + k + l;
+}
+
+// Values that are live across calls.
+double across_calls(double x) {
+	double a = x + 1.5;
+	double b = scale(a);
+	double c = a * 2;
+	return scale(b + c) - a;
+}
+
+void filter(float *out, const float *in, int n, float k) {
+	float prev = 0;
+	for (int i = 0; i < n; i++) {
+		prev = prev + (in[i] - prev) * k;
+		out[i] = prev;
+	}
+}
+
+// Negation flips the sign bit, also of zero.
+double negate(double x) {
+	return -x;
+}
+
+float negatef(float x) {
+	return -x;
+}
+
+int compare(double a, double b) {
+	return (a < b) + (a <= b) * 2 + (a > b) * 4 + (a >= b) * 8 + (a == b) * 16 + (a != b) * 32;
+}
+
+int main() {
+	assert(scale(2.5) == 7.5);
+	assert(many(8, 2) == 216);
+
+	assert(across_calls(0.5) == (6 + 4) * 3.0 - 2);
+
+	struct vec2 p = { 1, 2 }, v = { 0.5f, -1 };
+	p = step(p, v, 2);
+	assert(p.x == 2 && p.y == 0);
+	assert(length2(p) == 4);
+
+	float in[8] = { 1, 1, 1, 1, 0, 0, 0, 0 }, out[8];
+	filter(out, in, 8, 0.5f);
+	assert(out[0] == 0.5f && out[1] == 0.75f && out[3] == 0.9375f && out[4] == 0.46875f);
+
+	assert(compare(1, 2) == 1 + 2 + 32);
+	assert(compare(2, 1) == 4 + 8 + 32);
+	assert(compare(1, 1) == 2 + 8 + 16);
+
+	float f = 1.25f;
+	double d = f;
+	int i = d * 4;
+	long l = -d * 8;
+	float back = i;
+	assert(d == 1.25 && i == 5 && l == -10 && back == 5.0f);
+	assert((float)(d / 2) == 0.625f);
+
+	double zero = 0.0, negative = -zero;
+	double expected = -0.0;
+	assert(memcmp(&negative, &expected, sizeof negative) == 0);
+	float fzero = 0.0f, fnegative = -fzero;
+	assert(1 / fnegative < 0);
+
+	assert(1 / negate(0.0) < 0 && 1 / negate(negate(0.0)) > 0);
+	assert(1 / negatef(0.0f) < 0 && 1 / negatef(negatef(0.0f)) > 0);
+	assert(1 / -(0.0) < 0 && 1 / -(0.0f) < 0);
+
+	double sum = 0;
+	for (int j = 0; j < 100; j++)
+		sum += j * 0.25;
+	assert(sum == 1237.5);
+	return 0;
+}
@@ -0,0 +1,106 @@
+#include <assert.h>
+#include <limits.h>
+
+int dense(int x) {
+	switch (x) {
+	case 0: return 10;
+	case 1: return 11;
+	case 2: return 12;
+	case 4: return 14;
+	case 5: return 15;
+	case 6: return 16;
+	case 7: return 17;
+	default: return -1;
+	}
+}
+
+int sparse(int x) {
+	switch (x) {
+	case -1000000: return 1;
+	case -300: return 2;
+	case -7: return 3;
+	case 0: return 4;
+	case 9: return 5;
+	case 100: return 6;
+	case 4096: return 7;
+	case 70000: return 8;
+	case INT_MAX: return 9;
+	case INT_MIN: return 10;
+	}
+	return 0;
+}
+
+// Dense clusters separated by a large gap.
+int clusters(int x) {
+	int r = 0;
+	switch (x) {
+	case 100: r = 1; break;
+	case 101: r = 2; break;
+	case 102: r = 3; break;
+	case 103: r = 4; break;
+	case 104: r = 5; break;
+	case 105: r = 6; break;
+	case 5000: r = 7; break;
+	case 5001: r = 8; break;
+	case 5002: r = 9; break;
+	case 5003: r = 10; break;
+	case 5004: r = 11; break;
+	case 5005: r = 12; break;
+	}
+	return r;
+}
+
+int negative_table(int x) {
+	switch (x) {
+	case -3: return 1;
+	case -2: return 2;
+	case -1: return 3;
+	case 0: return 4;
+	case 1: return 5;
+	case 2: return 6;
+	}
+	return 0;
+}
+
+int fallthrough(int x) {
+	int r = 0;
+	switch (x) {
+	case 1: r += 1;
+	case 2: r += 2;
+	case 3: r += 3;
+	case 4: r += 4;
+	case 5: r += 5;
+	case 6: r += 6;
+	}
+	return r;
+}
+
+int main() {
+	for (int i = -2; i < 10; i++) {
+		int expected = (i >= 0 && i <= 7 && i != 3) ? 10 + i : -1;
+		assert(dense(i) == expected);
+	}
+
+	assert(sparse(-1000000) == 1 && sparse(-300) == 2 && sparse(-7) == 3);
+	assert(sparse(0) == 4 && sparse(9) == 5 && sparse(100) == 6);
+	assert(sparse(4096) == 7 && sparse(70000) == 8);
+	assert(sparse(INT_MAX) == 9 && sparse(INT_MIN) == 10);
+	assert(sparse(1) == 0 && sparse(-8) == 0 && sparse(INT_MAX - 1) == 0);
+
+	for (int i = 0; i < 6; i++) {
+		assert(clusters(100 + i) == 1 + i);
+		assert(clusters(5000 + i) == 7 + i);
+	}
+	assert(clusters(99) == 0 && clusters(106) == 0 && clusters(4999) == 0 && clusters(5006) == 0);
+
+	for (int i = -5; i < 5; i++)
+		assert(negative_table(i) == (i >= -3 && i <= 2 ? i + 4 : 0));
+
+	assert(fallthrough(1) == 21 && fallthrough(4) == 15 && fallthrough(6) == 6 && fallthrough(7) == 0);
+
+	unsigned u = 3;
+	switch (u) {
+	case 3: break;
+	default: assert(0);
+	}
+}